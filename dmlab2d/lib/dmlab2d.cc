@@ -142,7 +142,7 @@ class Lab2D {
   }
 
   EnvCApi_PropertyResult ReadProperty(const char* key, const char** value) {
-    return env_.MutableProperties()->ReadProperty(key, value);
+    return env_.ReadProperty(key, value);
   }
 
   EnvCApi_PropertyResult ListProperty(
@@ -16,6 +16,8 @@
 
 #include "dmlab2d/lib/env_lua_api/env_lua_api.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <string>
@@ -24,8 +26,12 @@
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "dmlab2d/lib/env_lua_api/properties.h"
+#include "dmlab2d/lib/lua/allocator.h"
 #include "dmlab2d/lib/lua/bind.h"
 #include "dmlab2d/lib/lua/call.h"
 #include "dmlab2d/lib/lua/lua.h"
@@ -43,6 +49,66 @@
 #include "third_party/rl_api/env_c_api.h"
 
 namespace deepmind::lab2d {
+namespace {
+
+// Looks up `name` against each template in `package.path` in the asset
+// bundles mounted on `bundles`. If found, the module is loaded straight from
+// the bundle's memory mapping and pushed onto the stack. Returns whether a
+// module was found.
+// On a syntax error `*error` is set to true and the message is pushed instead.
+bool PushBundledModule(lua_State* L, const util::AssetBundleFileSystem& bundles,
+                       absl::string_view name, bool* error) {
+  std::string module_path(name);
+  std::replace(module_path.begin(), module_path.end(), '.', '/');
+  lua_getglobal(L, "package");
+  lua_getfield(L, -1, "path");
+  std::string path = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
+  lua_pop(L, 2);
+  for (absl::string_view path_template : absl::StrSplit(path, ';')) {
+    std::string file_name =
+        absl::StrReplaceAll(path_template, {{"?", module_path}});
+    if (auto contents = bundles.Find(file_name)) {
+      std::string chunk_name = absl::StrCat("@", file_name);
+      *error = luaL_loadbuffer(L, contents->data(), contents->size(),
+                               chunk_name.c_str()) != 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+extern "C" {
+static int AssetBundleSearcher(lua_State* L) {
+  if (lua_type(L, 1) != LUA_TSTRING) {
+    lua_pushstring(L, "'required' called with a non-string argument!");
+    return 1;
+  }
+  const auto* bundles = static_cast<const util::AssetBundleFileSystem*>(
+      lua_touserdata(L, lua_upvalueindex(1)));
+  std::size_t length = 0;
+  const char* name = lua_tolstring(L, 1, &length);
+  bool error = false;
+  if (!PushBundledModule(L, *bundles, absl::string_view(name, length),
+                         &error)) {
+    lua_pushstring(L, "\n\tno entry in mounted asset bundles");
+    return 1;
+  }
+  return error ? lua_error(L) : 1;
+}
+}  // extern "C"
+
+// Loads the script `file_name` from an asset bundle mounted on `bundles` if it
+// is part of one, otherwise from disk.
+lua::NResultsOr PushScriptFileOrBundled(
+    lua_State* L, const util::AssetBundleFileSystem& bundles,
+    const std::string& file_name) {
+  if (auto contents = bundles.Find(file_name)) {
+    return lua::PushScript(L, *contents, absl::StrCat("@", file_name));
+  }
+  return lua::PushScriptFile(L, file_name);
+}
+
+}  // namespace
 
 constexpr char kGameScriptPath[] = "/dmlab2d/lib/game_scripts";
 constexpr char kLuaJitModulesPath[] = "/../luajit_archive/src";
@@ -74,10 +140,87 @@ int EnvLuaApi::AddSetting(absl::string_view key, absl::string_view value) {
     SetLevelDirectory(std::string(value));
     return 0;
   }
+  if (key == "assetBundle") {
+    return MountAssetBundle(std::string(value));
+  }
+  if (absl::StartsWith(key, "luaGc")) {
+    return SetGcSetting(key, value);
+  }
+  if (key == "propertySubscriptions") {
+    subscribed_properties_ = absl::StrSplit(value, ',', absl::SkipEmpty());
+    return 0;
+  }
+  if (key == "luaAllocator") {
+    if (value == "system" || value == "pool") {
+      lua_vm_.UseCountingAllocator();
+    }
+    lua::Allocator* allocator = lua_vm_.allocator();
+    if (value == "system") {
+      if (allocator != nullptr) {
+        allocator->EnablePooling(false);
+      }
+      return 0;
+    }
+    if (value == "pool" && allocator != nullptr) {
+      allocator->EnablePooling(true);
+      if (allocator->pooling_enabled()) {
+        return 0;
+      }
+    }
+    SetErrorMessage(absl::StrCat("Invalid settings 'luaAllocator' : ", value));
+    return 1;
+  }
   settings_.emplace(key, value);
   return 0;
 }
 
+int EnvLuaApi::SetGcSetting(absl::string_view key, absl::string_view value) {
+  if (key == "luaGcMode") {
+    if (value == "incremental") {
+#ifdef LUA_GCINC
+      gc_settings_.emplace_back(LUA_GCINC, 0);
+#endif
+      return 0;
+    }
+#ifdef LUA_GCGEN
+    if (value == "generational") {
+      gc_settings_.emplace_back(LUA_GCGEN, 0);
+      return 0;
+    }
+#endif
+    SetErrorMessage(absl::StrCat("Invalid settings 'luaGcMode' : ", value));
+    return 1;
+  }
+  int int_value;
+  if (!absl::SimpleAtoi(value, &int_value) || int_value < 0) {
+    SetErrorMessage(absl::StrCat("Invalid settings '", key, "' : ", value));
+    return 1;
+  }
+  if (key == "luaGcPause") {
+    gc_settings_.emplace_back(LUA_GCSETPAUSE, int_value);
+  } else if (key == "luaGcStepMul") {
+    gc_settings_.emplace_back(LUA_GCSETSTEPMUL, int_value);
+  } else if (key == "luaGcStepSize") {
+    gc_step_size_ = int_value;
+  } else {
+    SetErrorMessage(absl::StrCat("Unknown setting '", key, "'"));
+    return 1;
+  }
+  return 0;
+}
+
+int EnvLuaApi::MountAssetBundle(const std::string& bundle_path) {
+  std::string error;
+  if (!asset_bundles_.Mount(bundle_path, ExecutableRunfiles(), &error)) {
+    SetErrorMessage(absl::StrCat("Invalid settings 'assetBundle' : ", error));
+    return 1;
+  }
+  file_system_ =
+      FileSystem(executable_runfiles_, asset_bundles_.ReadOnlyFileSystem());
+  has_asset_bundle_ = true;
+  return 0;
+}
+
 void EnvLuaApi::SetLevelName(absl::string_view level_name) {
   if (!level_name.empty() && level_name.front() == '=') {
     level_script_content_ = level_name.substr(1);
@@ -128,7 +271,8 @@ lua::NResultsOr EnvLuaApi::PushLevelScriptAndName() {
     if (!level_directory_.empty()) {
       lua_vm_.AddPathToSearchers(level_directory_);
     }
-    if (auto result = lua::PushScriptFile(L, level_name_); !result.ok()) {
+    if (auto result = PushScriptFileOrBundled(L, asset_bundles_, level_name_);
+        !result.ok()) {
       return result;
     }
     lua::Push(L, level_name_);
@@ -140,7 +284,8 @@ lua::NResultsOr EnvLuaApi::PushLevelScriptAndName() {
 
   auto level_directory = GetLevelDirectory();
   auto level_path = absl::StrCat(level_directory, "/", level_name_, ".lua");
-  if (std::ifstream f(level_path.c_str()); f.good()) {
+  if (asset_bundles_.Find(level_path) ||
+      std::ifstream(level_path.c_str()).good()) {
     auto last_sep = level_path.find_last_of('/');
     auto level_root = level_path.substr(0, last_sep);
     if (level_root != level_directory) {
@@ -154,7 +299,8 @@ lua::NResultsOr EnvLuaApi::PushLevelScriptAndName() {
   lua_vm_.AddPathToSearchers(level_directory);
   lua_vm_.AddPathToSearchers(ExecutableRunfiles());
 
-  if (auto result = lua::PushScriptFile(L, level_path); !result.ok()) {
+  if (auto result = PushScriptFileOrBundled(L, asset_bundles_, level_path);
+      !result.ok()) {
     return result;
   }
   lua::Push(L, level_path);
@@ -164,8 +310,14 @@ lua::NResultsOr EnvLuaApi::PushLevelScriptAndName() {
 int EnvLuaApi::Init() {
   lua_State* L = lua_vm_.get();
   lua::StackResetter stack_resetter(L);
+  for (const auto& [what, data] : gc_settings_) {
+    lua_gc(L, what, data);
+  }
   tensor::LuaTensorRegister(L);
   LuaRandom::Register(L);
+  if (has_asset_bundle_) {
+    lua_vm_.AddSearcher(&AssetBundleSearcher, {&asset_bundles_});
+  }
   if (StoreError(PushLevelScriptAndName())) {
     return 1;
   }
@@ -225,6 +377,9 @@ int EnvLuaApi::Init() {
       StoreError(MutableEpisode()->BindApi(script_table_ref_))) {
     return error_value != 0 ? error_value : 1;
   }
+  if (!subscribed_properties_.empty()) {
+    MutableObservations()->SubscribeProperties(subscribed_properties_);
+  }
   return 0;
 }
 
@@ -237,7 +392,23 @@ int EnvLuaApi::Start(int episode, int seed) {
   MutableEvents()->Clear();
   EnginePrbg()->seed(static_cast<std::uint64_t>(seed) ^
                      (static_cast<std::uint64_t>(mixer_seed_) << 32));
-  return StoreError(MutableEpisode()->Start(episode, MakeRandomSeed())) ? 1 : 0;
+  if (StoreError(MutableEpisode()->Start(episode, MakeRandomSeed()))) {
+    return 1;
+  }
+  // The level has rebuilt its state, so the previous episode is garbage.
+  // Collect it and give the slabs it occupied back to the system.
+  lua::Allocator* allocator = lua_vm_.allocator();
+  if (allocator != nullptr && allocator->pooling_enabled()) {
+    lua_gc(lua_vm_.get(), LUA_GCCOLLECT, 0);
+    allocator->Compact();
+  }
+  if (!subscribed_properties_.empty()) {
+    MutableObservations()->ReadSubscribedProperties(MutableProperties());
+  }
+  if (const auto* stats = lua_vm_.allocator_stats()) {
+    bytes_allocated_at_step_end_ = stats->bytes_allocated;
+  }
+  return 0;
 }
 
 lua::NResultsOr EnvLuaApi::ApiInit(int* error_value) {
@@ -280,7 +451,46 @@ EnvCApi_EnvironmentStatus EnvLuaApi::Advance(int number_of_steps,
   if (StoreError(MutableEpisode()->Advance(&status, reward))) {
     return EnvCApi_EnvironmentStatus_Error;
   }
+  if (!subscribed_properties_.empty()) {
+    MutableObservations()->ReadSubscribedProperties(MutableProperties());
+  }
+  if (const auto* stats = lua_vm_.allocator_stats()) {
+    bytes_allocated_last_step_ =
+        stats->bytes_allocated - bytes_allocated_at_step_end_;
+    bytes_allocated_at_step_end_ = stats->bytes_allocated;
+  }
+  if (gc_step_size_ > 0) {
+    lua_gc(lua_vm_.get(), LUA_GCSTEP, gc_step_size_);
+  }
   return status;
 }
 
+EnvCApi_PropertyResult EnvLuaApi::ReadProperty(const char* key,
+                                               const char** value) {
+  constexpr absl::string_view kEngineLuaPrefix = "engine.lua.";
+  absl::string_view name = key;
+  if (!absl::ConsumePrefix(&name, kEngineLuaPrefix)) {
+    return MutableProperties()->ReadProperty(key, value);
+  }
+  const lua::Vm::AllocatorStats* stats = lua_vm_.allocator_stats();
+  if (name == "bytesInUse") {
+    lua_State* L = lua_vm_.get();
+    engine_property_storage_ = absl::StrCat(
+        stats ? stats->bytes_in_use
+              : lua_gc(L, LUA_GCCOUNT, 0) * std::size_t{1024} +
+                    lua_gc(L, LUA_GCCOUNTB, 0));
+  } else if (name == "bytesAllocated" && stats != nullptr) {
+    engine_property_storage_ = absl::StrCat(stats->bytes_allocated);
+  } else if (name == "bytesAllocatedLastStep" && stats != nullptr) {
+    engine_property_storage_ = absl::StrCat(bytes_allocated_last_step_);
+  } else if (name == "bytesPooled" && stats != nullptr) {
+    engine_property_storage_ = absl::StrCat(stats->bytes_pooled);
+  } else {
+    *value = "";
+    return EnvCApi_PropertyResult_NotFound;
+  }
+  *value = engine_property_storage_.c_str();
+  return EnvCApi_PropertyResult_Success;
+}
+
 }  // namespace deepmind::lab2d
@@ -23,6 +23,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -36,6 +37,7 @@
 #include "dmlab2d/lib/lua/table_ref.h"
 #include "dmlab2d/lib/lua/vm.h"
 #include "dmlab2d/lib/system/file_system/file_system.h"
+#include "dmlab2d/lib/util/default_read_only_file_system.h"
 #include "dmlab2d/lib/util/file_reader_types.h"
 #include "third_party/rl_api/env_c_api.h"
 
@@ -51,8 +53,20 @@ class EnvLuaApi {
 
   // If key is 'levelName' then calls SetLevelName with value.
   // If key is 'mixerSeed' then all built-in random number generators will
-  // generate a differnt sequence when given the same seed. Otherwise inserts
-  // 'key' 'value' into settings_ ready to be processed by init call in Lua.
+  // generate a differnt sequence when given the same seed.
+  // If key is 'assetBundle' then the asset bundle at path value is mounted at
+  // the runfiles root for this environment only, and level scripts, Lua
+  // modules and files read through its read-only file system are served from
+  // it. Keys starting with 'luaGc' configure the garbage collector of the
+  // Lua VM, see SetGcSetting.
+  // If key is 'luaAllocator' then the Lua VM switches to a counting allocator
+  // over malloc ('system') that can also serve small allocations from
+  // size-class pools compacted at the start of each episode ('pool'). By
+  // default the VM uses the Lua implementation's allocator. If key is
+  // 'propertySubscriptions' then value is a comma-separated list of property
+  // keys whose numeric values are read in bulk after each Start and Advance
+  // and returned in the observation 'PROPERTIES'. Otherwise inserts 'key'
+  // 'value' into settings_ ready to be processed by init call in Lua.
   // Must be called before Init.
   int AddSetting(absl::string_view key, absl::string_view value);
 
@@ -70,6 +84,17 @@ class EnvLuaApi {
   // Returns the status of the environment.
   EnvCApi_EnvironmentStatus Advance(int number_of_steps, double* reward);
 
+  // Reads the engine properties under 'engine.lua.' and forwards all other
+  // keys to the level's readProperty.
+  EnvCApi_PropertyResult ReadProperty(const char* key, const char** value);
+
+  // Bytes the Lua VM allocated in the last step: from the end of the previous
+  // call to Advance or Start to the end of the last call to Advance. This
+  // includes observations and actions, which are processed between calls.
+  std::uint64_t BytesAllocatedLastStep() const {
+    return bytes_allocated_last_step_;
+  }
+
   // Path to where DeepMind Lab assets are stored.
   const std::string& ExecutableRunfiles() const { return executable_runfiles_; }
 
@@ -152,6 +177,21 @@ class EnvLuaApi {
   // Returns the path to the level directory.
   std::string GetLevelDirectory();
 
+  // Mounts the asset bundle at 'bundle_path' at the runfiles root of this
+  // environment.
+  // Must be called before Init.
+  int MountAssetBundle(const std::string& bundle_path);
+
+  // Records a garbage collector setting, applied to the Lua VM by Init:
+  // 'luaGcPause' and 'luaGcStepMul' set the collector's pause and step
+  // multiplier, in percent.
+  // 'luaGcStepSize' runs an incremental collection step of that many KiB at
+  // the end of every Advance, so collection work is spread evenly over the
+  // steps instead of being triggered by allocation. Default 0 (off).
+  // 'luaGcMode' is 'incremental' or, on Lua versions that support it,
+  // 'generational'.
+  int SetGcSetting(absl::string_view key, absl::string_view value);
+
   // The context's Lua VM. The top of the stack of the VM is zero before and
   // after any call.
   lua::Vm lua_vm_;
@@ -168,6 +208,25 @@ class EnvLuaApi {
 
   std::vector<std::string> require_order_;
 
+  // Whether an asset bundle was mounted for this environment.
+  bool has_asset_bundle_ = false;
+
+  // Keys of the properties read into the observation 'PROPERTIES'.
+  std::vector<std::string> subscribed_properties_;
+
+  // Arguments of the lua_gc calls made by Init to configure the collector.
+  // Deferred to Init because 'luaAllocator' may replace the Lua state.
+  std::vector<std::pair<int, int>> gc_settings_;
+
+  // Size in KiB of the collection step run after each Advance.
+  int gc_step_size_ = 0;
+
+  std::uint64_t bytes_allocated_at_step_end_ = 0;
+  std::uint64_t bytes_allocated_last_step_ = 0;
+
+  // Storage for the last engine property read.
+  std::string engine_property_storage_;
+
   // The name of the script to run on first Init.
   std::string level_name_;
 
@@ -190,6 +249,9 @@ class EnvLuaApi {
   // each episode with the episode start seed.
   std::mt19937_64 engine_prbg_;
 
+  // The asset bundles mounted for this environment.
+  util::AssetBundleFileSystem asset_bundles_;
+
   // An object for storing location of `runfiles` directory.
   FileSystem file_system_;
 
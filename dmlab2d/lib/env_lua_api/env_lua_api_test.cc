@@ -17,13 +17,18 @@
 #include "dmlab2d/lib/env_lua_api/env_lua_api.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <string>
 #include <vector>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "dmlab2d/lib/lua/allocator.h"
+#include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/util/files.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,8 +40,12 @@ namespace {
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Eq;
+using ::testing::Gt;
 using ::testing::HasSubstr;
+using ::testing::IsNull;
+using ::testing::Lt;
 using ::testing::Not;
+using ::testing::NotNull;
 using ::testing::StrEq;
 using ::testing::UnorderedElementsAreArray;
 
@@ -319,6 +328,174 @@ TEST_F(Test, BadMixerSeed) {
               HasSubstr("Invalid settings 'mixerSeed' : hello"));
 }
 
+constexpr char kAllocatePerStep[] = R"(=
+return {
+  init = function(_, kwargs)
+    for k, v in pairs(kwargs) do
+      error('Unrecognised setting ' .. k)
+    end
+  end,
+  start = function() end,
+  advance = function()
+    local garbage = {}
+    for i = 1, 1000 do
+      garbage[i] = {i}
+    end
+    return true, 0
+  end,
+  readProperty = function(_, key)
+    return 'level:' .. key
+  end,
+}
+)";
+
+TEST_F(Test, GcSettings) {
+  ASSERT_THAT(env_.AddSetting("levelName", kAllocatePerStep), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("luaGcPause", "150"), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("luaGcStepMul", "400"), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("luaGcStepSize", "64"), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("luaGcMode", "incremental"), Eq(0))
+      << env_.ErrorMessage();
+  // May replace the Lua state; the collector settings still apply.
+  ASSERT_THAT(env_.AddSetting("luaAllocator", "system"), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.Init(), Eq(0)) << env_.ErrorMessage();
+  EXPECT_THAT(lua_gc(env_.mutable_lua_vm()->get(), LUA_GCSETPAUSE, 150),
+              Eq(150));
+  ASSERT_THAT(env_.Start(0, 0), Eq(0)) << env_.ErrorMessage();
+  double reward = 0.0;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_THAT(env_.Advance(1, &reward),
+                Eq(EnvCApi_EnvironmentStatus_Running))
+        << env_.ErrorMessage();
+  }
+}
+
+TEST_F(Test, BadGcSettings) {
+  ASSERT_THAT(env_.AddSetting("luaGcPause", "-1"), Not(Eq(0)));
+  EXPECT_THAT(absl::string_view(env_.ErrorMessage()),
+              HasSubstr("Invalid settings 'luaGcPause' : -1"));
+  ASSERT_THAT(env_.AddSetting("luaGcStepMul", "fast"), Not(Eq(0)));
+  EXPECT_THAT(absl::string_view(env_.ErrorMessage()),
+              HasSubstr("Invalid settings 'luaGcStepMul' : fast"));
+  ASSERT_THAT(env_.AddSetting("luaGcMode", "manual"), Not(Eq(0)));
+  EXPECT_THAT(absl::string_view(env_.ErrorMessage()),
+              HasSubstr("Invalid settings 'luaGcMode' : manual"));
+  ASSERT_THAT(env_.AddSetting("luaGcSpeed", "1"), Not(Eq(0)));
+  EXPECT_THAT(absl::string_view(env_.ErrorMessage()),
+              HasSubstr("Unknown setting 'luaGcSpeed'"));
+}
+
+TEST_F(Test, EngineProperties) {
+  ASSERT_THAT(env_.AddSetting("luaAllocator", "system"), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("levelName", kAllocatePerStep), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.Init(), Eq(0)) << env_.ErrorMessage();
+  ASSERT_THAT(env_.Start(0, 0), Eq(0)) << env_.ErrorMessage();
+  double reward = 0.0;
+  ASSERT_THAT(env_.Advance(1, &reward), Eq(EnvCApi_EnvironmentStatus_Running))
+      << env_.ErrorMessage();
+
+  const char* value = nullptr;
+  ASSERT_THAT(env_.ReadProperty("engine.lua.bytesInUse", &value),
+              Eq(EnvCApi_PropertyResult_Success));
+  std::size_t bytes_in_use = 0;
+  EXPECT_TRUE(absl::SimpleAtoi(value, &bytes_in_use)) << value;
+  EXPECT_THAT(bytes_in_use, Gt(0));
+
+  if (env_.mutable_lua_vm()->allocator_stats() != nullptr) {
+    ASSERT_THAT(env_.ReadProperty("engine.lua.bytesAllocatedLastStep", &value),
+                Eq(EnvCApi_PropertyResult_Success));
+    EXPECT_THAT(value, StrEq(absl::StrCat(env_.BytesAllocatedLastStep())));
+    // At least the 1000 tables allocated by the step.
+    EXPECT_THAT(env_.BytesAllocatedLastStep(), Gt(1000 * sizeof(void*)));
+    ASSERT_THAT(env_.ReadProperty("engine.lua.bytesAllocated", &value),
+                Eq(EnvCApi_PropertyResult_Success));
+  }
+
+  EXPECT_THAT(env_.ReadProperty("engine.lua.missing", &value),
+              Eq(EnvCApi_PropertyResult_NotFound));
+  ASSERT_THAT(env_.ReadProperty("engine", &value),
+              Eq(EnvCApi_PropertyResult_Success));
+  EXPECT_THAT(value, StrEq("level:engine"));
+}
+
+TEST_F(Test, PooledAllocator) {
+  EXPECT_THAT(env_.mutable_lua_vm()->allocator(), IsNull());
+  if (env_.AddSetting("luaAllocator", "pool") != 0) {
+    GTEST_SKIP() << "Lua implementation does not support custom allocators.";
+  }
+  const lua::Allocator* allocator = env_.mutable_lua_vm()->allocator();
+  ASSERT_THAT(allocator, NotNull());
+  ASSERT_THAT(env_.AddSetting("levelName", kAllocatePerStep), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.Init(), Eq(0)) << env_.ErrorMessage();
+  double reward = 0.0;
+  std::size_t max_slabs = 0;
+  for (int episode = 0; episode < 3; ++episode) {
+    ASSERT_THAT(env_.Start(episode, 0), Eq(0)) << env_.ErrorMessage();
+    for (int step = 0; step < 20; ++step) {
+      ASSERT_THAT(env_.Advance(1, &reward),
+                  Eq(EnvCApi_EnvironmentStatus_Running))
+          << env_.ErrorMessage();
+    }
+    max_slabs = std::max(max_slabs, allocator->stats().num_slabs);
+  }
+  const char* value = nullptr;
+  ASSERT_THAT(env_.ReadProperty("engine.lua.bytesPooled", &value),
+              Eq(EnvCApi_PropertyResult_Success));
+  EXPECT_THAT(value, StrEq(absl::StrCat(allocator->stats().bytes_pooled)));
+  EXPECT_THAT(allocator->stats().bytes_pooled, Gt(0));
+
+  // Starting an episode collects the previous one and releases its slabs.
+  ASSERT_THAT(env_.Start(3, 0), Eq(0)) << env_.ErrorMessage();
+  EXPECT_THAT(allocator->stats().num_slabs, Lt(max_slabs));
+}
+
+TEST_F(Test, BadAllocatorSetting) {
+  ASSERT_THAT(env_.AddSetting("luaAllocator", "arena"), Not(Eq(0)));
+  EXPECT_THAT(absl::string_view(env_.ErrorMessage()),
+              HasSubstr("Invalid settings 'luaAllocator' : arena"));
+  EXPECT_THAT(env_.AddSetting("luaAllocator", "system"), Eq(0));
+}
+
+TEST_F(Test, PropertySubscriptions) {
+  ASSERT_THAT(env_.AddSetting("levelName", kFullApi), Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.AddSetting("propertySubscriptions", "steps,coverage,x"),
+              Eq(0))
+      << env_.ErrorMessage();
+  ASSERT_THAT(env_.Init(), Eq(0)) << env_.ErrorMessage();
+  ASSERT_THAT(env_.GetObservations().Count(), Eq(2));
+  EXPECT_THAT(env_.GetObservations().Name(1), StrEq("PROPERTIES"));
+  EnvCApi_ObservationSpec spec = {};
+  env_.GetObservations().Spec(1, &spec);
+  EXPECT_THAT(spec.type, Eq(EnvCApi_ObservationDoubles));
+  EXPECT_THAT(absl::MakeConstSpan(spec.shape, spec.dims), ElementsAre(3));
+
+  ASSERT_THAT(env_.Start(0, 0), Eq(0)) << env_.ErrorMessage();
+  EnvCApi_Observation obs = {};
+  env_.MutableObservations()->Observation(1, &obs);
+  ASSERT_THAT(absl::MakeConstSpan(obs.spec.shape, obs.spec.dims),
+              ElementsAre(3));
+  EXPECT_THAT(obs.payload.doubles[0], Eq(10));
+  EXPECT_TRUE(std::isnan(obs.payload.doubles[1]));
+  EXPECT_TRUE(std::isnan(obs.payload.doubles[2]));
+
+  ASSERT_THAT(env_.MutableProperties()->WriteProperty("steps", "20"),
+              Eq(EnvCApi_PropertyResult_Success));
+  double reward = 0.0;
+  ASSERT_THAT(env_.Advance(1, &reward), Eq(EnvCApi_EnvironmentStatus_Running))
+      << env_.ErrorMessage();
+  env_.MutableObservations()->Observation(1, &obs);
+  EXPECT_THAT(obs.payload.doubles[0], Eq(20));
+}
+
 TEST_F(Test, ErrorOnNoLevelName) {
   ASSERT_THAT(env_.Init(), Not(Eq(0)));
   EXPECT_THAT(absl::string_view(env_.ErrorMessage()), HasSubstr("'levelName'"));
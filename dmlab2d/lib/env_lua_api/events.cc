@@ -16,11 +16,18 @@
 
 #include "dmlab2d/lib/env_lua_api/events.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
 #include "dmlab2d/lib/lua/class.h"
 #include "dmlab2d/lib/lua/lua.h"
+#include "dmlab2d/lib/lua/push.h"
 #include "dmlab2d/lib/lua/read.h"
 #include "dmlab2d/lib/system/tensor/lua/tensor.h"
 #include "dmlab2d/lib/system/tensor/tensor_view.h"
@@ -38,7 +45,11 @@ class LuaEventsModule : public lua::Class<LuaEventsModule> {
 
   // Registers classes metatable with Lua.
   static void Register(lua_State* L) {
-    const Class::Reg methods[] = {{"add", Member<&LuaEventsModule::Add>}};
+    const Class::Reg methods[] = {
+        {"add", Member<&LuaEventsModule::Add>},
+        {"defineColumns", Member<&LuaEventsModule::DefineColumns>},
+        {"addRow", Member<&LuaEventsModule::AddRow>},
+    };
     Class::Register(L, methods);
   }
 
@@ -91,9 +102,98 @@ class LuaEventsModule : public lua::Class<LuaEventsModule> {
     return 0;
   }
 
+  // Signature events:defineColumns(eventName, columnTypes[, capacity])
+  // Defines a columnar event type. 'columnTypes' is an array of 'byte',
+  // 'int32', 'int64' or 'double'. Returns the id to pass to addRow.
+  // [-(3|4), 1, e]
+  lua::NResultsOr DefineColumns(lua_State* L) {
+    std::string name;
+    if (!lua::Read(L, 2, &name)) {
+      return "Event name must be a string";
+    }
+    std::vector<std::string> type_names;
+    if (!lua::Read(L, 3, &type_names) || type_names.empty()) {
+      return "Column types must be a non-empty array of strings";
+    }
+    std::vector<EnvCApi_ObservationType_enum> types;
+    types.reserve(type_names.size());
+    for (const auto& type_name : type_names) {
+      if (type_name == "byte") {
+        types.push_back(EnvCApi_ObservationBytes);
+      } else if (type_name == "int32") {
+        types.push_back(EnvCApi_ObservationInt32s);
+      } else if (type_name == "int64") {
+        types.push_back(EnvCApi_ObservationInt64s);
+      } else if (type_name == "double") {
+        types.push_back(EnvCApi_ObservationDoubles);
+      } else {
+        return absl::StrCat("Invalid column type '", type_name,
+                            "'. Must be one of byte|int32|int64|double.");
+      }
+    }
+    int capacity = 0;
+    if (!lua::Read(L, 4, &capacity) && !lua_isnoneornil(L, 4)) {
+      return "Capacity must be a number";
+    }
+    int id = ctx_->DefineColumns(name, std::move(types), std::max(capacity, 0));
+    if (id < 0) {
+      return absl::StrCat("Event '", name,
+                          "' already defined with different columns");
+    }
+    lua::Push(L, id);
+    return 1;
+  }
+
+  // Signature events:addRow(columnsId, value1[, value2 ...])
+  // Appends a row of numbers to a columnar event type, one per column.
+  // [-(2 + #columns), 0, e]
+  lua::NResultsOr AddRow(lua_State* L) {
+    int id;
+    if (!lua::Read(L, 2, &id) || id < 0 || id >= ctx_->ColumnarTypeCount()) {
+      return "First argument must be an id returned by defineColumns";
+    }
+    const int num_columns = ctx_->ColumnTypes(id).size();
+    if (lua_gettop(L) != num_columns + 2) {
+      return absl::StrCat("Expected ", num_columns, " values, got ",
+                          lua_gettop(L) - 2);
+    }
+    row_.clear();
+    for (int i = 0; i < num_columns; ++i) {
+      if (lua_type(L, i + 3) != LUA_TNUMBER) {
+        return absl::StrCat("Value ", i + 1, " must be a number");
+      }
+      row_.push_back(lua_tonumber(L, i + 3));
+    }
+    ctx_->AddRow(id, row_);
+    return 0;
+  }
+
   Events* ctx_;
+  // Values of the row being added.
+  std::vector<double> row_;
 };
 
+std::size_t ElementSize(EnvCApi_ObservationType_enum type) {
+  switch (type) {
+    case EnvCApi_ObservationBytes:
+      return sizeof(unsigned char);
+    case EnvCApi_ObservationDoubles:
+      return sizeof(double);
+    case EnvCApi_ObservationInt32s:
+      return sizeof(std::int32_t);
+    case EnvCApi_ObservationInt64s:
+      return sizeof(std::int64_t);
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+void AppendValue(T value, std::vector<unsigned char>* data) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+  data->insert(data->end(), bytes, bytes + sizeof(T));
+}
+
 }  // namespace
 
 lua::NResultsOr Events::Module(lua_State* L) {
@@ -107,17 +207,69 @@ lua::NResultsOr Events::Module(lua_State* L) {
   }
 }
 
-int Events::Add(std::string name) {
+int Events::TypeId(std::string name) {
   auto iter_inserted = name_to_id_.emplace(std::move(name), names_.size());
   if (iter_inserted.second) {
     names_.push_back(iter_inserted.first->first.c_str());
   }
+  return iter_inserted.first->second;
+}
 
+int Events::Add(std::string name) {
   int id = events_.size();
-  events_.push_back(Event{iter_inserted.first->second});
+  events_.push_back(Event{TypeId(std::move(name))});
   return id;
 }
 
+int Events::DefineColumns(
+    std::string name, std::vector<EnvCApi_ObservationType_enum> column_types,
+    std::size_t capacity) {
+  auto iter_inserted = name_to_columns_id_.emplace(name, columns_.size());
+  if (!iter_inserted.second) {
+    int columns_id = iter_inserted.first->second;
+    return columns_[columns_id].types == column_types ? columns_id : -1;
+  }
+  Columns& columns = columns_.emplace_back();
+  columns.type_id = TypeId(std::move(name));
+  columns.data.resize(column_types.size());
+  for (std::size_t i = 0; i < column_types.size(); ++i) {
+    columns.data[i].reserve(capacity * ElementSize(column_types[i]));
+  }
+  columns.types = std::move(column_types);
+  return iter_inserted.first->second;
+}
+
+absl::Span<const EnvCApi_ObservationType_enum> Events::ColumnTypes(
+    int columns_id) const {
+  return columns_[columns_id].types;
+}
+
+void Events::AddRow(int columns_id, absl::Span<const double> values) {
+  Columns& columns = columns_[columns_id];
+  if (columns.num_rows++ == 0) {
+    active_columns_.push_back(columns_id);
+  }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    std::vector<unsigned char>& data = columns.data[i];
+    switch (columns.types[i]) {
+      case EnvCApi_ObservationBytes:
+        data.push_back(static_cast<std::int64_t>(values[i]));
+        break;
+      case EnvCApi_ObservationDoubles:
+        AppendValue(values[i], &data);
+        break;
+      case EnvCApi_ObservationInt32s:
+        AppendValue(static_cast<std::int32_t>(values[i]), &data);
+        break;
+      case EnvCApi_ObservationInt64s:
+        AppendValue(static_cast<std::int64_t>(values[i]), &data);
+        break;
+      default:
+        LOG(FATAL) << "Column type: " << columns.types[i] << " not supported";
+    }
+  }
+}
+
 void Events::AddObservation(int event_id, std::string string_value) {
   Event& event = events_[event_id];
   event.observations.emplace_back();
@@ -190,6 +342,14 @@ void Events::AddObservation(int event_id, std::vector<int> shape,
 }
 
 void Events::Clear() {
+  for (int columns_id : active_columns_) {
+    Columns& columns = columns_[columns_id];
+    columns.num_rows = 0;
+    for (auto& data : columns.data) {
+      data.clear();
+    }
+  }
+  active_columns_.clear();
   events_.clear();
   strings_.clear();
   shapes_.clear();
@@ -199,7 +359,45 @@ void Events::Clear() {
   int64s_.clear();
 }
 
+void Events::ExportColumns(const Columns& columns, EnvCApi_Event* event) {
+  observations_.clear();
+  observations_.reserve(columns.types.size());
+  for (std::size_t i = 0; i < columns.types.size(); ++i) {
+    auto& observation_out = observations_.emplace_back();
+    observation_out.spec.type = columns.types[i];
+    observation_out.spec.dims = 1;
+    observation_out.spec.shape = &columns.num_rows;
+    const unsigned char* data = columns.data[i].data();
+    switch (columns.types[i]) {
+      case EnvCApi_ObservationBytes:
+        observation_out.payload.bytes = data;
+        break;
+      case EnvCApi_ObservationDoubles:
+        observation_out.payload.doubles = reinterpret_cast<const double*>(data);
+        break;
+      case EnvCApi_ObservationInt32s:
+        observation_out.payload.int32s =
+            reinterpret_cast<const std::int32_t*>(data);
+        break;
+      case EnvCApi_ObservationInt64s:
+        observation_out.payload.int64s =
+            reinterpret_cast<const std::int64_t*>(data);
+        break;
+      default:
+        LOG(FATAL) << "Column type: " << columns.types[i] << " not supported";
+    }
+  }
+  event->id = columns.type_id;
+  event->observations = observations_.data();
+  event->observation_count = observations_.size();
+}
+
 void Events::Export(int event_idx, EnvCApi_Event* event) {
+  if (event_idx >= static_cast<int>(events_.size())) {
+    ExportColumns(columns_[active_columns_[event_idx - events_.size()]],
+                  event);
+    return;
+  }
   const auto& internal_event = events_[event_idx];
   observations_.clear();
   observations_.reserve(internal_event.observations.size());
@@ -17,11 +17,13 @@
 #ifndef DMLAB2D_LIB_ENV_LUA_API_EVENTS_H_
 #define DMLAB2D_LIB_ENV_LUA_API_EVENTS_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 #include "absl/container/node_hash_map.h"
+#include "absl/types/span.h"
 #include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
 #include "third_party/rl_api/env_c_api.h"
@@ -32,7 +34,13 @@ namespace deepmind::lab2d {
 // out of DM Lab using the events part of the EnvCApi. (See: env_c_api.h.)
 //
 // Each event contains a list of observations. Each observation type is one of
-// EnvCApi_Observation{Doubles,Bytes,String}.
+// EnvCApi_Observation{Doubles,Bytes,String,Int32s,Int64s}.
+//
+// Event types with a fixed schema can instead be defined as columnar. Each row
+// added to a columnar type appends one number to each of its typed columns,
+// without per-event allocation once the columns have grown. All rows of a type
+// added since the last Clear() are exported as a single event, following the
+// other events, whose observations are the columns as 1-D tensors.
 class Events {
  public:
   // Returns an event module. A pointer to Events must exist in the up
@@ -61,13 +69,34 @@ class Events {
   void AddObservation(int event_id, std::vector<int> shape,
                       std::vector<std::int64_t> int64_tensor);
 
+  // Defines a columnar event type called 'name' whose columns have the types
+  // 'column_types', each one of EnvCApi_Observation{Doubles,Bytes,Int32s,
+  // Int64s}. Storage for 'capacity' rows is allocated up front. Returns the id
+  // to pass to AddRow, or -1 if 'name' is already defined as a columnar type
+  // with different columns. Defining the same type again returns the same id.
+  int DefineColumns(std::string name,
+                    std::vector<EnvCApi_ObservationType_enum> column_types,
+                    std::size_t capacity = 0);
+
+  // Returns the number of columnar types defined.
+  int ColumnarTypeCount() const { return columns_.size(); }
+
+  // Returns the column types of columnar type 'columns_id'.
+  absl::Span<const EnvCApi_ObservationType_enum> ColumnTypes(
+      int columns_id) const;
+
+  // Appends a row to columnar type 'columns_id'. 'values' must have one value
+  // per column; each is converted to the type of its column.
+  void AddRow(int columns_id, absl::Span<const double> values);
+
   // Exports an event at 'event_idx', which must be in range [0, Count()), to an
   // EnvCApi_Event structure. Observations within the `event` are invalidated by
   // calls to non-const methods.
   void Export(int event_idx, EnvCApi_Event* event);
 
-  // Returns the number of events created since last call to ClearEvents().
-  int Count() const { return events_.size(); }
+  // Returns the number of events created since last call to ClearEvents(),
+  // counting each columnar type with rows as one event.
+  int Count() const { return events_.size() + active_columns_.size(); }
 
   // Returns the number of event types.
   int TypeCount() const { return names_.size(); }
@@ -102,9 +131,29 @@ class Events {
     std::vector<Observation> observations;
   };
 
+  struct Columns {
+    int type_id;  // Event type id.
+    // Number of rows added since the last call to Clear().
+    int num_rows = 0;
+    std::vector<EnvCApi_ObservationType_enum> types;
+    // Column data, 'num_rows' elements of the column's type each.
+    std::vector<std::vector<unsigned char>> data;
+  };
+
+  // Returns the type id of 'name', adding the type if it is new.
+  int TypeId(std::string name);
+
+  void ExportColumns(const Columns& columns, EnvCApi_Event* event);
+
   // Events generated since construction or last call to Clear().
   std::vector<Event> events_;
 
+  // Columnar event types, indexed by the id returned from DefineColumns.
+  std::vector<Columns> columns_;
+  absl::node_hash_map<std::string, int> name_to_columns_id_;
+  // Ids of the columnar types with rows, in order of their first row.
+  std::vector<int> active_columns_;
+
   // Bidirectional lookup for the mapping between type_id and event_name.
   // Strings in the primary container (the map) need to be stable.
   std::vector<const char*> names_;
@@ -0,0 +1,93 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Measures a step that emits one event per piece, as a zapping level does, and
+// exports them all: once as individual events and once as a columnar type.
+
+#include "absl/log/log.h"
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/env_lua_api/events.h"
+#include "dmlab2d/lib/lua/bind.h"
+#include "dmlab2d/lib/lua/call.h"
+#include "dmlab2d/lib/lua/lua.h"
+#include "dmlab2d/lib/lua/push_script.h"
+#include "dmlab2d/lib/lua/vm.h"
+#include "third_party/rl_api/env_c_api.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+constexpr int kEventsPerStep = 1000;
+
+constexpr char kAddEvents[] = R"(
+local events = require 'system.events'
+return function(n)
+  for i = 1, n do
+    events:add('zap', i, i % 31, 1.5)
+  end
+end
+)";
+
+constexpr char kAddRows[] = R"(
+local events = require 'system.events'
+local zap = events:defineColumns('zap', {'int32', 'int32', 'double'})
+return function(n)
+  for i = 1, n do
+    events:addRow(zap, i, i % 31, 1.5)
+  end
+end
+)";
+
+void RunStep(benchmark::State& state, const char* script) {
+  Events events;
+  lua::Vm vm = lua::CreateVm();
+  vm.AddCModuleToSearchers("system.events", &lua::Bind<Events::Module>,
+                           {&events});
+  lua_State* L = vm.get();
+  if (auto result = lua::PushScript(L, script, "script"); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  if (auto result = lua::Call(L, 0); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+
+  double checksum = 0;
+  for (auto _ : state) {
+    events.Clear();
+    lua_pushvalue(L, -1);
+    lua_pushinteger(L, kEventsPerStep);
+    if (auto result = lua::Call(L, 1); !result.ok()) {
+      LOG(FATAL) << result.error();
+    }
+    EnvCApi_Event event;
+    for (int i = 0; i < events.Count(); ++i) {
+      events.Export(i, &event);
+      checksum += event.observations[0].spec.shape != nullptr;
+    }
+  }
+  benchmark::DoNotOptimize(checksum);
+  state.SetItemsProcessed(state.iterations() * kEventsPerStep);
+}
+
+void BM_AddEvents(benchmark::State& state) { RunStep(state, kAddEvents); }
+
+void BM_AddRows(benchmark::State& state) { RunStep(state, kAddRows); }
+
+BENCHMARK(BM_AddEvents);
+BENCHMARK(BM_AddRows);
+
+}  // namespace
+}  // namespace deepmind::lab2d
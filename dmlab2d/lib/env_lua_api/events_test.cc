@@ -17,6 +17,7 @@
 
 #include <cstring>
 #include <random>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -24,6 +25,7 @@
 #include "dmlab2d/lib/lua/call.h"
 #include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/lua/n_results_or_test_util.h"
+#include "dmlab2d/lib/lua/push.h"
 #include "dmlab2d/lib/lua/push_script.h"
 #include "dmlab2d/lib/lua/vm.h"
 #include "dmlab2d/lib/lua/vm_test_util.h"
@@ -39,8 +41,10 @@ namespace deepmind::lab2d {
 namespace {
 
 using ::deepmind::lab2d::lua::testing::IsOkAndHolds;
+using ::deepmind::lab2d::lua::testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 using ::testing::StrEq;
 
 class EventsTest : public lua::testing::TestWithVm {
@@ -214,5 +218,116 @@ TEST_F(EventsTest, ReadMixedEvents) {
   EXPECT_THAT(event.observations[4].payload.string, StrEq("Hello"));
 }
 
+constexpr char kColumnEvents[] = R"(
+local events = require 'system.events'
+
+local zap = events:defineColumns("zap", {"int32", "int64", "double", "byte"}, 8)
+events:add("start", "Hello")
+for i = 1, 3 do
+  events:addRow(zap, i, -i, i / 2, 250 + i)
+end
+local eaten = events:defineColumns("eaten", {"int32"})
+events:addRow(eaten, 7)
+return zap, eaten
+)";
+
+TEST_F(EventsTest, ReadColumnEvents) {
+  events_.Clear();
+  ASSERT_THAT(lua::PushScript(L, kColumnEvents, "kColumnEvents"),
+              IsOkAndHolds(1));
+  ASSERT_THAT(lua::Call(L, 0), IsOkAndHolds(2));
+  EXPECT_THAT(lua_tointeger(L, 1), Eq(0));
+  EXPECT_THAT(lua_tointeger(L, 2), Eq(1));
+  ASSERT_THAT(events_.TypeCount(), Eq(3));
+  EXPECT_THAT(events_.TypeName(0), StrEq("zap"));
+  EXPECT_THAT(events_.TypeName(1), StrEq("start"));
+  EXPECT_THAT(events_.TypeName(2), StrEq("eaten"));
+
+  // Columnar types follow the other events, with one event per type.
+  ASSERT_THAT(events_.Count(), Eq(3));
+  EnvCApi_Event event;
+  events_.Export(0, &event);
+  EXPECT_THAT(event.id, Eq(1));
+
+  events_.Export(1, &event);
+  EXPECT_THAT(event.id, Eq(0));
+  ASSERT_THAT(event.observation_count, Eq(4));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_THAT(absl::MakeConstSpan(event.observations[i].spec.shape,
+                                    event.observations[i].spec.dims),
+                ElementsAre(3));
+  }
+  ASSERT_THAT(event.observations[0].spec.type, Eq(EnvCApi_ObservationInt32s));
+  EXPECT_THAT(absl::MakeConstSpan(event.observations[0].payload.int32s, 3),
+              ElementsAre(1, 2, 3));
+  ASSERT_THAT(event.observations[1].spec.type, Eq(EnvCApi_ObservationInt64s));
+  EXPECT_THAT(absl::MakeConstSpan(event.observations[1].payload.int64s, 3),
+              ElementsAre(-1, -2, -3));
+  ASSERT_THAT(event.observations[2].spec.type, Eq(EnvCApi_ObservationDoubles));
+  EXPECT_THAT(absl::MakeConstSpan(event.observations[2].payload.doubles, 3),
+              ElementsAre(0.5, 1.0, 1.5));
+  ASSERT_THAT(event.observations[3].spec.type, Eq(EnvCApi_ObservationBytes));
+  EXPECT_THAT(absl::MakeConstSpan(event.observations[3].payload.bytes, 3),
+              ElementsAre(251, 252, 253));
+
+  events_.Export(2, &event);
+  EXPECT_THAT(event.id, Eq(2));
+  ASSERT_THAT(event.observation_count, Eq(1));
+  EXPECT_THAT(absl::MakeConstSpan(event.observations[0].payload.int32s, 1),
+              ElementsAre(7));
+
+  events_.Clear();
+  EXPECT_THAT(events_.Count(), Eq(0));
+  events_.AddRow(1, {8});
+  ASSERT_THAT(events_.Count(), Eq(1));
+  events_.Export(0, &event);
+  EXPECT_THAT(event.id, Eq(2));
+  ASSERT_THAT(event.observations[0].spec.shape[0], Eq(1));
+  EXPECT_THAT(event.observations[0].payload.int32s[0], Eq(8));
+}
+
+TEST_F(EventsTest, DefineColumnsAgain) {
+  EXPECT_THAT(events_.DefineColumns("zap", {EnvCApi_ObservationInt32s}),
+              Eq(0));
+  EXPECT_THAT(events_.DefineColumns("zap", {EnvCApi_ObservationInt32s}),
+              Eq(0));
+  EXPECT_THAT(events_.DefineColumns("zap", {EnvCApi_ObservationDoubles}),
+              Eq(-1));
+  EXPECT_THAT(events_.DefineColumns("eaten", {EnvCApi_ObservationDoubles}),
+              Eq(1));
+}
+
+constexpr char kBadColumnEvents[] = R"(
+local events = require 'system.events'
+local args = ...
+if args == 'type' then
+  events:defineColumns("zap", {"int16"})
+end
+local zap = events:defineColumns("zap", {"int32", "double"})
+if args == 'count' then
+  events:addRow(zap, 1)
+elseif args == 'value' then
+  events:addRow(zap, 1, "2")
+elseif args == 'id' then
+  events:addRow(zap + 1, 1, 2)
+end
+)";
+
+TEST_F(EventsTest, BadColumnEvents) {
+  const std::pair<const char*, const char*> cases[] = {
+      {"type", "Invalid column type 'int16'"},
+      {"count", "Expected 2 values, got 1"},
+      {"value", "Value 2 must be a number"},
+      {"id", "must be an id returned by defineColumns"},
+  };
+  for (const auto& [arg, error] : cases) {
+    ASSERT_THAT(lua::PushScript(L, kBadColumnEvents, "kBadColumnEvents"),
+                IsOkAndHolds(1));
+    lua::Push(L, arg);
+    EXPECT_THAT(lua::Call(L, 1), StatusIs(HasSubstr(error))) << arg;
+    lua_settop(L, 0);
+  }
+}
+
 }  // namespace
 }  // namespace deepmind::lab2d
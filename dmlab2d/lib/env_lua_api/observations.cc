@@ -20,11 +20,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <limits>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
+#include "dmlab2d/lib/env_lua_api/properties.h"
 #include "dmlab2d/lib/lua/call.h"
 #include "dmlab2d/lib/lua/class.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
@@ -91,7 +95,36 @@ lua::NResultsOr Observations::BindApi(lua::TableRef script_table_ref) {
   return 0;
 }
 
+void Observations::SubscribeProperties(std::vector<std::string> keys) {
+  properties_idx_ = infos_.size();
+  infos_.push_back(SpecInfo{"PROPERTIES", EnvCApi_ObservationDoubles,
+                            {static_cast<int>(keys.size())}});
+  properties_observation_.assign(keys.size(),
+                                 std::numeric_limits<double>::quiet_NaN());
+  property_keys_ = std::move(keys);
+}
+
+void Observations::ReadSubscribedProperties(Properties* properties) {
+  properties->ReadValues(property_keys_, &property_values_);
+  for (std::size_t i = 0; i < property_values_.size(); ++i) {
+    const auto& value = property_values_[i];
+    properties_observation_[i] =
+        value.result == EnvCApi_PropertyResult_Success &&
+                value.values.size() == 1
+            ? value.values.front()
+            : std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
 void Observations::Observation(int idx, EnvCApi_Observation* observation) {
+  if (idx == properties_idx_) {
+    const auto& info = infos_[idx];
+    observation->spec.type = info.type;
+    observation->spec.dims = info.shape.size();
+    observation->spec.shape = info.shape.data();
+    observation->payload.doubles = properties_observation_.data();
+    return;
+  }
   lua_State* L = script_table_ref_.LuaState();
   script_table_ref_.PushMemberFunction("observation");
   // Function must exist.
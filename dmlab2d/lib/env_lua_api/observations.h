@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "dmlab2d/lib/env_lua_api/properties.h"
 #include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
 #include "dmlab2d/lib/lua/table_ref.h"
@@ -35,6 +36,14 @@ class Observations {
   // Keeps a reference to the table for further calls.
   lua::NResultsOr BindApi(lua::TableRef script_table_ref);
 
+  // Adds the observation 'PROPERTIES', a DoubleTensor with one element per key
+  // in 'keys' holding the value of that property. Must be called after BindApi.
+  void SubscribeProperties(std::vector<std::string> keys);
+
+  // Reads the subscribed properties from 'properties' with a single bulk read.
+  // Properties that are missing or not a single number read as NaN.
+  void ReadSubscribedProperties(Properties* properties);
+
   // Script observation count.
   int Count() const { return infos_.size(); }
 
@@ -67,6 +76,12 @@ class Observations {
   // observation.
   lua::TableRef tensor_;
 
+  // Index of the 'PROPERTIES' observation in infos_, or -1.
+  int properties_idx_ = -1;
+  std::vector<std::string> property_keys_;
+  std::vector<Properties::Value> property_values_;
+  std::vector<double> properties_observation_;
+
   // Used to store the observation until the next call of observation.
   std::string string_;
   double double_;
@@ -16,12 +16,18 @@
 
 #include "dmlab2d/lib/env_lua_api/properties.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "dmlab2d/lib/lua/bind.h"
 #include "dmlab2d/lib/lua/call.h"
 #include "dmlab2d/lib/lua/lua.h"
@@ -30,6 +36,7 @@
 #include "dmlab2d/lib/lua/read.h"
 #include "dmlab2d/lib/lua/stack_resetter.h"
 #include "dmlab2d/lib/lua/table_ref.h"
+#include "dmlab2d/lib/system/tensor/lua/tensor.h"
 #include "third_party/rl_api/env_c_api.h"
 
 namespace deepmind::lab2d {
@@ -66,6 +73,56 @@ EnvCApi_PropertyResult ProcessResult(lua_State* L, lua::NResultsOr result,
   return EnvCApi_PropertyResult_PermissionDenied;
 }
 
+template <typename T>
+bool ReadTensorValue(lua_State* L, int idx, Properties::Value* value) {
+  auto* tensor = tensor::LuaTensor<T>::ReadObject(L, idx);
+  if (tensor == nullptr) {
+    return false;
+  }
+  const auto& view = tensor->tensor_view();
+  value->shape.assign(view.shape().begin(), view.shape().end());
+  value->values.clear();
+  view.ForEach([value](T v) { value->values.push_back(v); });
+  return true;
+}
+
+// Reads the number, numeric string or tensor at 'idx' into 'value'.
+void ReadValue(lua_State* L, int idx, Properties::Value* value) {
+  value->shape.clear();
+  value->values.clear();
+  value->result = EnvCApi_PropertyResult_Success;
+  switch (lua_type(L, idx)) {
+    case LUA_TNONE:
+    case LUA_TNIL:
+      value->result = EnvCApi_PropertyResult_NotFound;
+      return;
+    case LUA_TNUMBER:
+      value->values.push_back(lua_tonumber(L, idx));
+      return;
+    case LUA_TSTRING: {
+      std::size_t length = 0;
+      const char* string = lua_tolstring(L, idx, &length);
+      double number;
+      if (absl::SimpleAtod(absl::string_view(string, length), &number)) {
+        value->values.push_back(number);
+        return;
+      }
+      break;
+    }
+    default:
+      if (ReadTensorValue<double>(L, idx, value) ||
+          ReadTensorValue<float>(L, idx, value) ||
+          ReadTensorValue<std::int64_t>(L, idx, value) ||
+          ReadTensorValue<std::int32_t>(L, idx, value) ||
+          ReadTensorValue<std::int16_t>(L, idx, value) ||
+          ReadTensorValue<std::int8_t>(L, idx, value) ||
+          ReadTensorValue<std::uint8_t>(L, idx, value)) {
+        return;
+      }
+  }
+  value->result = EnvCApi_PropertyResult_InvalidArgument;
+}
+
 struct PropertyListCallbackData {
   void* userdata;
   void (*call)(void* userdata, const char* key,
@@ -164,6 +221,66 @@ EnvCApi_PropertyResult Properties::ReadProperty(const char* key,
   return ProcessResult(L, result, "readProperty");
 }
 
+void Properties::ReadValues(absl::Span<const std::string> keys,
+                            std::vector<Value>* values) {
+  values->resize(keys.size());
+  lua_State* L = script_table_ref_.LuaState();
+  lua::StackResetter stack_resetter(L);
+  const int top = lua_gettop(L);
+  script_table_ref_.PushMemberFunction("readProperties");
+  if (lua_isnil(L, -2)) {
+    lua_settop(L, top);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      Value& value = (*values)[i];
+      script_table_ref_.PushMemberFunction("readProperty");
+      if (lua_isnil(L, -2)) {
+        lua_settop(L, top);
+        value = Value();
+        continue;
+      }
+      lua::Push(L, keys[i]);
+      auto result = lua::Call(L, 2);
+      // Numbers returned by readProperty are property results.
+      if (result.n_results() == 1 && lua_type(L, top + 1) != LUA_TNUMBER) {
+        ReadValue(L, top + 1, &value);
+      } else {
+        value.shape.clear();
+        value.values.clear();
+        value.result = ProcessResult(L, result, "readProperty");
+      }
+      lua_settop(L, top);
+    }
+    return;
+  }
+
+  if (value_keys_table_.is_unbound() ||
+      !std::equal(keys.begin(), keys.end(), value_keys_.begin(),
+                  value_keys_.end())) {
+    value_keys_.assign(keys.begin(), keys.end());
+    value_keys_table_ = lua::TableRef::Create(L);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      value_keys_table_.Insert(i + 1, keys[i]);
+    }
+  }
+  lua::Push(L, value_keys_table_);
+  auto result = lua::Call(L, 2);
+  if (!result.ok() || result.n_results() != 1 || !lua_istable(L, top + 1)) {
+    LOG(ERROR) << "[readProperties] - "
+               << (result.ok() ? "Must return a table" : result.error());
+    for (auto& value : *values) {
+      value.result = EnvCApi_PropertyResult_PermissionDenied;
+      value.shape.clear();
+      value.values.clear();
+    }
+    return;
+  }
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    lua_rawgeti(L, top + 1, i + 1);
+    ReadValue(L, -1, &(*values)[i]);
+    lua_pop(L, 1);
+  }
+}
+
 EnvCApi_PropertyResult Properties::ListProperty(
     void* userdata, const char* list_key,
     void (*prop_callback)(void* userdata, const char* key,
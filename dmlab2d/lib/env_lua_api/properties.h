@@ -19,7 +19,9 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
 #include "dmlab2d/lib/lua/table_ref.h"
 #include "third_party/rl_api/env_c_api.h"
@@ -28,6 +30,15 @@ namespace deepmind::lab2d {
 
 class Properties {
  public:
+  // A property read as a number or tensor by ReadValues.
+  struct Value {
+    EnvCApi_PropertyResult result = EnvCApi_PropertyResult_NotFound;
+    // Shape of the value; empty for a number.
+    std::vector<int> shape;
+    // Elements of the value in row-major order.
+    std::vector<double> values;
+  };
+
   // Returns property module with enums for return results.
   static lua::NResultsOr Module(lua_State* L);
 
@@ -44,6 +55,13 @@ class Properties {
   // Calls readProperty on Lua API. Returns whether read was successful.
   EnvCApi_PropertyResult ReadProperty(const char* key, const char** value);
 
+  // Reads the properties 'keys' as numbers or tensors into 'values', one per
+  // key, reusing their storage. Calls readProperties on the Lua API once with
+  // the array of keys if it exists, otherwise calls readProperty per key.
+  // Numbers, tensors and strings holding a number are accepted as values.
+  void ReadValues(absl::Span<const std::string> keys,
+                  std::vector<Value>* values);
+
   // Calls listProperty on Lua API. Returns whether list was successful.
   EnvCApi_PropertyResult ListProperty(
       void* userdata, const char* list_key,
@@ -55,6 +73,10 @@ class Properties {
 
   // Last property string storage.
   std::string property_storage_;
+
+  // Keys of the last call to ReadValues and the Lua array holding them.
+  std::vector<std::string> value_keys_;
+  lua::TableRef value_keys_table_;
 };
 
 }  // namespace deepmind::lab2d
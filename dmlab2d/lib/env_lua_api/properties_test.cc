@@ -15,6 +15,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "dmlab2d/lib/env_lua_api/properties.h"
 
+#include <string>
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "dmlab2d/lib/lua/bind.h"
 #include "dmlab2d/lib/lua/call.h"
@@ -23,6 +26,9 @@
 #include "dmlab2d/lib/lua/push_script.h"
 #include "dmlab2d/lib/lua/table_ref.h"
 #include "dmlab2d/lib/lua/vm_test_util.h"
+#include "dmlab2d/lib/system/tensor/lua/tensor.h"
+#include "dmlab2d/lib/util/default_read_only_file_system.h"
+#include "dmlab2d/lib/util/file_reader_types.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "third_party/rl_api/env_c_api.h"
@@ -31,7 +37,10 @@ namespace deepmind::lab2d {
 namespace {
 
 using ::deepmind::lab2d::lua::testing::IsOkAndHolds;
+using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
 using ::testing::StrEq;
 
 class PropertiesTest : public lua::testing::TestWithVm {
@@ -245,5 +254,90 @@ TEST_F(PropertiesTest, TestList) {
               Eq(EnvCApi_PropertyResult_NotFound));
 }
 
+TEST_F(PropertiesTest, TestReadValuesFromReadProperty) {
+  ASSERT_THAT(lua::PushScript(L, kPropertyApi, "kPropertyApi"),
+              IsOkAndHolds(1));
+  ASSERT_THAT(lua::Call(L, 0), IsOkAndHolds(1));
+  lua::TableRef table;
+  ASSERT_TRUE(IsFound(Read(L, 1, &table)));
+  lua_settop(L, 0);
+  Properties properties;
+  ASSERT_THAT(properties.BindApi(table), IsOkAndHolds(0));
+
+  const std::string keys[] = {"readWriteNumber", "readOnlyString",
+                              "writeString", "notExist"};
+  std::vector<Properties::Value> values;
+  properties.ReadValues(keys, &values);
+  ASSERT_THAT(values, SizeIs(4));
+  EXPECT_THAT(values[0].result, Eq(EnvCApi_PropertyResult_Success));
+  EXPECT_THAT(values[0].shape, IsEmpty());
+  EXPECT_THAT(values[0].values, ElementsAre(10));
+  EXPECT_THAT(values[1].result, Eq(EnvCApi_PropertyResult_InvalidArgument));
+  EXPECT_THAT(values[2].result, Eq(EnvCApi_PropertyResult_PermissionDenied));
+  EXPECT_THAT(values[3].result, Eq(EnvCApi_PropertyResult_NotFound));
+  EXPECT_THAT(lua_gettop(L), Eq(0));
+}
+
+constexpr char kBulkPropertyApi[] = R"(
+local tensor = require 'system.tensor'
+
+local api = {_calls = 0}
+
+function api:readProperties(keys)
+  self._calls = self._calls + 1
+  local values = {}
+  for i, key in ipairs(keys) do
+    if key == 'number' then
+      values[i] = 2.5
+    elseif key == 'string' then
+      values[i] = '7'
+    elseif key == 'tensor' then
+      values[i] = tensor.Int32Tensor{{1, 2, 3}, {4, 5, 6}}
+    elseif key == 'text' then
+      values[i] = 'text'
+    end
+  end
+  return values
+end
+
+return api
+)";
+
+TEST_F(PropertiesTest, TestReadValuesFromReadProperties) {
+  tensor::LuaTensorRegister(L);
+  void* default_fs = const_cast<DeepMindReadOnlyFileSystem*>(
+      util::DefaultReadOnlyFileSystem());
+  vm()->AddCModuleToSearchers("system.tensor", tensor::LuaTensorConstructors,
+                              {default_fs});
+  ASSERT_THAT(lua::PushScript(L, kBulkPropertyApi, "kBulkPropertyApi"),
+              IsOkAndHolds(1));
+  ASSERT_THAT(lua::Call(L, 0), IsOkAndHolds(1));
+  lua::TableRef table;
+  ASSERT_TRUE(IsFound(Read(L, 1, &table)));
+  lua_settop(L, 0);
+  Properties properties;
+  ASSERT_THAT(properties.BindApi(table), IsOkAndHolds(0));
+
+  const std::string keys[] = {"number", "string", "tensor", "text", "missing"};
+  std::vector<Properties::Value> values;
+  for (int i = 0; i < 2; ++i) {
+    properties.ReadValues(keys, &values);
+    ASSERT_THAT(values, SizeIs(5));
+    EXPECT_THAT(values[0].result, Eq(EnvCApi_PropertyResult_Success));
+    EXPECT_THAT(values[0].values, ElementsAre(2.5));
+    EXPECT_THAT(values[1].result, Eq(EnvCApi_PropertyResult_Success));
+    EXPECT_THAT(values[1].values, ElementsAre(7));
+    EXPECT_THAT(values[2].result, Eq(EnvCApi_PropertyResult_Success));
+    EXPECT_THAT(values[2].shape, ElementsAre(2, 3));
+    EXPECT_THAT(values[2].values, ElementsAre(1, 2, 3, 4, 5, 6));
+    EXPECT_THAT(values[3].result, Eq(EnvCApi_PropertyResult_InvalidArgument));
+    EXPECT_THAT(values[4].result, Eq(EnvCApi_PropertyResult_NotFound));
+  }
+  int calls = 0;
+  EXPECT_TRUE(table.LookUp("_calls", &calls));
+  EXPECT_THAT(calls, Eq(2));
+  EXPECT_THAT(lua_gettop(L), Eq(0));
+}
+
 }  // namespace
 }  // namespace deepmind::lab2d
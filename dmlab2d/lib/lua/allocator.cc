@@ -0,0 +1,238 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/lua/allocator.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+namespace deepmind::lab2d::lua {
+namespace {
+
+constexpr std::array<std::size_t, 16> kClassSizes = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512};
+
+// Maps (size + 15) / 16 to the smallest size class that fits.
+constexpr std::array<signed char, 33> MakeClassLookup() {
+  std::array<signed char, 33> lookup = {};
+  int size_class = 0;
+  for (std::size_t i = 0; i < lookup.size(); ++i) {
+    while (kClassSizes[size_class] < i * 16) {
+      ++size_class;
+    }
+    lookup[i] = size_class;
+  }
+  return lookup;
+}
+
+constexpr std::array<signed char, 33> kClassLookup = MakeClassLookup();
+
+}  // namespace
+
+Allocator::Allocator(std::size_t reserved_size)
+    : reserved_size_(reserved_size) {}
+
+Allocator::~Allocator() {
+  if (arena_ != nullptr) {
+    munmap(arena_, arena_size_);
+  }
+}
+
+int Allocator::SizeClassOf(std::size_t size) {
+  return kClassLookup[(size + kGranularity - 1) / kGranularity];
+}
+
+std::size_t Allocator::SizeOfClass(int size_class) {
+  return kClassSizes[size_class];
+}
+
+void* Allocator::Alloc(void* ud, void* ptr, std::size_t osize,
+                       std::size_t nsize) {
+  auto* allocator = static_cast<Allocator*>(ud);
+  Stats& stats = allocator->stats_;
+  // `osize` is only a size when `ptr` is not null.
+  const std::size_t old_size = ptr != nullptr ? osize : 0;
+  if (nsize == 0) {
+    if (ptr != nullptr) {
+      allocator->Free(ptr);
+      stats.bytes_in_use -= old_size;
+    }
+    return nullptr;
+  }
+  void* result = ptr != nullptr ? allocator->Reallocate(ptr, old_size, nsize)
+                                : allocator->Allocate(nsize);
+  if (result == nullptr) {
+    return nullptr;
+  }
+  if (nsize > old_size) {
+    stats.bytes_allocated += nsize - old_size;
+  }
+  stats.bytes_in_use += nsize;
+  stats.bytes_in_use -= old_size;
+  ++stats.num_allocations;
+  return result;
+}
+
+void Allocator::EnablePooling(bool enable) {
+  if (enable && arena_ == nullptr) {
+    const std::size_t num_slabs = reserved_size_ / kSlabSize;
+    if (num_slabs == 0) {
+      return;
+    }
+    // Pages are only backed by memory once touched.
+    void* arena = mmap(nullptr, num_slabs * kSlabSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (arena == MAP_FAILED) {
+      return;
+    }
+    arena_ = static_cast<char*>(arena);
+    arena_size_ = num_slabs * kSlabSize;
+    slabs_.resize(num_slabs);
+  }
+  pooling_enabled_ = enable;
+}
+
+void* Allocator::Allocate(std::size_t size) {
+  if (pooling_enabled_ && size <= kMaxPooledSize) {
+    if (void* result = AllocatePooled(SizeClassOf(size))) {
+      return result;
+    }
+  }
+  return std::malloc(size);
+}
+
+void Allocator::Free(void* ptr) {
+  if (IsPooled(ptr)) {
+    FreePooled(ptr);
+  } else {
+    std::free(ptr);
+  }
+}
+
+void* Allocator::Reallocate(void* ptr, std::size_t old_size,
+                            std::size_t new_size) {
+  const bool pooled = IsPooled(ptr);
+  if (pooled && new_size <= kMaxPooledSize &&
+      SizeClassOf(new_size) == slabs_[SlabIndex(ptr)].size_class) {
+    return ptr;
+  }
+  if (!pooled && !(pooling_enabled_ && new_size <= kMaxPooledSize)) {
+    return std::realloc(ptr, new_size);
+  }
+  void* result = Allocate(new_size);
+  if (result == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(result, ptr, std::min(old_size, new_size));
+  Free(ptr);
+  return result;
+}
+
+void* Allocator::AllocatePooled(int size_class) {
+  SizeClassPool& pool = pools_[size_class];
+  const std::size_t size = SizeOfClass(size_class);
+  void* result;
+  if (pool.free_list != nullptr) {
+    result = pool.free_list;
+    pool.free_list = pool.free_list->next;
+  } else {
+    if (pool.carve_end - pool.carve_begin < static_cast<std::ptrdiff_t>(size)) {
+      int slab = TakeSlab(size_class);
+      if (slab < 0) {
+        return nullptr;
+      }
+      pool.carve_begin = arena_ + slab * kSlabSize;
+      pool.carve_end = pool.carve_begin + kSlabSize;
+    }
+    result = pool.carve_begin;
+    pool.carve_begin += size;
+  }
+  ++slabs_[SlabIndex(result)].num_used;
+  stats_.bytes_pooled += size;
+  return result;
+}
+
+void Allocator::FreePooled(void* ptr) {
+  Slab& slab = slabs_[SlabIndex(ptr)];
+  --slab.num_used;
+  stats_.bytes_pooled -= SizeOfClass(slab.size_class);
+  SizeClassPool& pool = pools_[slab.size_class];
+  auto* block = static_cast<FreeBlock*>(ptr);
+  block->next = pool.free_list;
+  pool.free_list = block;
+}
+
+int Allocator::TakeSlab(int size_class) {
+  int slab;
+  if (!released_slabs_.empty()) {
+    slab = released_slabs_.back();
+    released_slabs_.pop_back();
+  } else if (num_touched_slabs_ < slabs_.size()) {
+    slab = num_touched_slabs_++;
+  } else {
+    return -1;
+  }
+  slabs_[slab].size_class = size_class;
+  ++stats_.num_slabs;
+  return slab;
+}
+
+std::size_t Allocator::Compact() {
+  auto is_empty = [this](std::size_t slab) {
+    return slabs_[slab].size_class >= 0 && slabs_[slab].num_used == 0;
+  };
+  std::size_t num_released = 0;
+  for (std::size_t slab = 0; slab < num_touched_slabs_; ++slab) {
+    num_released += is_empty(slab);
+  }
+  if (num_released == 0) {
+    return 0;
+  }
+
+  // Drop the free blocks and uncarved space of the empty slabs.
+  for (SizeClassPool& pool : pools_) {
+    FreeBlock** link = &pool.free_list;
+    while (*link != nullptr) {
+      if (is_empty(SlabIndex(*link))) {
+        *link = (*link)->next;
+      } else {
+        link = &(*link)->next;
+      }
+    }
+    if (pool.carve_begin != nullptr &&
+        is_empty(SlabIndex(pool.carve_end - 1))) {
+      pool.carve_begin = nullptr;
+      pool.carve_end = nullptr;
+    }
+  }
+
+  for (std::size_t slab = 0; slab < num_touched_slabs_; ++slab) {
+    if (is_empty(slab)) {
+      madvise(arena_ + slab * kSlabSize, kSlabSize, MADV_DONTNEED);
+      slabs_[slab].size_class = -1;
+      released_slabs_.push_back(slab);
+      --stats_.num_slabs;
+    }
+  }
+  return num_released * kSlabSize;
+}
+
+}  // namespace deepmind::lab2d::lua
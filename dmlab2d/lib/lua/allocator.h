@@ -0,0 +1,145 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DMLAB2D_LIB_LUA_ALLOCATOR_H_
+#define DMLAB2D_LIB_LUA_ALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace deepmind::lab2d::lua {
+
+// Allocator for a single Lua VM, used through the lua_Alloc function Alloc.
+// It counts allocations and optionally serves small blocks from size-class
+// pools.
+//
+// Pooled blocks are carved from fixed-size slabs in an address range that is
+// reserved the first time pooling is enabled. Each size class keeps its own
+// free list. A Lua state is only used by one thread at a time, so the free
+// lists belong to the allocator and need no locking; VMs never contend with
+// each other or with malloc. Blocks larger than kMaxPooledSize, and all
+// blocks while pooling is disabled or the range is exhausted, come from
+// malloc. Blocks can be freed whatever the pooling state was when they were
+// allocated.
+//
+// Not thread-safe.
+class Allocator {
+ public:
+  struct Stats {
+    // Total bytes requested, including growth of existing blocks. Never
+    // decreases.
+    std::uint64_t bytes_allocated = 0;
+    // Bytes currently held by the VM.
+    std::size_t bytes_in_use = 0;
+    // Number of allocations and reallocations.
+    std::uint64_t num_allocations = 0;
+    // Number of slabs holding pooled blocks or free blocks of a pool.
+    std::size_t num_slabs = 0;
+    // Bytes of pooled blocks currently held by the VM, rounded up to their
+    // size class.
+    std::size_t bytes_pooled = 0;
+  };
+
+  static constexpr std::size_t kMaxPooledSize = 512;
+  static constexpr std::size_t kSlabSize = std::size_t{64} << 10;
+
+  // `reserved_size` is the size of the address range reserved for slabs when
+  // pooling is first enabled. Only slabs that are used take up memory.
+  explicit Allocator(std::size_t reserved_size = std::size_t{1} << 30);
+  ~Allocator();
+
+  Allocator(const Allocator&) = delete;
+  Allocator& operator=(const Allocator&) = delete;
+
+  // lua_Alloc function; `ud` must point to an Allocator.
+  static void* Alloc(void* ud, void* ptr, std::size_t osize,
+                     std::size_t nsize);
+
+  // Whether new small blocks are served from the pools. Off by default.
+  void EnablePooling(bool enable);
+  bool pooling_enabled() const { return pooling_enabled_; }
+
+  // Returns slabs with no blocks in use to the system. Best called after a
+  // full garbage collection, such as between episodes. Returns the number of
+  // bytes released.
+  std::size_t Compact();
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  static constexpr std::size_t kGranularity = 16;
+  static constexpr std::size_t kNumSizeClasses = 16;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct SizeClassPool {
+    FreeBlock* free_list = nullptr;
+    // Uncarved part of the slab most recently taken by this pool.
+    char* carve_begin = nullptr;
+    char* carve_end = nullptr;
+  };
+
+  struct Slab {
+    // Index of the size class, or -1 if the slab is unused.
+    int size_class = -1;
+    // Blocks handed out and not yet freed.
+    std::uint32_t num_used = 0;
+  };
+
+  void* Allocate(std::size_t size);
+  void Free(void* ptr);
+  void* Reallocate(void* ptr, std::size_t old_size, std::size_t new_size);
+
+  // Returns a block of size class `size_class` or null if the reserved range
+  // is exhausted.
+  void* AllocatePooled(int size_class);
+  void FreePooled(void* ptr);
+
+  // Returns the index of a slab ready to be carved, or -1.
+  int TakeSlab(int size_class);
+
+  bool IsPooled(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    return p >= arena_ && p < arena_ + arena_size_;
+  }
+
+  std::size_t SlabIndex(const void* ptr) const {
+    return (static_cast<const char*>(ptr) - arena_) / kSlabSize;
+  }
+
+  static int SizeClassOf(std::size_t size);
+  static std::size_t SizeOfClass(int size_class);
+
+  const std::size_t reserved_size_;
+  bool pooling_enabled_ = false;
+  char* arena_ = nullptr;
+  std::size_t arena_size_ = 0;
+  // Slabs [0, num_touched_slabs_) have been handed out at least once.
+  std::size_t num_touched_slabs_ = 0;
+  std::vector<Slab> slabs_;
+  // Slabs released by Compact, available to any size class.
+  std::vector<int> released_slabs_;
+  std::array<SizeClassPool, kNumSizeClasses> pools_;
+  Stats stats_;
+};
+
+}  // namespace deepmind::lab2d::lua
+
+#endif  // DMLAB2D_LIB_LUA_ALLOCATOR_H_
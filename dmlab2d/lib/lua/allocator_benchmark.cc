@@ -0,0 +1,78 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Measures a Lua workload dominated by short-lived small tables, as created by
+// per-step level code, with the pooled, the system and the Lua implementation's
+// allocator.
+
+#include <cstring>
+
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/lua/lua.h"
+#include "dmlab2d/lib/lua/vm.h"
+
+namespace deepmind::lab2d::lua {
+namespace {
+
+constexpr char kChurn[] = R"(
+local positions = {}
+for i = 1, 1000 do
+  positions[i] = {i % 17, i % 13}
+end
+local names = {}
+for i = 1, 100 do
+  names[#names + 1] = {name = 'piece' .. (i % 10), position = positions[i]}
+end
+return #names
+)";
+
+void RunTableChurn(benchmark::State& state, Vm* vm) {
+  lua_State* L = vm->get();
+  if (luaL_loadbuffer(L, kChurn, std::strlen(kChurn), "churn") != 0) {
+    state.SkipWithError(lua_tostring(L, -1));
+    return;
+  }
+  for (auto _ : state) {
+    lua_pushvalue(L, -1);
+    lua_call(L, 0, 1);
+    lua_pop(L, 1);
+  }
+}
+
+void BM_TableChurn(benchmark::State& state) {
+  Vm vm = CreateVm();
+  vm.UseCountingAllocator();
+  if (vm.allocator() == nullptr) {
+    state.SkipWithError("Lua implementation does not use custom allocators.");
+    return;
+  }
+  vm.allocator()->EnablePooling(state.range(0) != 0);
+  RunTableChurn(state, &vm);
+  state.counters["slabs"] = vm.allocator()->stats().num_slabs;
+}
+
+BENCHMARK(BM_TableChurn)->ArgName("pooled")->Arg(0)->Arg(1);
+
+// As BM_TableChurn with the allocator of the Lua implementation.
+void BM_TableChurnDefaultAllocator(benchmark::State& state) {
+  Vm vm = CreateVm();
+  RunTableChurn(state, &vm);
+}
+
+BENCHMARK(BM_TableChurnDefaultAllocator);
+
+}  // namespace
+}  // namespace deepmind::lab2d::lua
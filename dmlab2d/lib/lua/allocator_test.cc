@@ -0,0 +1,158 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/lua/allocator.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::lua {
+namespace {
+
+void* Allocate(Allocator* allocator, std::size_t size) {
+  return Allocator::Alloc(allocator, nullptr, 0, size);
+}
+
+void Free(Allocator* allocator, void* ptr, std::size_t size) {
+  Allocator::Alloc(allocator, ptr, size, 0);
+}
+
+TEST(AllocatorTest, CountsAllocations) {
+  Allocator allocator;
+  void* block = Allocate(&allocator, 100);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(allocator.stats().bytes_allocated, 100);
+  EXPECT_EQ(allocator.stats().bytes_in_use, 100);
+  EXPECT_EQ(allocator.stats().num_allocations, 1);
+  EXPECT_EQ(allocator.stats().bytes_pooled, 0);
+
+  block = Allocator::Alloc(&allocator, block, 100, 300);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(allocator.stats().bytes_allocated, 300);
+  EXPECT_EQ(allocator.stats().bytes_in_use, 300);
+  EXPECT_EQ(allocator.stats().num_allocations, 2);
+
+  Free(&allocator, block, 300);
+  EXPECT_EQ(allocator.stats().bytes_allocated, 300);
+  EXPECT_EQ(allocator.stats().bytes_in_use, 0);
+}
+
+TEST(AllocatorTest, PoolsSmallBlocks) {
+  Allocator allocator;
+  allocator.EnablePooling(true);
+  ASSERT_TRUE(allocator.pooling_enabled());
+
+  void* small = Allocate(&allocator, 24);
+  void* large = Allocate(&allocator, Allocator::kMaxPooledSize + 1);
+  EXPECT_EQ(allocator.stats().bytes_pooled, 32);
+  EXPECT_EQ(allocator.stats().num_slabs, 1);
+
+  Free(&allocator, small, 24);
+  EXPECT_EQ(allocator.stats().bytes_pooled, 0);
+  // A freed block is reused by the next allocation of its size class.
+  EXPECT_EQ(Allocate(&allocator, 32), small);
+  Free(&allocator, small, 32);
+  Free(&allocator, large, Allocator::kMaxPooledSize + 1);
+  EXPECT_EQ(allocator.stats().bytes_in_use, 0);
+}
+
+TEST(AllocatorTest, ReallocatePreservesContents) {
+  Allocator allocator;
+  allocator.EnablePooling(true);
+  char* block = static_cast<char*>(Allocate(&allocator, 16));
+  std::memcpy(block, "0123456789abcde", 16);
+
+  // Growth within the pool, out of the pool and back again.
+  for (std::size_t new_size : {20, 200, 2000, 40}) {
+    std::size_t old_size = allocator.stats().bytes_in_use;
+    block =
+        static_cast<char*>(Allocator::Alloc(&allocator, block, old_size,
+                                            new_size));
+    ASSERT_NE(block, nullptr);
+    EXPECT_STREQ(block, "0123456789abcde");
+    EXPECT_EQ(allocator.stats().bytes_in_use, new_size);
+  }
+  Free(&allocator, block, 40);
+}
+
+TEST(AllocatorTest, FreesAfterPoolingDisabled) {
+  Allocator allocator;
+  allocator.EnablePooling(true);
+  void* pooled = Allocate(&allocator, 64);
+  allocator.EnablePooling(false);
+  void* unpooled = Allocate(&allocator, 64);
+  EXPECT_EQ(allocator.stats().bytes_pooled, 64);
+  Free(&allocator, pooled, 64);
+  Free(&allocator, unpooled, 64);
+  EXPECT_EQ(allocator.stats().bytes_pooled, 0);
+  EXPECT_EQ(allocator.stats().bytes_in_use, 0);
+}
+
+TEST(AllocatorTest, CompactReleasesEmptySlabs) {
+  Allocator allocator;
+  allocator.EnablePooling(true);
+  constexpr std::size_t kBlockSize = 64;
+  constexpr std::size_t kNumBlocks = 3 * Allocator::kSlabSize / kBlockSize;
+  std::vector<void*> blocks;
+  for (std::size_t i = 0; i < kNumBlocks; ++i) {
+    blocks.push_back(Allocate(&allocator, kBlockSize));
+  }
+  void* kept = Allocate(&allocator, 128);
+  EXPECT_EQ(allocator.stats().num_slabs, 4);
+  EXPECT_EQ(allocator.Compact(), 0);
+
+  for (void* block : blocks) {
+    Free(&allocator, block, kBlockSize);
+  }
+  EXPECT_EQ(allocator.Compact(), 3 * Allocator::kSlabSize);
+  EXPECT_EQ(allocator.stats().num_slabs, 1);
+
+  // Released slabs are reused by any size class.
+  std::vector<void*> more_blocks;
+  for (std::size_t i = 0; i < Allocator::kSlabSize / 256; ++i) {
+    more_blocks.push_back(Allocate(&allocator, 256));
+  }
+  EXPECT_EQ(allocator.stats().num_slabs, 2);
+  for (void* block : more_blocks) {
+    std::memset(block, 0, 256);
+    Free(&allocator, block, 256);
+  }
+  Free(&allocator, kept, 128);
+  EXPECT_EQ(allocator.Compact(), 2 * Allocator::kSlabSize);
+  EXPECT_EQ(allocator.stats().num_slabs, 0);
+}
+
+TEST(AllocatorTest, FallsBackWhenReservationExhausted) {
+  Allocator allocator(Allocator::kSlabSize);
+  allocator.EnablePooling(true);
+  constexpr std::size_t kNumBlocks = Allocator::kSlabSize / 512 + 10;
+  std::vector<void*> blocks;
+  for (std::size_t i = 0; i < kNumBlocks; ++i) {
+    blocks.push_back(Allocate(&allocator, 512));
+    ASSERT_NE(blocks.back(), nullptr);
+  }
+  EXPECT_EQ(allocator.stats().bytes_pooled, Allocator::kSlabSize);
+  for (void* block : blocks) {
+    Free(&allocator, block, 512);
+  }
+  EXPECT_EQ(allocator.stats().bytes_in_use, 0);
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::lua
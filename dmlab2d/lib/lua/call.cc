@@ -24,6 +24,7 @@
 #include "dmlab2d/lib/lua/read.h"
 
 namespace deepmind::lab2d::lua {
+namespace {
 
 extern "C" {
 static int traceback(lua_State* L) {
@@ -45,12 +46,31 @@ static int traceback(lua_State* L) {
 }
 }  // extern "C"
 
+// The address of this variable is the registry key of the traceback closure.
+char traceback_key;
+
+// Pushes the traceback message handler. Creating a C closure allocates, so it
+// is created once per Lua state and kept in the registry.
+void PushTraceback(lua_State* L) {
+  lua_pushlightuserdata(L, &traceback_key);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+  if (lua_isnil(L, -1)) {
+    lua_pop(L, 1);
+    Push(L, traceback);
+    lua_pushlightuserdata(L, &traceback_key);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+  }
+}
+
+}  // namespace
+
 NResultsOr Call(lua_State* L, int nargs, bool with_traceback) {
   CHECK_GE(nargs, 0) << "Invalid number of arguments: " << nargs;
   int err_stackpos = 0;
   if (with_traceback) {
     err_stackpos = lua_gettop(L) - nargs;
-    Push(L, traceback);
+    PushTraceback(L);
     lua_insert(L, err_stackpos);
   }
   if (lua_pcall(L, nargs, LUA_MULTRET, err_stackpos) != 0) {
@@ -78,6 +78,21 @@ TEST_F(CallTest, FunctionErrors) {
   EXPECT_EQ(lua_gettop(L), top);
 }
 
+TEST_F(CallTest, FunctionErrorsRepeatedly) {
+  int top = lua_gettop(L);
+
+  for (int i = 0; i < 3; ++i) {
+    NResultsOr n_or = PushScript(L, kTestAssert, "kTestAssert");
+    ASSERT_THAT(n_or, IsOkAndHolds(lua_gettop(L) - top));
+
+    Push(L, false);
+
+    EXPECT_THAT(Call(L, 1), StatusIs(AllOf(HasSubstr("Random Error Message!"),
+                                           HasSubstr("TestFunction"))));
+    EXPECT_EQ(lua_gettop(L), top);
+  }
+}
+
 TEST_F(CallTest, FunctionErrorsNoStack) {
   int top = lua_gettop(L);
 
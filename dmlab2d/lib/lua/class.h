@@ -46,8 +46,8 @@ namespace deepmind::lab2d::lua {
 // function Member<&X::f> should be passed to the static Register function for
 // registration with the Lua VM. When called from Lua, the bound function first
 // attempts to load the class instance from the Lua stack, checking its
-// metatable name, and then invokes the corresponding member function on it (but
-// see below for ways to customize this behaviour).
+// metatable, and then invokes the corresponding member function on it (but see
+// below for ways to customize this behaviour).
 //
 // Example:
 //
@@ -94,11 +94,21 @@ class Class {
   static inline void Register(lua_State* L, const Regs& members);
 
   // Reads non-null T* from the Lua stack if the stack contains userdata at the
-  // given position, the name of the userdata's metadata is T::ClassName() and
-  // the intstance reports itself as valid. Otherwise returns nullptr.
+  // given position, the userdata's metatable is the one registered for
+  // T::ClassName() and the intstance reports itself as valid. Otherwise returns
+  // nullptr.
   static T* ReadObject(lua_State* L, int idx) {
-    if (T* t = lua::ReadUDT<T>(L, idx, T::ClassName());
-        t != nullptr && t->IsValidObject()) {
+    if (lua_type(L, idx) != LUA_TUSERDATA) {
+      return nullptr;
+    }
+    T* t = static_cast<T*>(lua_touserdata(L, idx));
+    if (!lua_getmetatable(L, idx)) {
+      return nullptr;
+    }
+    PushMetatable(L);
+    bool is_t = lua_rawequal(L, -1, -2);
+    lua_pop(L, 2);
+    if (is_t && t->IsValidObject()) {
       return t;
     } else {
       return nullptr;
@@ -129,6 +139,31 @@ class Class {
   // in a domain-specific sense.
   static constexpr bool IsValidObject() { return true; }
 
+  // The address of this variable is a registry key unique to T. The registry
+  // maps it to T's metatable, so that the metatable can be found without
+  // hashing T::ClassName().
+  static inline char metatable_key_;
+
+  // Pushes T's metatable, or nil if T has not been registered.
+  static void PushMetatable(lua_State* L) {
+    lua_pushlightuserdata(L, &metatable_key_);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+  }
+
+  // Returns the object at stack index 1 if its metatable is the one in
+  // up-value 2 of the running method, and otherwise raises a Lua error.
+  static T* CheckSelf(lua_State* L) {
+    if (lua_type(L, 1) == LUA_TUSERDATA && lua_getmetatable(L, 1)) {
+      bool is_t = lua_rawequal(L, -1, lua_upvalueindex(2));
+      lua_pop(L, 1);
+      if (is_t) {
+        return static_cast<T*>(lua_touserdata(L, 1));
+      }
+    }
+    // Not a T. This produces the usual error message.
+    return static_cast<T*>(luaL_checkudata(L, 1, T::ClassName()));
+  }
+
   // Destroys this class by calling the destructor, invoked from the Lua "__gc"
   // method.
   static int Destroy(lua_State* L) {
@@ -144,7 +179,7 @@ template <typename T>
 template <typename... Args>
 T* Class<T>::CreateObject(lua_State* L, Args&&... args) {
   void* lua_node_memory = lua_newuserdata(L, sizeof(T));
-  luaL_getmetatable(L, T::ClassName());
+  PushMetatable(L);
   CHECK(!lua_isnil(L, -1)) << T::ClassName() << " has not been registered.";
   lua_setmetatable(L, -2);
   return ::new (lua_node_memory) T(std::forward<Args>(args)...);
@@ -154,6 +189,9 @@ template <typename T>
 template <typename Regs>
 void Class<T>::Register(lua_State* L, const Regs& members) {
   luaL_newmetatable(L, T::ClassName());
+  lua_pushlightuserdata(L, &metatable_key_);
+  lua_pushvalue(L, -2);
+  lua_rawset(L, LUA_REGISTRYINDEX);
 
   // Push __index function pointing at self.
   lua_pushvalue(L, -1);
@@ -164,9 +202,11 @@ void Class<T>::Register(lua_State* L, const Regs& members) {
 
   for (const auto& member : members) {
     Push(L, member.first);
-    // Place method name in up-value to aid diagnostics.
+    // Place method name in up-value to aid diagnostics and the metatable in
+    // another for checking the type of self.
     lua_pushvalue(L, -1);
-    lua_pushcclosure(L, member.second, 1);
+    lua_pushvalue(L, -3);
+    lua_pushcclosure(L, member.second, 2);
     lua_settable(L, -3);
   }
 
@@ -180,7 +220,7 @@ int Class<T>::Member(lua_State* L) {
   // May perform longjmp, which is not allowed in C++ except in specific
   // situations. We take care that no objects with non-trivial destructors exist
   // if lua_error is called.
-  T* t = static_cast<T*>(luaL_checkudata(L, 1, T::ClassName()));
+  T* t = CheckSelf(L);
   {
     if (t->IsValidObject()) {
       auto result_or = (*t.*Function)(L);
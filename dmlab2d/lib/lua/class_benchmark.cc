@@ -0,0 +1,185 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Measures the overhead of calling methods of lua::Class objects from Lua. The
+// "ByName" benchmarks check the type of the object by looking up its metatable
+// by name in the registry, which is how lua::Class used to do it.
+
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/lua/bind.h"
+#include "dmlab2d/lib/lua/call.h"
+#include "dmlab2d/lib/lua/class.h"
+#include "dmlab2d/lib/lua/lua.h"
+#include "dmlab2d/lib/lua/n_results_or.h"
+#include "dmlab2d/lib/lua/push.h"
+#include "dmlab2d/lib/lua/push_script.h"
+#include "dmlab2d/lib/lua/read.h"
+#include "dmlab2d/lib/lua/table_ref.h"
+#include "dmlab2d/lib/lua/vm.h"
+
+namespace deepmind::lab2d::lua {
+namespace {
+
+constexpr int kCallsPerIteration = 1000;
+
+class Counter final : public Class<Counter> {
+ public:
+  static const char* ClassName() { return "benchmark.Counter"; }
+
+  static int Create(lua_State* L) {
+    CreateObject(L);
+    return 1;
+  }
+
+  NResultsOr Increment(lua_State* L) {
+    ++count_;
+    return 0;
+  }
+
+  // Member as it was before metatables were cached.
+  template <NResultsOr (Counter::*Function)(lua_State*)>
+  static int MemberByName(lua_State* L) {
+    auto* t = static_cast<Counter*>(luaL_checkudata(L, 1, ClassName()));
+    if (auto result_or = (*t.*Function)(L); result_or.ok()) {
+      return result_or.n_results();
+    } else {
+      Push(L, absl::StrCat("[", ClassName(), ".",
+                           ToString(L, lua_upvalueindex(1)), "] - ",
+                           result_or.error()));
+    }
+    return lua_error(L);
+  }
+
+  static NResultsOr IncrementArg(lua_State* L) {
+    Counter* counter = ReadObject(L, 1);
+    if (counter == nullptr) return "Counter expected";
+    ++counter->count_;
+    return 0;
+  }
+
+  static NResultsOr IncrementArgByName(lua_State* L) {
+    auto* counter = ReadUDT<Counter>(L, 1, ClassName());
+    if (counter == nullptr) return "Counter expected";
+    ++counter->count_;
+    return 0;
+  }
+
+  static void Register(lua_State* L) {
+    const Class::Reg methods[] = {
+        {"increment", Member<&Counter::Increment>},  //
+        {"incrementByName", MemberByName<&Counter::Increment>},  //
+    };
+    Class::Register(L, methods);
+  }
+
+ private:
+  int count_ = 0;
+};
+
+int RequireCounter(lua_State* L) {
+  TableRef module = TableRef::Create(L);
+  Counter::Register(L);
+  module.Insert("Counter", &Counter::Create);
+  module.Insert("incrementArg", &Bind<Counter::IncrementArg>);
+  module.Insert("incrementArgByName", &Bind<Counter::IncrementArgByName>);
+  Push(L, module);
+  return 1;
+}
+
+constexpr absl::string_view kSetup = R"(
+local counter = require 'counter'
+return counter.Counter(), counter
+)";
+
+// `script` is called with a Counter object and the counter module each
+// iteration and must call one function kCallsPerIteration times.
+void CallScript(benchmark::State& state, absl::string_view script) {
+  auto lua_vm = CreateVm();
+  lua_State* L = lua_vm.get();
+  lua_vm.AddCModuleToSearchers("counter", &RequireCounter);
+  if (auto result = PushScript(L, kSetup, "setup"); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  if (auto result = Call(L, 0); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  if (auto result = PushScript(L, script, "script"); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  // Lua stack: counter, module, function
+  for (auto _ : state) {
+    lua_pushvalue(L, -1);
+    lua_pushvalue(L, -4);
+    lua_pushvalue(L, -4);
+    if (auto result = Call(L, 2); !result.ok()) {
+      LOG(FATAL) << result.error();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kCallsPerIteration);
+  lua_pop(L, 3);
+}
+
+void BM_MethodCall(benchmark::State& state) {
+  CallScript(state, R"(
+    local counter = ...
+    for i = 1, 1000 do
+      counter:increment()
+    end
+  )");
+}
+
+BENCHMARK(BM_MethodCall);
+
+void BM_MethodCallByName(benchmark::State& state) {
+  CallScript(state, R"(
+    local counter = ...
+    for i = 1, 1000 do
+      counter:incrementByName()
+    end
+  )");
+}
+
+BENCHMARK(BM_MethodCallByName);
+
+void BM_ReadObject(benchmark::State& state) {
+  CallScript(state, R"(
+    local counter, module = ...
+    local incrementArg = module.incrementArg
+    for i = 1, 1000 do
+      incrementArg(counter)
+    end
+  )");
+}
+
+BENCHMARK(BM_ReadObject);
+
+void BM_ReadObjectByName(benchmark::State& state) {
+  CallScript(state, R"(
+    local counter, module = ...
+    local incrementArgByName = module.incrementArgByName
+    for i = 1, 1000 do
+      incrementArgByName(counter)
+    end
+  )");
+}
+
+BENCHMARK(BM_ReadObjectByName);
+
+}  // namespace
+}  // namespace deepmind::lab2d::lua
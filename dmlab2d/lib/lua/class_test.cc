@@ -166,6 +166,20 @@ TEST_F(ClassTest, TestRead) {
   EXPECT_EQ("Hello", foo->name());
 }
 
+TEST_F(ClassTest, ReadObjectChecksType) {
+  TableRef module = TableRef::Create(L);
+  Foo::Register(module, L);
+  Bar::Register(module, L);
+  Bar::CreateBar(L);
+  EXPECT_EQ(Foo::ReadObject(L, -1), nullptr);
+  EXPECT_NE(Bar::ReadObject(L, -1), nullptr);
+  lua_pushlightuserdata(L, &module);
+  EXPECT_EQ(Foo::ReadObject(L, -1), nullptr);
+  Push(L, "Hello");
+  EXPECT_EQ(Foo::ReadObject(L, -1), nullptr);
+  EXPECT_EQ(lua_gettop(L), 3);
+}
+
 constexpr char kScript2[] = R"(
 local test_module = require 'test_module'
 return {
@@ -228,5 +242,19 @@ TEST_F(ClassTest, CallErrorMessage) {
               StatusIs(AllOf(HasSubstr("system.Foo"), HasSubstr("userdata"))));
 }
 
+constexpr char kScriptSelfError[] = R"(
+local test_module = require 'test_module'
+local foo = test_module.Foo('Hello')
+return foo.name({})
+)";
+
+TEST_F(ClassTest, SelfErrorMessage) {
+  vm()->AddCModuleToSearchers("test_module", RequireFooBar);
+  ASSERT_THAT(PushScript(L, kScriptSelfError, "kScriptSelfError"),
+              IsOkAndHolds(1));
+  ASSERT_THAT(Call(L, 0),
+              StatusIs(AllOf(HasSubstr("system.Foo"), HasSubstr("table"))));
+}
+
 }  // namespace
 }  // namespace deepmind::lab2d::lua
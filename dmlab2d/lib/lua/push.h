@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -71,6 +72,9 @@ Push(lua_State* L, T value) {
 template <typename T, typename A>
 void Push(lua_State* L, const std::vector<T, A>& values);
 
+template <typename T, std::size_t N, typename A>
+void Push(lua_State* L, const absl::InlinedVector<T, N, A>& values);
+
 template <typename T, std::size_t N>
 void Push(lua_State* L, const std::array<T, N>& values);
 
@@ -89,9 +93,8 @@ template <typename T>
 void Push(lua_State* L, absl::Span<T> values) {
   lua_createtable(L, values.size(), 0);
   for (std::size_t i = 0; i < values.size(); ++i) {
-    Push(L, i + 1);
     Push(L, values[i]);
-    lua_settable(L, -3);
+    lua_rawseti(L, -2, i + 1);
   }
 }
 
@@ -100,6 +103,11 @@ void Push(lua_State* L, const std::vector<T, A>& values) {
   Push(L, absl::MakeConstSpan(values));
 }
 
+template <typename T, std::size_t N, typename A>
+void Push(lua_State* L, const absl::InlinedVector<T, N, A>& values) {
+  Push(L, absl::MakeConstSpan(values));
+}
+
 template <typename T, std::size_t N>
 void Push(lua_State* L, const std::array<T, N>& values) {
   Push(L, absl::MakeConstSpan(values));
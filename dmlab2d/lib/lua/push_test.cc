@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "dmlab2d/lib/lua/vm_test_util.h"
@@ -125,6 +126,21 @@ TEST_F(PushTest, PushVector) {
   }
 }
 
+TEST_F(PushTest, PushInlinedVector) {
+  absl::InlinedVector<int, 2> test = {1, 2, 3};
+  Push(L, test);
+  ASSERT_EQ(LUA_TTABLE, lua_type(L, 1));
+
+  std::size_t count = ArrayLength(L, 1);
+  ASSERT_EQ(test.size(), count);
+  for (std::size_t i = 0; i < count; ++i) {
+    lua_rawgeti(L, 1, i + 1);
+    ASSERT_EQ(LUA_TNUMBER, lua_type(L, -1));
+    EXPECT_EQ(test[i], lua_tointeger(L, -1));
+    lua_pop(L, 1);
+  }
+}
+
 TEST_F(PushTest, PushSpan) {
   const double data[] = {1.0, 2.0, 3.0, 4.0};
   Push(L, absl::MakeConstSpan(data));
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -272,6 +273,11 @@ ReadResult Read(lua_State* L, int idx, T** result) {
 template <typename T, typename A>
 ReadResult Read(lua_State* L, int idx, std::vector<T, A>* result);
 
+// Reads an array from the Lua stack into an absl::InlinedVector. Behaves the
+// same as the std::vector overload above.
+template <typename T, std::size_t N, typename A>
+ReadResult Read(lua_State* L, int idx, absl::InlinedVector<T, N, A>* result);
+
 // Reads a Lua array into 'values'. The failure conditions are the same as in
 // the previous function, but 'values' may be modified even if this function
 // fails.
@@ -334,9 +340,13 @@ ReadResult Read(lua_State* L, int idx, std::array<T, N>* values) {
   return Read(L, idx, absl::MakeSpan(*values));
 }
 
-template <typename T, typename A>
-ReadResult Read(lua_State* L, int idx, std::vector<T, A>* result) {
-  std::vector<T, A> local_result;
+namespace internal {
+
+// Shared implementation of the std::vector and absl::InlinedVector overloads.
+template <typename Container>
+ReadResult ReadSequence(lua_State* L, int idx, Container* result) {
+  using T = typename Container::value_type;
+  Container local_result;
   switch (lua_type(L, idx)) {
     case LUA_TTABLE:
       break;
@@ -364,6 +374,18 @@ ReadResult Read(lua_State* L, int idx, std::vector<T, A>* result) {
   return ReadFound();
 }
 
+}  // namespace internal
+
+template <typename T, typename A>
+ReadResult Read(lua_State* L, int idx, std::vector<T, A>* result) {
+  return internal::ReadSequence(L, idx, result);
+}
+
+template <typename T, std::size_t N, typename A>
+ReadResult Read(lua_State* L, int idx, absl::InlinedVector<T, N, A>* result) {
+  return internal::ReadSequence(L, idx, result);
+}
+
 template <typename K, typename T, typename H, typename C, typename A>
 ReadResult Read(lua_State* L, int idx,
                 absl::flat_hash_map<K, T, H, C, A>* result) {
@@ -20,6 +20,7 @@
 #include <cstring>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -32,6 +33,7 @@
 namespace deepmind::lab2d::lua {
 namespace {
 
+using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 
 constexpr char kTestString[] = "TestTest";
@@ -153,6 +155,18 @@ TEST_F(ReadTest, ReadVector) {
   EXPECT_TRUE(IsNotFound(Read(L, 4, &result)));
 }
 
+TEST_F(ReadTest, ReadInlinedVector) {
+  std::vector<int> test = {1, 2, 3, 4, 5};
+  Push(L, test);
+  Push(L, "Junk");
+  absl::InlinedVector<int, 2> result;
+  ASSERT_TRUE(IsFound(Read(L, 1, &result)));
+  EXPECT_THAT(result, ElementsAreArray(test));
+  EXPECT_TRUE(IsTypeMismatch(Read(L, 2, &result)));
+  EXPECT_THAT(result, ElementsAreArray(test));
+  EXPECT_TRUE(IsNotFound(Read(L, 3, &result)));
+}
+
 TEST_F(ReadTest, ReadArray) {
   std::array<double, 5> test{{1, 2, 3, 4, 5}};
   Push(L, "Junk");
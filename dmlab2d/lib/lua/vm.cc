@@ -16,6 +16,9 @@
 
 #include "dmlab2d/lib/lua/vm.h"
 
+#include <cstddef>
+#include <cstdio>
+#include <memory>
 #include <utility>
 
 #include "absl/strings/str_cat.h"
@@ -33,6 +36,12 @@ using deepmind::lab2d::lua::internal::EmbeddedClosure;
 using deepmind::lab2d::lua::internal::EmbeddedLuaFile;
 
 extern "C" {
+static int Panic(lua_State* L) {
+  std::fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n",
+               lua_tostring(L, -1));
+  return 0;
+}
+
 static int PackageLoader(lua_State* L) {
   do {
     int upidx_c = lua_upvalueindex(1);
@@ -89,6 +98,29 @@ static int PackageLoader(lua_State* L) {
 
 namespace deepmind::lab2d::lua {
 
+Vm Vm::Create() {
+  lua_State* L = luaL_newstate();
+  luaL_openlibs(L);
+  return Vm(L, nullptr);
+}
+
+void Vm::UseCountingAllocator() {
+  if (allocator_ != nullptr) {
+    return;
+  }
+  auto allocator = std::make_unique<Allocator>();
+  lua_State* L = lua_newstate(&Allocator::Alloc, allocator.get());
+  if (L == nullptr) {
+    // LuaJIT on 64-bit platforms without GC64 only runs on its own allocator.
+    return;
+  }
+  lua_atpanic(L, &Panic);
+  luaL_openlibs(L);
+  lua_state_.reset(L);
+  allocator_ = std::move(allocator);
+  InstallSearcher();
+}
+
 void Vm::AddPathToSearchers(absl::string_view path) {
   lua_State* L = get();
   lua_getglobal(L, "package");
@@ -102,6 +134,23 @@ void Vm::AddPathToSearchers(absl::string_view path) {
   lua_pop(L, 1);
 }
 
+void Vm::AddSearcher(lua_CFunction searcher, std::vector<void*> up_values) {
+  lua_State* L = get();
+  lua_getglobal(L, "package");
+  lua_getfield(L, -1, kSearcher);
+  int array_size = ArrayLength(L, -1);
+  for (int e = array_size + 1; e > 2; e--) {
+    lua_rawgeti(L, -1, e - 1);
+    lua_rawseti(L, -2, e);
+  }
+  for (void* up_value : up_values) {
+    lua_pushlightuserdata(L, up_value);
+  }
+  lua_pushcclosure(L, searcher, up_values.size());
+  lua_rawseti(L, -2, 2);
+  lua_pop(L, 2);
+}
+
 void Vm::AddCModuleToSearchers(std::string module_name, lua_CFunction F,
                                std::vector<void*> up_values) {
   (*embedded_c_modules_)[std::move(module_name)] = {F, std::move(up_values)};
@@ -154,12 +203,18 @@ debug._traceback = debug.traceback
 debug.traceback = traceback
 )lua";
 
-Vm::Vm(lua_State* L)
-    : lua_state_(L),
+Vm::Vm(lua_State* L, std::unique_ptr<Allocator> allocator)
+    : allocator_(std::move(allocator)),
+      lua_state_(L),
       embedded_c_modules_(
           new absl::flat_hash_map<std::string, EmbeddedClosure>()),
       embedded_lua_modules_(
           new absl::flat_hash_map<std::string, EmbeddedLuaFile>()) {
+  InstallSearcher();
+}
+
+void Vm::InstallSearcher() {
+  lua_State* L = get();
   lua_getglobal(L, "package");
   lua_getfield(L, -1, kSearcher);
   int array_size = ArrayLength(L, -1);
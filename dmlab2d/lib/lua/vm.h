@@ -24,6 +24,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "dmlab2d/lib/lua/allocator.h"
 #include "dmlab2d/lib/lua/lua.h"
 
 namespace deepmind::lab2d::lua {
@@ -47,11 +48,12 @@ struct Close {
 
 class Vm {
  public:
-  static Vm Create() {
-    lua_State* L = luaL_newstate();
-    luaL_openlibs(L);
-    return Vm(L);
-  }
+  // Counters maintained by the allocator of the VM.
+  using AllocatorStats = Allocator::Stats;
+
+  // Creates a VM with the standard libraries opened, using the allocator of the
+  // Lua implementation. See UseCountingAllocator.
+  static Vm Create();
 
   // Maintain unique_ptr interface.
   lua_State* get() { return lua_state_.get(); }
@@ -83,9 +85,39 @@ class Vm {
   // Add a path to be included in search when calling require.
   void AddPathToSearchers(absl::string_view path);
 
+  // Adds `searcher` to the module searchers, after the embedded modules but
+  // before the searchers that look up `package.path` and `package.cpath` on
+  // disk. The upvalues will be available when the searcher is called.
+  void AddSearcher(lua_CFunction searcher, std::vector<void*> up_values = {});
+
+  // Replaces the Lua state with a new one whose allocator counts allocations
+  // and can pool small blocks (see allocator.h). Modules added with
+  // AddCModuleToSearchers and AddLuaModuleToSearchers are kept; everything
+  // else done to the previous state is lost. Does nothing if the VM already
+  // has such an allocator, or if the Lua implementation does not support
+  // custom allocators, as 64-bit LuaJIT without GC64 does.
+  void UseCountingAllocator();
+
+  // Returns the allocator counters, or null if the VM uses the default
+  // allocator of the Lua implementation.
+  const AllocatorStats* allocator_stats() const {
+    return allocator_ != nullptr ? &allocator_->stats() : nullptr;
+  }
+
+  // Returns the allocator of the VM, or null if the VM uses the default
+  // allocator of the Lua implementation.
+  Allocator* allocator() { return allocator_.get(); }
+
  private:
-  // Takes ownership of lua_State.
-  explicit Vm(lua_State* L);
+  // Takes ownership of lua_State. `allocator` is the userdata of the state's
+  // allocator, if any.
+  Vm(lua_State* L, std::unique_ptr<Allocator> allocator);
+
+  // Installs the searcher of the embedded modules and the traceback handler.
+  void InstallSearcher();
+
+  // Declared before `lua_state_` as closing the state frees into it.
+  std::unique_ptr<Allocator> allocator_;
 
   std::unique_ptr<lua_State, internal::Close> lua_state_;
 
@@ -16,6 +16,7 @@
 
 #include "dmlab2d/lib/lua/vm.h"
 
+#include <cstddef>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -56,6 +57,33 @@ TEST(VmTest, TestVm) {
   }
 }
 
+TEST(VmTest, AllocatorStats) {
+  Vm vm = CreateVm();
+  EXPECT_EQ(vm.allocator_stats(), nullptr);
+  vm.UseCountingAllocator();
+  const Vm::AllocatorStats* stats = vm.allocator_stats();
+  if (stats == nullptr) {
+    GTEST_SKIP() << "Lua implementation does not support custom allocators.";
+  }
+  lua_State* L = vm.get();
+  lua_gc(L, LUA_GCCOLLECT, 0);
+  const auto before = *stats;
+  lua_createtable(L, 1000, 0);
+  EXPECT_GT(stats->bytes_allocated, before.bytes_allocated);
+  EXPECT_GT(stats->bytes_in_use, before.bytes_in_use);
+  EXPECT_GT(stats->num_allocations, before.num_allocations);
+
+  const auto after_create = *stats;
+  lua_pop(L, 1);
+  lua_gc(L, LUA_GCCOLLECT, 0);
+  EXPECT_LT(stats->bytes_in_use, after_create.bytes_in_use);
+  EXPECT_EQ(stats->bytes_allocated, after_create.bytes_allocated);
+
+  std::size_t lua_count = lua_gc(L, LUA_GCCOUNT, 0) * std::size_t{1024} +
+                          lua_gc(L, LUA_GCCOUNTB, 0);
+  EXPECT_EQ(stats->bytes_in_use, lua_count);
+}
+
 constexpr char kUseModule[] = R"(
 local mod = require 'test.module'
 return mod.hello
@@ -83,6 +111,20 @@ TEST(VmTest, TestEmbedC) {
   EXPECT_EQ(11, val);
 }
 
+TEST(VmTest, UseCountingAllocatorKeepsModules) {
+  Vm vm = CreateVm();
+  vm.AddCModuleToSearchers("test.module", CModule);
+  vm.UseCountingAllocator();
+  auto* L = vm.get();
+
+  ASSERT_THAT(PushScript(L, kUseModule, "kUseModule"), IsOkAndHolds(1));
+  ASSERT_THAT(lua::Call(L, 0), IsOkAndHolds(1));
+
+  int val;
+  ASSERT_TRUE(IsFound(lua::Read(L, -1, &val)));
+  EXPECT_EQ(11, val);
+}
+
 int CModuleUpValue(lua_State* L) {
   int* up1 = static_cast<int*>(lua_touserdata(L, lua_upvalueindex(1)));
   int* up2 = static_cast<int*>(lua_touserdata(L, lua_upvalueindex(2)));
@@ -68,9 +68,6 @@ static constexpr int kMinSteps = 5;
 // Minimum amount of boxes in the room.
 static constexpr int kMinBoxes = 1;
 
-// Search hash_map starting memory.
-static constexpr int kVisitedRoomsBucketCount = 1e7;
-
 }  // namespace generator
 
 }  // namespace deepmind::lab2d::pushbox
@@ -0,0 +1,250 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/dataset.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+// Tile codes used by EncodeLevel, indexed by code.
+constexpr char kTileChars[] = {room::kFloorChar,     room::kWallChar,
+                               room::kTagetChar,     room::kBoxChar,
+                               room::kBoxTagetChar,  room::kPlayerChar};
+constexpr int kNumTileCodes = sizeof(kTileChars);
+
+int TileCode(char tile) {
+  for (int code = 0; code < kNumTileCodes; ++code) {
+    if (kTileChars[code] == tile) return code;
+  }
+  return -1;
+}
+
+// Pieces hashed by CanonicalLevelHash.
+enum class Piece : std::uint64_t {
+  kWidth,
+  kHeight,
+  kWall,
+  kTarget,
+  kBox,
+  kPlayer
+};
+
+// Returns the Zobrist bitstring of `piece` at `cell`. The bitstrings are
+// generated on demand with SplitMix64 so that levels of any size can be
+// hashed.
+std::uint64_t Bitstring(Piece piece, std::uint64_t cell) {
+  std::uint64_t z = (cell * 8 + static_cast<std::uint64_t>(piece) + 1) *
+                    0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Splits `level` into rows. Returns an empty vector if it is not rectangular.
+std::vector<absl::string_view> Rows(absl::string_view level) {
+  std::vector<absl::string_view> rows = absl::StrSplit(level, '\n');
+  for (const auto& row : rows) {
+    if (row.size() != rows.front().size()) return {};
+  }
+  return rows;
+}
+
+}  // namespace
+
+std::uint64_t CanonicalLevelHash(absl::string_view level) {
+  std::vector<absl::string_view> rows = Rows(level);
+  if (rows.empty()) return 0;
+  const int width = rows.front().size();
+  const int height = rows.size();
+  std::vector<char> tiles;
+  tiles.reserve(width * height);
+  for (const auto& row : rows) {
+    tiles.insert(tiles.end(), row.begin(), row.end());
+  }
+
+  std::uint64_t hash =
+      Bitstring(Piece::kWidth, width) ^ Bitstring(Piece::kHeight, height);
+  int player = -1;
+  for (int cell = 0; cell < tiles.size(); ++cell) {
+    switch (tiles[cell]) {
+      case room::kWallChar:
+        hash ^= Bitstring(Piece::kWall, cell);
+        break;
+      case room::kTagetChar:
+        hash ^= Bitstring(Piece::kTarget, cell);
+        break;
+      case room::kBoxChar:
+        hash ^= Bitstring(Piece::kBox, cell);
+        break;
+      case room::kBoxTagetChar:
+        hash ^= Bitstring(Piece::kBox, cell) ^ Bitstring(Piece::kTarget, cell);
+        break;
+      case room::kPlayerChar:
+        player = cell;
+        break;
+    }
+  }
+  if (player < 0) return hash;
+
+  // Normalise the player to the first cell of its reachable region.
+  auto is_open = [&tiles](int cell) {
+    char tile = tiles[cell];
+    return tile != room::kWallChar && tile != room::kBoxChar &&
+           tile != room::kBoxTagetChar;
+  };
+  std::vector<bool> reached(tiles.size());
+  std::vector<int> pending = {player};
+  reached[player] = true;
+  int canonical_player = player;
+  while (!pending.empty()) {
+    int cell = pending.back();
+    pending.pop_back();
+    canonical_player = std::min(canonical_player, cell);
+    int x = cell % width;
+    int y = cell / width;
+    for (int next : {x > 0 ? cell - 1 : -1, x + 1 < width ? cell + 1 : -1,
+                     y > 0 ? cell - width : -1,
+                     y + 1 < height ? cell + width : -1}) {
+      if (next >= 0 && !reached[next] && is_open(next)) {
+        reached[next] = true;
+        pending.push_back(next);
+      }
+    }
+  }
+  return hash ^ Bitstring(Piece::kPlayer, canonical_player);
+}
+
+bool EncodeLevel(absl::string_view level, std::string* encoded) {
+  std::vector<absl::string_view> rows = Rows(level);
+  if (rows.empty() || rows.front().size() > 255 || rows.size() > 255) {
+    return false;
+  }
+  const std::size_t start = encoded->size();
+  encoded->push_back(static_cast<char>(rows.front().size()));
+  encoded->push_back(static_cast<char>(rows.size()));
+  int num_cells = 0;
+  for (const auto& row : rows) {
+    for (char tile : row) {
+      int code = TileCode(tile);
+      if (code < 0) {
+        encoded->resize(start);
+        return false;
+      }
+      if (num_cells % 2 == 0) {
+        encoded->push_back(static_cast<char>(code));
+      } else {
+        encoded->back() = static_cast<char>(encoded->back() | code << 4);
+      }
+      ++num_cells;
+    }
+  }
+  return true;
+}
+
+bool DecodeLevel(absl::string_view* encoded, std::string* level) {
+  if (encoded->size() < 2) return false;
+  const int width = static_cast<unsigned char>((*encoded)[0]);
+  const int height = static_cast<unsigned char>((*encoded)[1]);
+  const std::size_t num_bytes = 2 + (width * height + 1) / 2;
+  if (width == 0 || height == 0 || encoded->size() < num_bytes) return false;
+  level->clear();
+  level->reserve((width + 1) * height - 1);
+  for (int cell = 0; cell < width * height; ++cell) {
+    if (cell > 0 && cell % width == 0) level->push_back('\n');
+    unsigned char byte = (*encoded)[2 + cell / 2];
+    int code = cell % 2 == 0 ? byte & 0xF : byte >> 4;
+    if (code >= kNumTileCodes) return false;
+    level->push_back(kTileChars[code]);
+  }
+  encoded->remove_prefix(num_bytes);
+  return true;
+}
+
+void GenerateDataset(const Settings& settings, std::uint32_t first_seed,
+                     std::uint64_t num_levels, int num_threads,
+                     const std::function<void(DatasetLevel)>& consume) {
+  num_threads = std::max(num_threads, 1);
+  // Levels finished ahead of the next one to consume are held in `window`,
+  // indexed by level modulo its size.
+  const std::uint64_t window_size = 4 * num_threads;
+  std::vector<absl::optional<DatasetLevel>> window(window_size);
+  absl::Mutex mutex;
+  std::uint64_t next_claimed = 0;
+  std::uint64_t next_consumed = 0;
+
+  auto worker = [&] {
+    absl::MutexLock lock(&mutex);
+    auto can_claim = [&] {
+      return next_claimed >= num_levels ||
+             next_claimed < next_consumed + window_size;
+    };
+    for (;;) {
+      mutex.Await(absl::Condition(&can_claim));
+      if (next_claimed >= num_levels) return;
+      std::uint64_t index = next_claimed++;
+
+      mutex.Unlock();
+      DatasetLevel level;
+      level.seed = static_cast<std::uint32_t>(first_seed + index);
+      Settings level_settings = settings;
+      level_settings.seed = level.seed;
+      absl::Time start = absl::Now();
+      level.result = GenerateLevel(level_settings, &level.stats);
+      level.duration = absl::Now() - start;
+      mutex.Lock();
+
+      window[index % window_size] = std::move(level);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (std::uint64_t index = 0; index < num_levels; ++index) {
+    DatasetLevel level;
+    {
+      auto& slot = window[index % window_size];
+      auto ready = [&slot] { return slot.has_value(); };
+      absl::MutexLock lock(&mutex, absl::Condition(&ready));
+      level = std::move(*slot);
+      slot.reset();
+      ++next_consumed;
+    }
+    consume(std::move(level));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace deepmind::lab2d::pushbox
@@ -0,0 +1,67 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Bulk generation of Pushbox levels for offline datasets.
+
+#ifndef DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_DATASET_H_
+#define DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_DATASET_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+
+namespace deepmind::lab2d::pushbox {
+
+// Returns a Zobrist hash of `level`, a level as returned by GenerateLevel. The
+// hash covers walls, targets and boxes, and treats all player positions that
+// are reachable from each other without pushing boxes as the same, so levels
+// that only differ in where the player starts hash equally.
+std::uint64_t CanonicalLevelHash(absl::string_view level);
+
+// Appends a compact encoding of `level` to `encoded`: one byte each for width
+// and height, followed by one 4-bit tile code per cell, two cells per byte,
+// first cell in the low bits. Returns false if `level` is not rectangular,
+// is larger than 255x255 or contains unknown tiles.
+bool EncodeLevel(absl::string_view level, std::string* encoded);
+
+// Decodes a level written by EncodeLevel from the front of `encoded` into
+// `level` and removes it from `encoded`. Returns false if `encoded` does not
+// start with a valid level.
+bool DecodeLevel(absl::string_view* encoded, std::string* level);
+
+// A level generated for a dataset.
+struct DatasetLevel {
+  std::uint32_t seed;
+  ResultOr result;
+  SearchStats stats;
+  // Time taken to generate the level.
+  absl::Duration duration;
+};
+
+// Generates the levels for seeds `first_seed` to `first_seed + num_levels - 1`
+// (wrapping around), using `settings` for everything but the seed, on
+// `num_threads` threads. Each level is passed to `consume` on the calling
+// thread in seed order, so the output does not depend on thread timing. At
+// most a few levels per thread are held waiting for earlier seeds.
+void GenerateDataset(const Settings& settings, std::uint32_t first_seed,
+                     std::uint64_t num_levels, int num_threads,
+                     const std::function<void(DatasetLevel)>& consume);
+
+}  // namespace deepmind::lab2d::pushbox
+
+#endif  // DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_DATASET_H_
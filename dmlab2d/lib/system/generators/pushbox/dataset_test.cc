@@ -0,0 +1,118 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/dataset.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+constexpr absl::string_view kLevel =
+    "*******\n"
+    "*P    *\n"
+    "* *B* *\n"
+    "*  X& *\n"
+    "*******";
+
+TEST(CanonicalLevelHashTest, IgnoresPlayerWithinReachableRegion) {
+  std::string moved(kLevel);
+  std::swap(moved[9], moved[13]);  // Player moves right along the top row.
+  EXPECT_EQ(CanonicalLevelHash(kLevel), CanonicalLevelHash(moved));
+}
+
+TEST(CanonicalLevelHashTest, DistinguishesBoxesAndTargets) {
+  std::string box_moved(kLevel);
+  std::swap(box_moved[19], box_moved[17]);
+  EXPECT_NE(CanonicalLevelHash(kLevel), CanonicalLevelHash(box_moved));
+
+  std::string target_moved(kLevel);
+  std::swap(target_moved[27], target_moved[26]);
+  EXPECT_NE(CanonicalLevelHash(kLevel), CanonicalLevelHash(target_moved));
+}
+
+TEST(CanonicalLevelHashTest, DistinguishesPlayerRegions) {
+  // With the box in the gap the left column is cut off from the top row.
+  constexpr absl::string_view kSplit =
+      "*****\n"
+      "* P *\n"
+      "*B***\n"
+      "*   *\n"
+      "*****";
+  std::string other_region(kSplit);
+  std::swap(other_region[8], other_region[20]);
+  EXPECT_NE(CanonicalLevelHash(kSplit), CanonicalLevelHash(other_region));
+}
+
+TEST(EncodeLevelTest, RoundTrips) {
+  Settings settings;
+  settings.seed = 3;
+  std::string level = GenerateLevel(settings).level;
+  ASSERT_FALSE(level.empty());
+
+  std::string encoded;
+  ASSERT_TRUE(EncodeLevel(kLevel, &encoded));
+  ASSERT_TRUE(EncodeLevel(level, &encoded));
+  EXPECT_EQ(encoded.size(), 2 + (7 * 5 + 1) / 2 + 2 + 14 * 14 / 2);
+
+  absl::string_view remaining = encoded;
+  std::string decoded;
+  ASSERT_TRUE(DecodeLevel(&remaining, &decoded));
+  EXPECT_EQ(decoded, kLevel);
+  ASSERT_TRUE(DecodeLevel(&remaining, &decoded));
+  EXPECT_EQ(decoded, level);
+  EXPECT_TRUE(remaining.empty());
+  EXPECT_FALSE(DecodeLevel(&remaining, &decoded));
+}
+
+TEST(EncodeLevelTest, RejectsInvalidLevels) {
+  std::string encoded;
+  EXPECT_FALSE(EncodeLevel("**\n*", &encoded));
+  EXPECT_FALSE(EncodeLevel("*?*", &encoded));
+  EXPECT_TRUE(encoded.empty());
+}
+
+TEST(GenerateDatasetTest, MatchesGenerateLevelInSeedOrder) {
+  Settings settings;
+  settings.width = 8;
+  settings.height = 8;
+  settings.num_boxes = 2;
+  std::vector<DatasetLevel> levels;
+  GenerateDataset(settings, /*first_seed=*/100, /*num_levels=*/20,
+                  /*num_threads=*/3,
+                  [&levels](DatasetLevel level) {
+                    levels.push_back(std::move(level));
+                  });
+  ASSERT_EQ(levels.size(), 20);
+  for (std::uint32_t i = 0; i < levels.size(); ++i) {
+    settings.seed = 100 + i;
+    SearchStats stats;
+    ResultOr expected = GenerateLevel(settings, &stats);
+    EXPECT_EQ(levels[i].seed, settings.seed);
+    EXPECT_EQ(levels[i].result.level, expected.level);
+    EXPECT_EQ(levels[i].result.error, expected.error);
+    EXPECT_EQ(levels[i].stats.rooms_visited, stats.rooms_visited);
+    EXPECT_EQ(levels[i].stats.attempts, stats.attempts);
+    EXPECT_GE(levels[i].stats.attempts, 1);
+  }
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
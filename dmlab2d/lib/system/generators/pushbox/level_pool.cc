@@ -0,0 +1,157 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/level_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+constexpr std::size_t kDefaultCapacity = 64;
+
+}  // namespace
+
+LevelPool::LevelPool(std::size_t num_threads, std::size_t capacity)
+    : num_threads_(std::max<std::size_t>(num_threads, 1)),
+      capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+LevelPool::~LevelPool() {
+  std::vector<std::thread> threads;
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+    threads.swap(threads_);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+LevelPool* LevelPool::Default() {
+  static LevelPool* pool = new LevelPool(
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1),
+      kDefaultCapacity);
+  return pool;
+}
+
+bool LevelPool::Prefetch(const Settings& settings) {
+  absl::MutexLock lock(&mutex_);
+  if (entries_.contains(settings)) {
+    return true;
+  }
+  if (entries_.size() >= capacity_) {
+    auto oldest_done =
+        std::find_if(order_.begin(), order_.end(), [this](const Settings& key) {
+          return entries_.at(key).state == State::kDone;
+        });
+    if (oldest_done == order_.end()) {
+      return false;
+    }
+    entries_.erase(*oldest_done);
+    order_.erase(oldest_done);
+  }
+  entries_.try_emplace(settings);
+  order_.push_back(settings);
+  ++num_queued_;
+  if (threads_.empty()) {
+    threads_.reserve(num_threads_);
+    for (std::size_t i = 0; i < num_threads_; ++i) {
+      threads_.emplace_back(&LevelPool::WorkerLoop, this);
+    }
+  }
+  return true;
+}
+
+absl::optional<ResultOr> LevelPool::TryTake(const Settings& settings) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(settings);
+  if (it == entries_.end() || it->second.state != State::kDone) {
+    return absl::nullopt;
+  }
+  ResultOr result = std::move(it->second.result);
+  entries_.erase(it);
+  EraseFromOrder(settings);
+  return result;
+}
+
+ResultOr LevelPool::Take(const Settings& settings) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto not_running = [this, &settings] { return !IsRunning(settings); };
+    mutex_.Await(absl::Condition(&not_running));
+    if (auto it = entries_.find(settings); it != entries_.end()) {
+      bool done = it->second.state == State::kDone;
+      ResultOr result = std::move(it->second.result);
+      if (!done) --num_queued_;
+      entries_.erase(it);
+      EraseFromOrder(settings);
+      if (done) return result;
+    }
+  }
+  // Levels that were never requested or are still queued behind others are
+  // generated here, which is at least as fast as waiting for a worker.
+  return GenerateLevel(settings);
+}
+
+std::size_t LevelPool::size() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+void LevelPool::WorkerLoop() {
+  auto has_work = [this] { return stopping_ || num_queued_ > 0; };
+  absl::MutexLock lock(&mutex_);
+  for (;;) {
+    mutex_.Await(absl::Condition(&has_work));
+    if (stopping_) {
+      return;
+    }
+    auto next =
+        std::find_if(order_.begin(), order_.end(), [this](const Settings& key) {
+          return entries_.at(key).state == State::kQueued;
+        });
+    Settings settings = *next;
+    entries_.at(settings).state = State::kRunning;
+    --num_queued_;
+
+    mutex_.Unlock();
+    ResultOr result = GenerateLevel(settings);
+    mutex_.Lock();
+
+    // Running entries are never evicted or taken, so the entry still exists.
+    Entry& entry = entries_.at(settings);
+    entry.result = std::move(result);
+    entry.state = State::kDone;
+  }
+}
+
+bool LevelPool::IsRunning(const Settings& settings) const {
+  auto it = entries_.find(settings);
+  return it != entries_.end() && it->second.state == State::kRunning;
+}
+
+void LevelPool::EraseFromOrder(const Settings& settings) {
+  order_.erase(std::find(order_.begin(), order_.end(), settings));
+}
+
+}  // namespace deepmind::lab2d::pushbox
@@ -0,0 +1,100 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Background generation of Pushbox levels.
+
+#ifndef DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_LEVEL_POOL_H_
+#define DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_LEVEL_POOL_H_
+
+#include <cstddef>
+#include <deque>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+
+namespace deepmind::lab2d::pushbox {
+
+// Generates Pushbox levels on worker threads ahead of time. Levels are
+// requested with Prefetch and collected with TryTake or Take using the same
+// Settings. A level produced by the pool is always identical to
+// GenerateLevel(settings), so results stay deterministic per seed regardless
+// of thread timing.
+//
+// At most `capacity` levels are queued, in progress or waiting to be taken.
+// When the pool is full the oldest finished level that was never taken is
+// dropped to make room; if none has finished Prefetch fails.
+class LevelPool {
+ public:
+  // The `num_threads` workers are started by the first call to Prefetch.
+  LevelPool(std::size_t num_threads, std::size_t capacity);
+  ~LevelPool();
+
+  LevelPool(const LevelPool&) = delete;
+  LevelPool& operator=(const LevelPool&) = delete;
+
+  // Process-wide pool used by the Lua `pushbox` module, with one worker per
+  // hardware thread.
+  static LevelPool* Default();
+
+  // Queues generation of the level for `settings`. Returns whether the level
+  // is queued, in progress or ready after the call.
+  bool Prefetch(const Settings& settings);
+
+  // Removes and returns the level for `settings` if it has been generated.
+  // Never blocks on generation.
+  absl::optional<ResultOr> TryTake(const Settings& settings);
+
+  // Returns the level for `settings`. Waits for it if a worker is generating
+  // it and otherwise generates it on the calling thread.
+  ResultOr Take(const Settings& settings);
+
+  // Number of levels queued, in progress or waiting to be taken.
+  std::size_t size() const;
+
+ private:
+  enum class State { kQueued, kRunning, kDone };
+
+  struct Entry {
+    State state = State::kQueued;
+    ResultOr result;
+  };
+
+  void WorkerLoop();
+
+  bool IsRunning(const Settings& settings) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Erases `settings` from `order_`.
+  void EraseFromOrder(const Settings& settings)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::size_t num_threads_;
+  const std::size_t capacity_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Settings, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  // Keys of `entries_` in the order they were requested.
+  std::deque<Settings> order_ ABSL_GUARDED_BY(mutex_);
+  std::size_t num_queued_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace deepmind::lab2d::pushbox
+
+#endif  // DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_LEVEL_POOL_H_
@@ -0,0 +1,86 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/level_pool.h"
+
+#include <cstdint>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+Settings SmallSettings(std::uint32_t seed) {
+  Settings settings;
+  settings.seed = seed;
+  settings.width = 8;
+  settings.height = 8;
+  settings.num_boxes = 2;
+  return settings;
+}
+
+TEST(LevelPoolTest, TakeMatchesGenerateLevel) {
+  LevelPool pool(/*num_threads=*/2, /*capacity=*/8);
+  for (std::uint32_t seed = 1; seed <= 4; ++seed) {
+    EXPECT_TRUE(pool.Prefetch(SmallSettings(seed)));
+  }
+  // Taken in a different order from the one requested.
+  for (std::uint32_t seed = 4; seed >= 1; --seed) {
+    auto expected = GenerateLevel(SmallSettings(seed));
+    auto actual = pool.Take(SmallSettings(seed));
+    EXPECT_EQ(actual.level, expected.level) << "seed " << seed;
+    EXPECT_EQ(actual.error, expected.error) << "seed " << seed;
+  }
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(LevelPoolTest, TakeGeneratesUnrequestedLevel) {
+  LevelPool pool(/*num_threads=*/1, /*capacity=*/1);
+  EXPECT_EQ(pool.Take(SmallSettings(7)).level,
+            GenerateLevel(SmallSettings(7)).level);
+}
+
+TEST(LevelPoolTest, TryTakeNeverBlocks) {
+  LevelPool pool(/*num_threads=*/1, /*capacity=*/2);
+  EXPECT_FALSE(pool.TryTake(SmallSettings(3)).has_value());
+  ASSERT_TRUE(pool.Prefetch(SmallSettings(3)));
+  EXPECT_TRUE(pool.Prefetch(SmallSettings(3)));
+  EXPECT_EQ(pool.size(), 1);
+  absl::optional<ResultOr> result;
+  for (int i = 0; i < 1000 && !result; ++i) {
+    result = pool.TryTake(SmallSettings(3));
+    if (!result) absl::SleepFor(absl::Milliseconds(10));
+  }
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->level, GenerateLevel(SmallSettings(3)).level);
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(LevelPoolTest, FullPoolEvictsFinishedLevels) {
+  LevelPool pool(/*num_threads=*/1, /*capacity=*/1);
+  ASSERT_TRUE(pool.Prefetch(SmallSettings(1)));
+  // Fails until the first level is finished and can be dropped.
+  while (!pool.Prefetch(SmallSettings(2))) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(pool.size(), 1);
+  EXPECT_FALSE(pool.TryTake(SmallSettings(1)).has_value());
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
@@ -14,19 +14,23 @@
 
 #include "dmlab2d/lib/system/generators/pushbox/lua/pushbox.h"
 
+#include <cstdint>
+
 #include "dmlab2d/lib/lua/bind.h"
 #include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
 #include "dmlab2d/lib/lua/push.h"
 #include "dmlab2d/lib/lua/read.h"
 #include "dmlab2d/lib/lua/table_ref.h"
+#include "dmlab2d/lib/system/generators/pushbox/level_pool.h"
 #include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
 
 namespace deepmind::lab2d {
 namespace {
 
-lua::NResultsOr Generate(lua_State* L) {
-  pushbox::Settings settings;
+// Reads the kwargs table at stack index 1 into `settings`. Returns 0 on
+// success.
+lua::NResultsOr ReadSettings(lua_State* L, pushbox::Settings* settings) {
   std::uint32_t room_seed;
   std::uint32_t targets_seed;
   std::uint32_t actions_seed;
@@ -34,32 +38,45 @@ lua::NResultsOr Generate(lua_State* L) {
   lua::TableRef table;
   if (!IsFound(Read(L, 1, &table))) return "Missing kwags";
 
-  if (!IsFound(table.LookUp("seed", &settings.seed))) {
+  if (!IsFound(table.LookUp("seed", &settings->seed))) {
     return "Missing kwarg: 'seed'";
   }
-  if (!IsFound(table.LookUp("width", &settings.width))) {
+  if (!IsFound(table.LookUp("width", &settings->width))) {
     return "Missing kwarg: 'width'";
   }
-  if (!IsFound(table.LookUp("height", &settings.height))) {
+  if (!IsFound(table.LookUp("height", &settings->height))) {
     return "Missing kwarg: 'height'";
   }
-  if (!IsFound(table.LookUp("numBoxes", &settings.num_boxes))) {
+  if (!IsFound(table.LookUp("numBoxes", &settings->num_boxes))) {
     return "Missing kwarg: 'numBoxes'";
   }
-  if (IsTypeMismatch(table.LookUp("roomSteps", &settings.room_steps))) {
+  if (IsTypeMismatch(table.LookUp("roomSteps", &settings->room_steps))) {
     return "kwarg: 'roomSteps' must be an int.";
   }
+  if (IsTypeMismatch(
+          table.LookUp("maxRoomConfigs", &settings->max_room_configs))) {
+    return "kwarg: 'maxRoomConfigs' must be an int.";
+  }
+  if (IsTypeMismatch(table.LookUp("numThreads", &settings->num_threads))) {
+    return "kwarg: 'numThreads' must be an int.";
+  }
+  if (IsTypeMismatch(table.LookUp("pruneSearch", &settings->prune_search))) {
+    return "kwarg: 'pruneSearch' must be a boolean.";
+  }
   if (IsFound(table.LookUp("roomSeed", &room_seed))) {
-    settings.room_seed = room_seed;
+    settings->room_seed = room_seed;
   }
   if (IsFound(table.LookUp("targetsSeed", &targets_seed))) {
-    settings.targets_seed = targets_seed;
+    settings->targets_seed = targets_seed;
   }
   if (IsFound(table.LookUp("actionsSeed", &actions_seed))) {
-    settings.actions_seed = actions_seed;
+    settings->actions_seed = actions_seed;
   }
+  return 0;
+}
 
-  const auto& [level, err] = pushbox::GenerateLevel(settings);
+lua::NResultsOr PushLevel(lua_State* L, const pushbox::ResultOr& result) {
+  const auto& [level, err] = result;
   if (!err.empty()) {
     return err;
   }
@@ -67,11 +84,47 @@ lua::NResultsOr Generate(lua_State* L) {
   return 1;
 }
 
+// Returns the level for the kwargs, taking it from the level pool if it was
+// prefetched.
+lua::NResultsOr Generate(lua_State* L) {
+  pushbox::Settings settings;
+  if (auto result = ReadSettings(L, &settings); !result.ok()) {
+    return result;
+  }
+  return PushLevel(L, pushbox::LevelPool::Default()->Take(settings));
+}
+
+// Starts generating the level for the kwargs on a background thread. Returns
+// whether the level pool accepted the request.
+lua::NResultsOr Prefetch(lua_State* L) {
+  pushbox::Settings settings;
+  if (auto result = ReadSettings(L, &settings); !result.ok()) {
+    return result;
+  }
+  lua::Push(L, pushbox::LevelPool::Default()->Prefetch(settings));
+  return 1;
+}
+
+// Returns the prefetched level for the kwargs if it is ready, otherwise nil.
+lua::NResultsOr TryGenerate(lua_State* L) {
+  pushbox::Settings settings;
+  if (auto result = ReadSettings(L, &settings); !result.ok()) {
+    return result;
+  }
+  if (auto result = pushbox::LevelPool::Default()->TryTake(settings)) {
+    return PushLevel(L, *result);
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
 }  // namespace
 
 int LuaPushboxRequire(lua_State* L) {
   auto table = lua::TableRef::Create(L);
   table.Insert("generate", &lua::Bind<Generate>);
+  table.Insert("prefetch", &lua::Bind<Prefetch>);
+  table.Insert("tryGenerate", &lua::Bind<TryGenerate>);
   lua::Push(L, table);
   return 1;
 }
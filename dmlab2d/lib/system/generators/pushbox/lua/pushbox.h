@@ -25,10 +25,20 @@ namespace deepmind::lab2d {
 //       height = <int>,
 //       numBoxes = <int>,
 //       roomSteps = [optional] <int>,
+//       maxRoomConfigs = [optional] <int>,
+//       numThreads = [optional] <int>,
+//       pruneSearch = [optional] <bool>,
 //       roomSeed = [optional] <unsigned int>,
 //       targetsSeed = [optional] <unsigned int>,
 //       actionsSeed = [optional] <unsigned int>
 //   }
+//   Returns the level, taking it from the level pool if it was prefetched.
+// * prefetch{<same as generate>}
+//   Starts generating the level on a background thread and returns whether it
+//   was queued.
+// * tryGenerate{<same as generate>}
+//   Returns the prefetched level if it is ready and nil otherwise. Never
+//   blocks.
 int LuaPushboxRequire(lua_State* L);
 
 }  // namespace deepmind::lab2d
@@ -49,6 +49,33 @@ function tests.generateLevel()
   asserts.EQ(counters['P'], 1)
 end
 
+function tests.prefetchMatchesGenerate()
+  local kwargs = {seed = 11, width = 10, height = 10, numBoxes = 2}
+  local expected = pushbox.generate(kwargs)
+  asserts.EQ(pushbox.tryGenerate(kwargs), nil)
+  asserts.EQ(pushbox.prefetch(kwargs), true)
+  asserts.EQ(pushbox.generate(kwargs), expected)
+  -- Taken by `generate`, so nothing is left in the pool.
+  asserts.EQ(pushbox.tryGenerate(kwargs), nil)
+end
+
+function tests.tryGenerateReturnsPrefetchedLevel()
+  local kwargs = {seed = 12, width = 10, height = 10, numBoxes = 2}
+  local expected = pushbox.generate(kwargs)
+  pushbox.prefetch(kwargs)
+  local level
+  repeat
+    level = pushbox.tryGenerate(kwargs)
+  until level
+  asserts.EQ(level, expected)
+end
+
+function tests.numThreadsIsDeterministic()
+  local kwargs = {seed = 13, width = 10, height = 10, numBoxes = 2,
+                  numThreads = 3}
+  asserts.EQ(pushbox.generate(kwargs), pushbox.generate(kwargs))
+end
+
 function tests.badInputs()
   asserts.shouldFail(
       function()
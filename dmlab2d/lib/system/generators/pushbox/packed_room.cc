@@ -0,0 +1,99 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/packed_room.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+#include "dmlab2d/lib/system/math/math2d.h"
+
+namespace deepmind::lab2d::pushbox {
+
+RoomPacker::RoomPacker(const Room& base_room)
+    : base_room_(base_room),
+      width_(base_room.width()),
+      cell_count_(base_room.width() * base_room.height()),
+      topology_(base_room.topology()),
+      zobrist_bitstrings_(base_room.zobrist_bitstrings()) {
+  CHECK_LE(cell_count_, std::numeric_limits<std::uint16_t>::max())
+      << "Room too large to pack.";
+  initial_box_positions_.reserve(base_room.GetBoxes().size());
+  for (const auto& box : base_room.GetBoxes()) {
+    initial_box_positions_.push_back(box.initial_position());
+  }
+}
+
+void RoomPacker::Pack(const Room& room, std::uint16_t* packed) const {
+  auto cell = [this](const math::Vector2d& position) {
+    return static_cast<std::uint16_t>(position.x + position.y * width_);
+  };
+  packed[PackedRoomBuffer::kPlayer] = cell(room.GetPlayerPosition());
+  packed[PackedRoomBuffer::kNumActions] = room.num_actions();
+  packed[PackedRoomBuffer::kLastBox] = room.last_box_index() + 1;
+  packed[PackedRoomBuffer::kBoxChanges] = room.moved_box_changes();
+  std::uint16_t* box_cells = packed + PackedRoomBuffer::kBoxes;
+  for (const auto& box : room.GetBoxes()) {
+    *box_cells++ = cell(box.position());
+  }
+}
+
+Room RoomPacker::Unpack(const std::uint16_t* packed) const {
+  std::vector<math::Vector2d> box_positions;
+  box_positions.reserve(num_boxes());
+  for (int i = 0; i < num_boxes(); ++i) {
+    box_positions.push_back(position(packed[PackedRoomBuffer::kBoxes + i]));
+  }
+  Room room = base_room_;
+  room.RestoreState(position(packed[PackedRoomBuffer::kPlayer]), box_positions,
+                    packed[PackedRoomBuffer::kNumActions],
+                    packed[PackedRoomBuffer::kLastBox] - 1,
+                    packed[PackedRoomBuffer::kBoxChanges]);
+  room.ComputeScore();
+  return room;
+}
+
+std::uint64_t RoomPacker::Hash(const std::uint16_t* packed) const {
+  // Room starts from the player bitstring of cell 0 and toggles pieces in and
+  // out as they move, so the hash only depends on the final positions.
+  std::uint64_t hash = zobrist_bitstrings_[packed[PackedRoomBuffer::kPlayer]];
+  for (int i = 0; i < num_boxes(); ++i) {
+    hash ^= zobrist_bitstrings_[cell_count_ +
+                                packed[PackedRoomBuffer::kBoxes + i]];
+  }
+  return hash;
+}
+
+float RoomPacker::Score(const std::uint16_t* packed) const {
+  const std::uint16_t* box_cells = packed + PackedRoomBuffer::kBoxes;
+  if (topology_[packed[PackedRoomBuffer::kPlayer]] == TileType::kTarget) {
+    return 0;
+  }
+  for (int i = 0; i < num_boxes(); ++i) {
+    if (topology_[box_cells[i]] == TileType::kTarget) return 0;
+  }
+  float total_displacement = 0;
+  for (int i = 0; i < num_boxes(); ++i) {
+    const math::Vector2d& initial = initial_box_positions_[i];
+    total_displacement += std::abs(initial.x - box_cells[i] % width_) +
+                          std::abs(initial.y - box_cells[i] / width_);
+  }
+  return packed[PackedRoomBuffer::kBoxChanges] * total_displacement;
+}
+
+}  // namespace deepmind::lab2d::pushbox
@@ -0,0 +1,131 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compact search state for Pushbox rooms. The reverse search visits many room
+// configurations that share their walls, targets and box starting positions
+// with the base room, so only the parts that change are stored.
+
+#ifndef DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_PACKED_ROOM_H_
+#define DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_PACKED_ROOM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+#include "dmlab2d/lib/system/math/math2d.h"
+
+namespace deepmind::lab2d::pushbox {
+
+// A sequence of packed rooms stored back to back in a single buffer. A packed
+// room with N boxes occupies `kBoxes + N` 16-bit words, laid out as below. Box
+// cells are kept in the order of Room::GetBoxes(), as the score depends on
+// which box moved where.
+//
+// Appending only allocates when the buffer grows beyond its largest size so
+// far, so a buffer reused as a search frontier stops allocating after warm-up.
+class PackedRoomBuffer {
+ public:
+  // Word offsets within a packed room. Cells are `x + y * width`.
+  static constexpr int kPlayer = 0;      // Player cell.
+  static constexpr int kNumActions = 1;  // Number of applied actions.
+  static constexpr int kLastBox = 2;     // Last moved box index plus one.
+  static constexpr int kBoxChanges = 3;  // Number of moved box changes.
+  static constexpr int kBoxes = 4;       // First box cell.
+
+  explicit PackedRoomBuffer(int num_boxes)
+      : num_boxes_(num_boxes), room_size_(kBoxes + num_boxes) {}
+
+  int num_boxes() const { return num_boxes_; }
+
+  // Number of words in each packed room.
+  int room_size() const { return room_size_; }
+
+  std::size_t size() const { return words_.size() / room_size_; }
+  bool empty() const { return words_.empty(); }
+
+  std::uint16_t* operator[](std::size_t i) { return &words_[i * room_size_]; }
+  const std::uint16_t* operator[](std::size_t i) const {
+    return &words_[i * room_size_];
+  }
+
+  const std::uint16_t* back() const { return (*this)[size() - 1]; }
+
+  // Appends a copy of `room` and returns the copy. The result is valid until
+  // the buffer is next appended to.
+  std::uint16_t* Append(const std::uint16_t* room) {
+    words_.insert(words_.end(), room, room + room_size_);
+    return &words_[words_.size() - room_size_];
+  }
+
+  void PopBack() { words_.resize(words_.size() - room_size_); }
+  void clear() { words_.clear(); }
+  void reserve(std::size_t num_rooms) {
+    words_.reserve(num_rooms * room_size_);
+  }
+
+ private:
+  int num_boxes_;
+  int room_size_;
+  std::vector<std::uint16_t> words_;
+};
+
+// Converts rooms that share a base room to and from their packed form, and
+// evaluates packed rooms without unpacking them.
+class RoomPacker {
+ public:
+  // The base room's topology and Zobrist bitstrings must outlive the packer.
+  explicit RoomPacker(const Room& base_room);
+
+  int num_boxes() const { return initial_box_positions_.size(); }
+
+  // Writes the state of `room`, which must derive from the base room, into
+  // `packed`.
+  void Pack(const Room& room, std::uint16_t* packed) const;
+
+  // Returns a copy of the base room restored to the packed state, with its
+  // score computed.
+  Room Unpack(const std::uint16_t* packed) const;
+
+  // Returns the same value as Room::hash() of the unpacked room.
+  std::uint64_t Hash(const std::uint16_t* packed) const;
+
+  // Returns Hash(packed) as if the player were on `player_cell` instead.
+  std::uint64_t HashWithPlayer(const std::uint16_t* packed,
+                               int player_cell) const {
+    return Hash(packed) ^
+           zobrist_bitstrings_[packed[PackedRoomBuffer::kPlayer]] ^
+           zobrist_bitstrings_[player_cell];
+  }
+
+  // Returns the same value as Room::ComputeScore() of the unpacked room.
+  float Score(const std::uint16_t* packed) const;
+
+ private:
+  math::Vector2d position(int cell) const {
+    return {cell % width_, cell / width_};
+  }
+
+  Room base_room_;
+  int width_;
+  int cell_count_;
+  absl::Span<const TileType> topology_;
+  absl::Span<const std::uint64_t> zobrist_bitstrings_;
+  std::vector<math::Vector2d> initial_box_positions_;
+};
+
+}  // namespace deepmind::lab2d::pushbox
+
+#endif  // DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_PACKED_ROOM_H_
@@ -0,0 +1,118 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/packed_room.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
+#include "dmlab2d/lib/system/generators/pushbox/random_room_generator.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+#include "dmlab2d/lib/system/generators/pushbox/room_candidate_generator.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+class PackedRoomTest : public ::testing::Test {
+ protected:
+  PackedRoomTest()
+      : room_generator_(/*width=*/10, /*height=*/10, /*num_targets=*/3,
+                        /*gen_steps=*/20, generator::kDirectionChangeRatio,
+                        /*room_seed=*/1, /*positions_seed=*/2) {
+    topology_ = *room_generator_.GenerateRoomTopology();
+    base_room_ = room_generator_.UpdateBoxAndPlayerPositions(
+        absl::MakeSpan(topology_));
+  }
+
+  RandomRoomGenerator room_generator_;
+  std::vector<TileType> topology_;
+  absl::optional<Room> base_room_;
+};
+
+TEST_F(PackedRoomTest, BufferStoresRoomsBackToBack) {
+  PackedRoomBuffer buffer(/*num_boxes=*/2);
+  EXPECT_EQ(buffer.room_size(), PackedRoomBuffer::kBoxes + 2);
+  EXPECT_TRUE(buffer.empty());
+  std::vector<std::uint16_t> room(buffer.room_size(), 7);
+  buffer.Append(room.data());
+  room[PackedRoomBuffer::kPlayer] = 9;
+  buffer.Append(room.data());
+  ASSERT_EQ(buffer.size(), 2);
+  EXPECT_EQ(buffer[0][PackedRoomBuffer::kPlayer], 7);
+  EXPECT_EQ(buffer.back()[PackedRoomBuffer::kPlayer], 9);
+  buffer.PopBack();
+  EXPECT_EQ(buffer.size(), 1);
+  EXPECT_EQ(buffer.back()[PackedRoomBuffer::kPlayer], 7);
+}
+
+TEST_F(PackedRoomTest, UnpackRestoresPackedRoom) {
+  ASSERT_TRUE(base_room_.has_value());
+  RoomPacker packer(*base_room_);
+  ASSERT_EQ(packer.num_boxes(), 3);
+  std::vector<std::uint16_t> packed(PackedRoomBuffer::kBoxes + 3);
+  packer.Pack(*base_room_, packed.data());
+  Room room = packer.Unpack(packed.data());
+  EXPECT_EQ(room.ToString(), base_room_->ToString());
+  EXPECT_EQ(room.hash(), base_room_->hash());
+  EXPECT_EQ(packer.Hash(packed.data()), base_room_->hash());
+  EXPECT_EQ(room.room_score(), 0);
+}
+
+// Walks a few steps down the search tree and checks that every packed
+// candidate evaluates to the same values as the equivalent Room.
+TEST_F(PackedRoomTest, CandidatesMatchAppliedActions) {
+  ASSERT_TRUE(base_room_.has_value());
+  RoomPacker packer(*base_room_);
+  RoomCandidateGenerator generator(*base_room_);
+  PackedRoomBuffer candidates(packer.num_boxes());
+  std::vector<std::uint16_t> room(candidates.room_size());
+  packer.Pack(*base_room_, room.data());
+  Room previous = *base_room_;
+  for (int step = 0; step < 20; ++step) {
+    candidates.clear();
+    generator.GenerateRoomCandidates(room.data(), &candidates);
+    ASSERT_FALSE(candidates.empty());
+    for (int i = 0; i < candidates.size(); ++i) {
+      Room candidate = packer.Unpack(candidates[i]);
+      EXPECT_EQ(candidate.num_actions(), step + 1);
+      EXPECT_EQ(packer.Hash(candidates[i]), candidate.hash());
+      EXPECT_EQ(packer.Score(candidates[i]), candidate.room_score());
+
+      // The player ends up two cells from where the box was, on the side
+      // opposite to it, and the box follows into the player's old cell.
+      math::Vector2d player = candidate.GetPlayerPosition();
+      int moved_boxes = 0;
+      for (int b = 0; b < packer.num_boxes(); ++b) {
+        const auto& before = previous.GetBoxes()[b].position();
+        const auto& after = candidate.GetBoxes()[b].position();
+        if (before == after) continue;
+        ++moved_boxes;
+        EXPECT_EQ(player - after, after - before);
+        EXPECT_EQ(candidate.last_box_index(), b);
+      }
+      EXPECT_EQ(moved_boxes, 1);
+    }
+    previous = packer.Unpack(candidates.back());
+    std::copy_n(candidates.back(), candidates.room_size(), room.begin());
+  }
+  EXPECT_GT(previous.moved_box_changes(), 0);
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
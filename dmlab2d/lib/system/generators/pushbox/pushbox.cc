@@ -14,97 +14,29 @@
 
 #include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
 
-#include <algorithm>
 #include <cstdint>
 #include <random>
-#include <stack>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "dmlab2d/lib/system/generators/pushbox/constants.h"
 #include "dmlab2d/lib/system/generators/pushbox/random_room_generator.h"
+#include "dmlab2d/lib/system/generators/pushbox/reverse_solve.h"
 #include "dmlab2d/lib/system/generators/pushbox/room.h"
-#include "dmlab2d/lib/system/generators/pushbox/room_candidate_generator.h"
 
 namespace deepmind::lab2d::pushbox {
-namespace {
 
-// Generates a starting point for a Pushbox level by reverse application of
-// actions from a base position. Returns an error if it wasn't able to get
-// to a room position with score > 0 or the room configuration with highest
-// obtained score otherwise.
-// The received random number generator (rng) is used for randomly ordering the
-// set of applicable actions.
-// The max_room_configs parameter indicates how many possible configurations
-// from the base positions we may try.
-// The max_action_depth parameter indicates the maximum length of the sequence
-// of actions applied when exploring new room configurations (i.e. the search
-// depth).
-absl::optional<Room> ReverseSolveRoom(const Room& base_room,
-                                      std::mt19937_64* rng,
-                                      int max_room_configs,
-                                      int max_action_depth) {
-  // Set of rooms that we have already visited.
-  absl::flat_hash_set<std::uint64_t> visited_rooms(
-      generator::kVisitedRoomsBucketCount);
+ResultOr GenerateLevel(const Settings& settings, SearchStats* stats) {
+  SearchStats unused_stats;
+  if (stats == nullptr) stats = &unused_stats;
+  *stats = SearchStats();
 
-  // Keep track of the room with the highest score so far.
-  double highest_score = 0;
-  Room highest_score_room = base_room;
-
-  // A list of pending rooms on which we haven't applied actions yet.
-  std::stack<Room> pending_rooms;
-  pending_rooms.push(base_room);
-
-  RoomCandidateGenerator generator(base_room);
-
-  std::vector<Room> room_candidates;
-  while (!pending_rooms.empty() && visited_rooms.size() < max_room_configs) {
-    // Get the next pending room to apply actions to.
-    auto current_room = std::move(pending_rooms.top());
-    pending_rooms.pop();
-
-    room_candidates.clear();
-    generator.GenerateRoomCandidates(current_room, &room_candidates);
-    std::shuffle(room_candidates.begin(), room_candidates.end(), *rng);
-
-    for (auto& new_room : room_candidates) {
-      // Avoid going beyond the limit of applied actions.
-      if (new_room.num_actions() >= max_action_depth) continue;
-
-      // If we havent explore this room configuration yet add it to the
-      // pending and visited room lists.
-      auto hash = new_room.hash();
-      auto iter_insert = visited_rooms.insert(hash);
-      if (iter_insert.second) {
-        new_room.ComputeScore();
-        auto score = new_room.room_score();
-        if (score > highest_score) {
-          highest_score = score;
-          highest_score_room = new_room;
-        }
-        pending_rooms.emplace(std::move(new_room));
-      }
-    }
-  }
-
-  generator.MovePlayerToRandomAccessiblePosition(rng, &highest_score_room);
-
-  if (highest_score_room.room_score() == 0) return absl::nullopt;
-
-  return highest_score_room;
-}
-
-}  // namespace
-
-ResultOr GenerateLevel(const Settings& settings) {
   if (settings.height > generator::kMaxRoomSize)
     return ResultOr::Error(
         absl::StrFormat("Specified (height=%d) > (kMaxRoomSize=%d) ",
@@ -121,6 +53,12 @@ ResultOr GenerateLevel(const Settings& settings) {
     return ResultOr::Error(
         absl::StrFormat("Specified (roomSteps=%d) < (kMinSteps=%d) ",
                         settings.room_steps, generator::kMinSteps));
+  if (settings.max_room_configs < 1)
+    return ResultOr::Error(absl::StrFormat(
+        "Specified (maxRoomConfigs=%d) < 1 ", settings.max_room_configs));
+  if (settings.num_threads < 1)
+    return ResultOr::Error(absl::StrFormat("Specified (numThreads=%d) < 1 ",
+                                           settings.num_threads));
 
   std::mt19937_64 rng(settings.seed);
   std::uniform_int_distribution<std::uint32_t> seed_distribution;
@@ -153,12 +91,27 @@ ResultOr GenerateLevel(const Settings& settings) {
       auto base_room = std::move(status_or.value());
 
       // Try to reverse-solve the room to get a starting position for the level.
-      status_or = ReverseSolveRoom(base_room, &mt_rng,
-                                   generator::kMaxRoomConfigurations,
-                                   generator::kMaxAppliedActions);
+      int rooms_visited = 0;
+      if (settings.num_threads > 1) {
+        status_or = ParallelReverseSolveRoom(
+            base_room, &mt_rng, settings.max_room_configs,
+            generator::kMaxAppliedActions, settings.num_threads,
+            settings.prune_search, &rooms_visited);
+      } else {
+        status_or = ReverseSolveRoom(
+            base_room, &mt_rng, settings.max_room_configs,
+            generator::kMaxAppliedActions, settings.prune_search,
+            &rooms_visited);
+      }
+      ++stats->attempts;
+      stats->rooms_visited += rooms_visited;
 
       // Return the generated room configuration.
-      if (status_or) return ResultOr::Success(status_or.value().ToString());
+      if (status_or) {
+        stats->score = status_or->room_score();
+        stats->num_actions = status_or->num_actions();
+        return ResultOr::Success(status_or.value().ToString());
+      }
     }
   }
 
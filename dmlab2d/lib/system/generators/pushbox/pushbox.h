@@ -19,8 +19,11 @@
 
 #include <cstdint>
 #include <string>
+#include <tuple>
 #include <utility>
 
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
 #include "dmlab2d/lib/system/generators/pushbox/random_room_generator.h"
 #include "dmlab2d/lib/system/generators/pushbox/room.h"
 
@@ -52,6 +55,42 @@ struct Settings {
   // when searching for a valid starting position.  Unset uses one generated
   // from seed.
   absl::optional<std::uint32_t> actions_seed;
+
+  // Maximum number of room configurations explored by the reverse search for
+  // each placement of boxes and player.
+  int max_room_configs = generator::kMaxRoomConfigurations;
+
+  // Number of threads used by the reverse search. Each thread runs an
+  // independent search and the highest scoring room is kept (see
+  // ParallelReverseSolveRoom), so more threads yield harder levels at about the
+  // same latency. Levels for 1 thread match those of earlier versions.
+  int num_threads = 1;
+
+  // Whether the reverse search skips rooms that are equivalent to ones it has
+  // already expanded (see ReverseSolveRoom). Large searches finish sooner for
+  // a similar score, but levels differ from unpruned ones.
+  bool prune_search = false;
+
+  friend bool operator==(const Settings& lhs, const Settings& rhs) {
+    return std::tie(lhs.seed, lhs.width, lhs.height, lhs.num_boxes,
+                    lhs.room_steps, lhs.room_seed, lhs.targets_seed,
+                    lhs.actions_seed, lhs.max_room_configs, lhs.num_threads,
+                    lhs.prune_search) ==
+           std::tie(rhs.seed, rhs.width, rhs.height, rhs.num_boxes,
+                    rhs.room_steps, rhs.room_seed, rhs.targets_seed,
+                    rhs.actions_seed, rhs.max_room_configs, rhs.num_threads,
+                    rhs.prune_search);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const Settings& settings) {
+    return H::combine(std::move(h), settings.seed, settings.width,
+                      settings.height, settings.num_boxes,
+                      settings.room_steps, settings.room_seed,
+                      settings.targets_seed, settings.actions_seed,
+                      settings.max_room_configs, settings.num_threads,
+                      settings.prune_search);
+  }
 };
 
 struct ResultOr {
@@ -64,6 +103,20 @@ struct ResultOr {
   std::string error;
 };
 
+// Statistics of the search that produced a level.
+struct SearchStats {
+  // Number of box and player placements that were reverse-solved, including
+  // the successful one.
+  int attempts = 0;
+
+  // Room configurations visited by the reverse searches over all attempts.
+  std::int64_t rooms_visited = 0;
+
+  // Score and number of reverse actions of the returned level.
+  float score = 0;
+  int num_actions = 0;
+};
+
 // Generates and returns a Pushbox level (room, boxes and player in a valid
 // starting position). Returns an error if a valid solution wasn't found with
 // the passed in parameters.
@@ -79,8 +132,10 @@ struct ResultOr {
 //  - Return the position that obtained the higher score.
 //
 // Returns [level, error] containing either the generated level or an error
-// message of why the generation failed.
-ResultOr GenerateLevel(const Settings& settings);
+// message of why the generation failed. If `stats` is not null it receives
+// statistics of the search, also when generation fails.
+ResultOr GenerateLevel(const Settings& settings,
+                       SearchStats* stats = nullptr);
 
 }  // namespace deepmind::lab2d::pushbox
 
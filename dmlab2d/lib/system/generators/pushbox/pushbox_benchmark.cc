@@ -0,0 +1,119 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+#include "dmlab2d/lib/system/generators/pushbox/random_room_generator.h"
+#include "dmlab2d/lib/system/generators/pushbox/reverse_solve.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+// Reverse search from a 14x14 room with 4 boxes, visiting up to
+// state.range(0) rooms on state.range(1) threads. Reports the mean score of
+// the rooms found.
+void BM_ReverseSolveRoom(benchmark::State& state) {
+  const int max_room_configs = state.range(0);
+  const int num_threads = state.range(1);
+  RandomRoomGenerator room_generator(
+      /*width=*/14, /*height=*/14, /*num_targets=*/4, /*gen_steps=*/30,
+      generator::kDirectionChangeRatio, /*room_seed=*/1, /*positions_seed=*/2);
+  std::vector<TileType> topology = *room_generator.GenerateRoomTopology();
+  absl::optional<Room> base_room =
+      room_generator.UpdateBoxAndPlayerPositions(absl::MakeSpan(topology));
+  if (!base_room) {
+    state.SkipWithError("Failed to generate base room");
+    return;
+  }
+  std::mt19937_64 rng(3);
+  double total_score = 0;
+  for (auto _ : state) {
+    auto room =
+        ParallelReverseSolveRoom(*base_room, &rng, max_room_configs,
+                                 generator::kMaxAppliedActions, num_threads);
+    if (room) total_score += room->room_score();
+  }
+  state.counters["score"] =
+      benchmark::Counter(total_score, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ReverseSolveRoom)
+    ->ArgsProduct({{1000, 10000, 100000}, {1, 2, 4}})
+    ->UseRealTime();
+
+// Reverse search with and without pruning (state.range(1)) over 16 base rooms
+// of 14x14 cells with 4 boxes, visiting up to state.range(0) rooms each.
+// Reports the mean score and the total score per second of CPU time.
+void BM_ReverseSolveRoomPruning(benchmark::State& state) {
+  const int max_room_configs = state.range(0);
+  const bool prune = state.range(1);
+  // Rooms refer to the topology and Zobrist bitstrings of their generator,
+  // which must therefore stay in place.
+  std::deque<RandomRoomGenerator> room_generators;
+  std::deque<std::vector<TileType>> topologies;
+  std::vector<Room> base_rooms;
+  for (int seed = 0; seed < 16; ++seed) {
+    auto& room_generator = room_generators.emplace_back(
+        /*width=*/14, /*height=*/14, /*num_targets=*/4, /*gen_steps=*/30,
+        generator::kDirectionChangeRatio, /*room_seed=*/seed,
+        /*positions_seed=*/seed);
+    auto topology = room_generator.GenerateRoomTopology();
+    if (!topology) continue;
+    topologies.push_back(std::move(*topology));
+    if (auto room = room_generator.UpdateBoxAndPlayerPositions(
+            absl::MakeSpan(topologies.back()))) {
+      base_rooms.push_back(std::move(*room));
+    }
+  }
+  std::mt19937_64 rng(3);
+  double total_score = 0;
+  for (auto _ : state) {
+    for (const Room& base_room : base_rooms) {
+      auto room = ReverseSolveRoom(base_room, &rng, max_room_configs,
+                                   generator::kMaxAppliedActions, prune);
+      if (room) total_score += room->room_score();
+    }
+  }
+  state.counters["score"] = benchmark::Counter(
+      total_score / base_rooms.size(), benchmark::Counter::kAvgIterations);
+  state.counters["score_per_cpu_s"] =
+      benchmark::Counter(total_score, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_ReverseSolveRoomPruning)
+    ->ArgsProduct({{1000, 10000, 100000}, {0, 1}});
+
+// Generates 10x10 levels with 3 boxes using state.range(0) threads.
+void BM_GenerateLevel(benchmark::State& state) {
+  Settings settings;
+  settings.num_threads = state.range(0);
+  for (auto _ : state) {
+    ++settings.seed;
+    benchmark::DoNotOptimize(GenerateLevel(settings));
+  }
+}
+
+BENCHMARK(BM_GenerateLevel)->Arg(1)->Arg(4)->UseRealTime();
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
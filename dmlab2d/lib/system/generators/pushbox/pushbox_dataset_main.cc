@@ -0,0 +1,263 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generates a dataset of Pushbox levels for a range of seeds on all cores.
+// Levels are deduplicated by CanonicalLevelHash and written in seed order to
+// shards named `<output>-NNNNN.txt` or `<output>-NNNNN.bin`.
+//
+// Text shards hold each level preceded by a `; seed=<seed> hash=<hash>` line
+// and followed by an empty line. Binary shards start with the magic "PBX1"
+// followed by one record per level: the seed as 4 little-endian bytes and the
+// level as written by EncodeLevel.
+//
+// A summary with throughput and search statistics is printed to stderr, and
+// `--stats_output` writes the statistics of every level as CSV.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
+#include "dmlab2d/lib/system/generators/pushbox/dataset.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+
+ABSL_FLAG(std::string, output, "", "Path prefix of the shards to write.");
+ABSL_FLAG(std::string, format, "text", "Shard format: 'text' or 'binary'.");
+ABSL_FLAG(std::uint64_t, shard_size, 100000, "Maximum levels per shard.");
+ABSL_FLAG(std::string, stats_output, "",
+          "Optional path of a CSV file receiving per-level statistics.");
+ABSL_FLAG(std::uint32_t, first_seed, 1, "Seed of the first level.");
+ABSL_FLAG(std::uint64_t, num_levels, 1000, "Number of seeds to generate.");
+ABSL_FLAG(int, num_threads, 0,
+          "Number of levels generated in parallel. 0 uses all cores.");
+ABSL_FLAG(bool, dedup, true, "Whether to drop duplicate levels.");
+ABSL_FLAG(int, width, 14, "Room width.");
+ABSL_FLAG(int, height, 14, "Room height.");
+ABSL_FLAG(int, num_boxes, 4, "Number of boxes.");
+ABSL_FLAG(int, room_steps, 20, "Room generation steps.");
+ABSL_FLAG(int, max_room_configs,
+          deepmind::lab2d::pushbox::generator::kMaxRoomConfigurations,
+          "Room configurations visited by each reverse search.");
+ABSL_FLAG(int, search_threads, 1, "Reverse searches run per level.");
+ABSL_FLAG(bool, prune_search, false,
+          "Whether the reverse search skips equivalent rooms.");
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+// Writes levels to numbered shards of at most `shard_size` levels.
+class ShardWriter {
+ public:
+  ShardWriter(std::string prefix, bool binary, std::uint64_t shard_size)
+      : prefix_(std::move(prefix)), binary_(binary), shard_size_(shard_size) {}
+
+  bool Write(std::uint32_t seed, std::uint64_t hash, const std::string& level,
+             std::string* error) {
+    if (levels_in_shard_ == 0 || levels_in_shard_ == shard_size_) {
+      if (!OpenNextShard(error)) return false;
+    }
+    if (binary_) {
+      record_.clear();
+      for (int i = 0; i < 4; ++i) {
+        record_.push_back(static_cast<char>(seed >> (8 * i)));
+      }
+      if (!EncodeLevel(level, &record_)) {
+        *error = absl::StrFormat("Cannot encode level for seed %u", seed);
+        return false;
+      }
+      file_.write(record_.data(), record_.size());
+    } else {
+      file_ << absl::StrFormat("; seed=%u hash=%016x\n%s\n\n", seed, hash,
+                               level);
+    }
+    ++levels_in_shard_;
+    if (!file_) {
+      *error = absl::StrFormat("Failed to write to %s", path_);
+      return false;
+    }
+    return true;
+  }
+
+  int num_shards() const { return num_shards_; }
+
+ private:
+  bool OpenNextShard(std::string* error) {
+    file_.close();
+    path_ = absl::StrFormat("%s-%05d.%s", prefix_, num_shards_,
+                            binary_ ? "bin" : "txt");
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (binary_) file_ << "PBX1";
+    if (!file_) {
+      *error = absl::StrFormat("Failed to open %s", path_);
+      return false;
+    }
+    ++num_shards_;
+    levels_in_shard_ = 0;
+    return true;
+  }
+
+  std::string prefix_;
+  bool binary_;
+  std::uint64_t shard_size_;
+  std::string path_;
+  std::ofstream file_;
+  std::string record_;
+  int num_shards_ = 0;
+  std::uint64_t levels_in_shard_ = 0;
+};
+
+// Running totals for the summary.
+struct Totals {
+  std::uint64_t levels = 0;
+  std::uint64_t duplicates = 0;
+  std::uint64_t failures = 0;
+  std::uint64_t attempts = 0;
+  std::uint64_t rooms_visited = 0;
+  double score = 0;
+  std::uint64_t num_actions = 0;
+  absl::Duration duration;
+  absl::Duration max_duration;
+};
+
+int Run() {
+  std::string output = absl::GetFlag(FLAGS_output);
+  if (output.empty()) {
+    absl::FPrintF(stderr, "Error - Missing --output\n");
+    return EXIT_FAILURE;
+  }
+  std::string format = absl::GetFlag(FLAGS_format);
+  if (format != "text" && format != "binary") {
+    absl::FPrintF(stderr, "Error - Unknown --format '%s'\n", format);
+    return EXIT_FAILURE;
+  }
+  if (absl::GetFlag(FLAGS_shard_size) == 0) {
+    absl::FPrintF(stderr, "Error - --shard_size must be positive\n");
+    return EXIT_FAILURE;
+  }
+  std::ofstream stats_file;
+  if (std::string path = absl::GetFlag(FLAGS_stats_output); !path.empty()) {
+    stats_file.open(path, std::ios::trunc);
+    if (!stats_file) {
+      absl::FPrintF(stderr, "Error - Failed to open %s\n", path);
+      return EXIT_FAILURE;
+    }
+    stats_file << "seed,hash,status,attempts,rooms_visited,score,num_actions,"
+                  "micros\n";
+  }
+
+  Settings settings;
+  settings.width = absl::GetFlag(FLAGS_width);
+  settings.height = absl::GetFlag(FLAGS_height);
+  settings.num_boxes = absl::GetFlag(FLAGS_num_boxes);
+  settings.room_steps = absl::GetFlag(FLAGS_room_steps);
+  settings.max_room_configs = absl::GetFlag(FLAGS_max_room_configs);
+  settings.num_threads = absl::GetFlag(FLAGS_search_threads);
+  settings.prune_search = absl::GetFlag(FLAGS_prune_search);
+  int num_threads = absl::GetFlag(FLAGS_num_threads);
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+  }
+
+  ShardWriter writer(output, format == "binary",
+                     absl::GetFlag(FLAGS_shard_size));
+  const bool dedup = absl::GetFlag(FLAGS_dedup);
+  absl::flat_hash_set<std::uint64_t> seen;
+  Totals totals;
+  std::string error;
+  const absl::Time start = absl::Now();
+  GenerateDataset(
+      settings, absl::GetFlag(FLAGS_first_seed),
+      absl::GetFlag(FLAGS_num_levels), num_threads, [&](DatasetLevel level) {
+        if (!error.empty()) return;
+        const auto& stats = level.stats;
+        totals.attempts += stats.attempts;
+        totals.rooms_visited += stats.rooms_visited;
+        totals.duration += level.duration;
+        totals.max_duration = std::max(totals.max_duration, level.duration);
+        std::uint64_t hash = 0;
+        const char* status;
+        if (!level.result.error.empty()) {
+          ++totals.failures;
+          status = "failed";
+        } else {
+          hash = CanonicalLevelHash(level.result.level);
+          if (dedup && !seen.insert(hash).second) {
+            ++totals.duplicates;
+            status = "duplicate";
+          } else {
+            ++totals.levels;
+            totals.score += stats.score;
+            totals.num_actions += stats.num_actions;
+            status = "ok";
+            writer.Write(level.seed, hash, level.result.level, &error);
+          }
+        }
+        if (stats_file.is_open()) {
+          stats_file << absl::StrFormat(
+              "%u,%016x,%s,%d,%d,%g,%d,%d\n", level.seed, hash, status,
+              stats.attempts, stats.rooms_visited, stats.score,
+              stats.num_actions, absl::ToInt64Microseconds(level.duration));
+        }
+      });
+  if (!error.empty()) {
+    absl::FPrintF(stderr, "Error - %s\n", error);
+    return EXIT_FAILURE;
+  }
+
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+  const std::uint64_t generated =
+      totals.levels + totals.duplicates + totals.failures;
+  const double per_seed = generated > 0 ? 1.0 / generated : 0.0;
+  const double per_level = totals.levels > 0 ? 1.0 / totals.levels : 0.0;
+  absl::FPrintF(stderr,
+                "Wrote %d levels to %d shards (%d duplicates, %d failures) "
+                "in %.2fs on %d threads: %.1f levels/s.\n",
+                totals.levels, writer.num_shards(), totals.duplicates,
+                totals.failures, seconds, num_threads,
+                seconds > 0 ? generated / seconds : 0.0);
+  absl::FPrintF(
+      stderr,
+      "Per seed: %.2f attempts, %.0f rooms visited, %.3fms mean, %.3fms max.\n",
+      totals.attempts * per_seed, totals.rooms_visited * per_seed,
+      absl::ToDoubleMilliseconds(totals.duration) * per_seed,
+      absl::ToDoubleMilliseconds(totals.max_duration));
+  absl::FPrintF(stderr, "Per level written: %.1f score, %.1f actions.\n",
+                totals.score * per_level, totals.num_actions * per_level);
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Generates a dataset of Pushbox levels.\n"
+      "Usage: pushbox_dataset --output=<prefix> [--first_seed=<n>] "
+      "[--num_levels=<n>] [--format=text|binary]");
+  absl::ParseCommandLine(argc, argv);
+  return deepmind::lab2d::pushbox::Run();
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/reverse_solve.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/packed_room.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+#include "dmlab2d/lib/system/generators/pushbox/room_candidate_generator.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+// Capacity for the visited set. The search stops once `max_room_configs` rooms
+// have been visited, having added at most the candidates of one room: each box
+// pulled in one of four directions.
+int MaxVisitedRooms(const Room& base_room, int max_room_configs) {
+  return max_room_configs + 4 * base_room.GetBoxes().size();
+}
+
+}  // namespace
+
+absl::optional<Room> ReverseSolveRoom(const Room& base_room,
+                                      std::mt19937_64* rng,
+                                      int max_room_configs,
+                                      int max_action_depth, bool prune,
+                                      int* rooms_visited) {
+  // Set of rooms that we have already visited.
+  absl::flat_hash_set<std::uint64_t> visited_rooms(
+      MaxVisitedRooms(base_room, max_room_configs));
+
+  // Rooms are searched in packed form; only the best one is unpacked.
+  RoomPacker packer(base_room);
+  PackedRoomBuffer pending_rooms(packer.num_boxes());
+  const int room_size = pending_rooms.room_size();
+
+  // Keep track of the room with the highest score so far.
+  double highest_score = 0;
+  std::vector<std::uint16_t> highest_score_room;
+
+  // A list of pending rooms on which we haven't applied actions yet.
+  std::vector<std::uint16_t> current_room(room_size);
+  packer.Pack(base_room, current_room.data());
+  pending_rooms.Append(current_room.data());
+
+  RoomCandidateGenerator generator(base_room);
+
+  // Placements of boxes and player regions that have been expanded, used when
+  // pruning.
+  absl::flat_hash_set<std::uint64_t> expanded_rooms;
+
+  PackedRoomBuffer room_candidates(packer.num_boxes());
+  std::vector<int> candidate_order;
+  while (!pending_rooms.empty() && visited_rooms.size() < max_room_configs) {
+    // Get the next pending room to apply actions to.
+    std::copy_n(pending_rooms.back(), room_size, current_room.begin());
+    pending_rooms.PopBack();
+
+    room_candidates.clear();
+    generator.GenerateRoomCandidates(current_room.data(), &room_candidates);
+    if (prune) {
+      auto region_hash = packer.HashWithPlayer(
+          current_room.data(), generator.first_accessible_location());
+      if (!expanded_rooms.insert(region_hash).second) continue;
+    }
+    candidate_order.resize(room_candidates.size());
+    std::iota(candidate_order.begin(), candidate_order.end(), 0);
+    std::shuffle(candidate_order.begin(), candidate_order.end(), *rng);
+
+    for (int candidate_index : candidate_order) {
+      const std::uint16_t* new_room = room_candidates[candidate_index];
+      // Avoid going beyond the limit of applied actions.
+      if (new_room[PackedRoomBuffer::kNumActions] >= max_action_depth) {
+        continue;
+      }
+
+      // If we havent explore this room configuration yet add it to the
+      // pending and visited room lists.
+      auto hash = packer.Hash(new_room);
+      auto iter_insert = visited_rooms.insert(hash);
+      if (iter_insert.second) {
+        auto score = packer.Score(new_room);
+        if (score > highest_score) {
+          highest_score = score;
+          highest_score_room.assign(new_room, new_room + room_size);
+        }
+        pending_rooms.Append(new_room);
+      }
+    }
+  }
+
+  if (rooms_visited != nullptr) *rooms_visited = visited_rooms.size();
+
+  Room room = highest_score_room.empty()
+                  ? base_room
+                  : packer.Unpack(highest_score_room.data());
+  generator.MovePlayerToRandomAccessiblePosition(rng, &room);
+
+  if (room.room_score() == 0) return absl::nullopt;
+
+  return room;
+}
+
+absl::optional<Room> ParallelReverseSolveRoom(const Room& base_room,
+                                              std::mt19937_64* rng,
+                                              int max_room_configs,
+                                              int max_action_depth,
+                                              int num_threads, bool prune,
+                                              int* rooms_visited) {
+  num_threads = std::max(num_threads, 1);
+
+  // Seed the additional searches without advancing `rng`.
+  std::mt19937_64 seeder = *rng;
+  const std::uint64_t base_seed = seeder();
+  std::vector<std::mt19937_64> rngs;
+  rngs.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    std::seed_seq seed_seq{static_cast<std::uint32_t>(base_seed),
+                           static_cast<std::uint32_t>(base_seed >> 32),
+                           static_cast<std::uint32_t>(i)};
+    rngs.emplace_back(seed_seq);
+  }
+
+  std::vector<absl::optional<Room>> rooms(num_threads);
+  std::vector<int> visited(num_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back([&, i] {
+      rooms[i] = ReverseSolveRoom(base_room, &rngs[i - 1], max_room_configs,
+                                  max_action_depth, prune, &visited[i]);
+    });
+  }
+  rooms[0] = ReverseSolveRoom(base_room, rng, max_room_configs,
+                              max_action_depth, prune, &visited[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (rooms_visited != nullptr) {
+    *rooms_visited = std::accumulate(visited.begin(), visited.end(), 0);
+  }
+
+  absl::optional<Room>* best = &rooms[0];
+  for (auto& room : rooms) {
+    if (room && (!*best || room->room_score() > (*best)->room_score())) {
+      best = &room;
+    }
+  }
+  return std::move(*best);
+}
+
+}  // namespace deepmind::lab2d::pushbox
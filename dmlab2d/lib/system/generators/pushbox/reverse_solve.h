@@ -0,0 +1,66 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reverse search used to turn a solved Pushbox room into a starting position.
+
+#ifndef DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_REVERSE_SOLVE_H_
+#define DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_REVERSE_SOLVE_H_
+
+#include <random>
+
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+
+namespace deepmind::lab2d::pushbox {
+
+// Generates a starting point for a Pushbox level by reverse application of
+// actions from a base position. Returns absl::nullopt if it wasn't able to get
+// to a room position with score > 0 or the room configuration with highest
+// obtained score otherwise.
+// The received random number generator (rng) is used for randomly ordering the
+// set of applicable actions.
+// The max_room_configs parameter indicates how many possible configurations
+// from the base positions we may try.
+// The max_action_depth parameter indicates the maximum length of the sequence
+// of actions applied when exploring new room configurations (i.e. the search
+// depth).
+// With prune set, rooms whose boxes are placed the same and whose players can
+// reach each other are only expanded once, as they have the same candidates.
+// Levels differ from those found without pruning.
+// If `rooms_visited` is not null it receives the number of room configurations
+// visited.
+absl::optional<Room> ReverseSolveRoom(const Room& base_room,
+                                      std::mt19937_64* rng,
+                                      int max_room_configs,
+                                      int max_action_depth, bool prune = false,
+                                      int* rooms_visited = nullptr);
+
+// Multi-threaded variant of ReverseSolveRoom. Runs `num_threads` independent
+// searches, each with its own visited set and budget, and returns the room with
+// the highest score (the earliest search wins ties). The first search is
+// ReverseSolveRoom(base_room, rng, ...) itself and the others use generators
+// seeded from a copy of `rng`, so the result never scores lower than the
+// single-threaded one and depends only on `rng` and `num_threads`.
+// `rooms_visited` receives the total over all searches.
+absl::optional<Room> ParallelReverseSolveRoom(const Room& base_room,
+                                              std::mt19937_64* rng,
+                                              int max_room_configs,
+                                              int max_action_depth,
+                                              int num_threads,
+                                              bool prune = false,
+                                              int* rooms_visited = nullptr);
+
+}  // namespace deepmind::lab2d::pushbox
+
+#endif  // DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_REVERSE_SOLVE_H_
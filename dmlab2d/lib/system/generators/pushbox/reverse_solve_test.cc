@@ -0,0 +1,117 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dmlab2d/lib/system/generators/pushbox/reverse_solve.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/generators/pushbox/constants.h"
+#include "dmlab2d/lib/system/generators/pushbox/pushbox.h"
+#include "dmlab2d/lib/system/generators/pushbox/random_room_generator.h"
+#include "dmlab2d/lib/system/generators/pushbox/room.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::pushbox {
+namespace {
+
+class ReverseSolveTest : public ::testing::Test {
+ protected:
+  ReverseSolveTest()
+      : room_generator_(/*width=*/10, /*height=*/10, /*num_targets=*/3,
+                        /*gen_steps=*/20, generator::kDirectionChangeRatio,
+                        /*room_seed=*/1, /*positions_seed=*/2) {
+    topology_ = *room_generator_.GenerateRoomTopology();
+    base_room_ = room_generator_.UpdateBoxAndPlayerPositions(
+        absl::MakeSpan(topology_));
+  }
+
+  RandomRoomGenerator room_generator_;
+  std::vector<TileType> topology_;
+  absl::optional<Room> base_room_;
+};
+
+TEST_F(ReverseSolveTest, ParallelScoresAtLeastSequential) {
+  ASSERT_TRUE(base_room_.has_value());
+  for (int seed = 0; seed < 5; ++seed) {
+    std::mt19937_64 rng1(seed);
+    auto sequential = ReverseSolveRoom(*base_room_, &rng1, 1000,
+                                       generator::kMaxAppliedActions);
+    std::mt19937_64 rng2(seed);
+    auto parallel = ParallelReverseSolveRoom(
+        *base_room_, &rng2, 1000, generator::kMaxAppliedActions, 4);
+    ASSERT_TRUE(sequential.has_value());
+    ASSERT_TRUE(parallel.has_value());
+    EXPECT_GE(parallel->room_score(), sequential->room_score());
+  }
+}
+
+TEST_F(ReverseSolveTest, ParallelWithOneThreadMatchesSequential) {
+  ASSERT_TRUE(base_room_.has_value());
+  std::mt19937_64 rng1(3);
+  auto sequential = ReverseSolveRoom(*base_room_, &rng1, 1000,
+                                     generator::kMaxAppliedActions);
+  std::mt19937_64 rng2(3);
+  auto parallel = ParallelReverseSolveRoom(*base_room_, &rng2, 1000,
+                                           generator::kMaxAppliedActions, 1);
+  ASSERT_TRUE(sequential.has_value());
+  ASSERT_TRUE(parallel.has_value());
+  EXPECT_EQ(parallel->ToString(), sequential->ToString());
+}
+
+TEST_F(ReverseSolveTest, PruningSkipsEquivalentRooms) {
+  ASSERT_TRUE(base_room_.has_value());
+  int visited = 0;
+  int pruned_visited = 0;
+  std::mt19937_64 rng1(5);
+  auto room = ReverseSolveRoom(*base_room_, &rng1, 100000,
+                               generator::kMaxAppliedActions,
+                               /*prune=*/false, &visited);
+  std::mt19937_64 rng2(5);
+  auto pruned_room = ReverseSolveRoom(*base_room_, &rng2, 100000,
+                                      generator::kMaxAppliedActions,
+                                      /*prune=*/true, &pruned_visited);
+  ASSERT_TRUE(room.has_value());
+  ASSERT_TRUE(pruned_room.has_value());
+  // The budget is large enough to exhaust the search either way.
+  EXPECT_LT(visited, 100000);
+  EXPECT_LE(pruned_visited, visited);
+  EXPECT_GT(pruned_room->room_score(), 0);
+}
+
+TEST(GenerateLevelTest, ParallelLevelIsDeterministic) {
+  Settings settings;
+  settings.seed = 9;
+  settings.num_threads = 3;
+  auto level1 = GenerateLevel(settings);
+  auto level2 = GenerateLevel(settings);
+  ASSERT_EQ(level1.error, "");
+  EXPECT_EQ(level1.level, level2.level);
+}
+
+TEST(GenerateLevelTest, RejectsInvalidSearchSettings) {
+  Settings settings;
+  settings.seed = 9;
+  settings.num_threads = 0;
+  EXPECT_NE(GenerateLevel(settings).error, "");
+  settings.num_threads = 1;
+  settings.max_room_configs = 0;
+  EXPECT_NE(GenerateLevel(settings).error, "");
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::pushbox
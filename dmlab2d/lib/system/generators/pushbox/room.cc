@@ -139,6 +139,24 @@ void Room::AddBox(const math::Vector2d& position) {
   boxes_.push_back(Box(position));
 }
 
+void Room::RestoreState(const math::Vector2d& player_position,
+                        absl::Span<const math::Vector2d> box_positions,
+                        int num_actions, int last_box_index,
+                        int moved_box_changes) {
+  CHECK_EQ(box_positions.size(), boxes_.size());
+  for (int i = 0; i < boxes_.size(); ++i) {
+    ZobristAddOrRemovePiece(boxes_[i].position(), EntityLayer::kBox);
+    ZobristAddOrRemovePiece(box_positions[i], EntityLayer::kBox);
+    boxes_[i].set_position(box_positions[i]);
+  }
+  ZobristAddOrRemovePiece(player_.position(), EntityLayer::kPlayer);
+  ZobristAddOrRemovePiece(player_position, EntityLayer::kPlayer);
+  player_.set_position(player_position);
+  num_actions_ = num_actions;
+  last_box_index_ = last_box_index;
+  moved_box_changes_ = moved_box_changes;
+}
+
 void Room::ApplyAction(const Action& action) {
   // Move the player to its new position.
   const auto initial_player_position = player_.position();
@@ -59,6 +59,9 @@ class Entity {
   void set_position(const math::Vector2d& position) { position_ = position; }
   const math::Vector2d& position() const { return position_; }
 
+  // Get the position the entity was created at.
+  const math::Vector2d& initial_position() const { return initial_position_; }
+
   // Displacement from the original position.
   float Displacement() const {
     // Return Manhattan distance.
@@ -154,6 +157,14 @@ class Room {
   // Add an additional box in the given position.
   void AddBox(const math::Vector2d& position);
 
+  // Overwrites the player and box positions and the action statistics, e.g.
+  // to restore a room from a packed search state. `box_positions` holds the
+  // new position of each box returned by GetBoxes(), in the same order. The
+  // score must be recomputed afterwards.
+  void RestoreState(const math::Vector2d& player_position,
+                    absl::Span<const math::Vector2d> box_positions,
+                    int num_actions, int last_box_index, int moved_box_changes);
+
   // Applies an action to the player and to an adjacent box as well if the
   // action involves pulling.
   // Note the CanApplyAction must be called beforehand to ensure that the action
@@ -169,6 +180,12 @@ class Room {
   // Get the number of actions applied to this room.
   int num_actions() const { return num_actions_; }
 
+  // Get the index of the last moved box, or -1 if no box was moved.
+  int last_box_index() const { return last_box_index_; }
+
+  // Get the number of times the box being moved has changed.
+  int moved_box_changes() const { return moved_box_changes_; }
+
   // Returns true if the player is on top of a target.
   bool PlayerOnTarget() { return IsTarget(player_.position()); }
 
@@ -184,6 +201,15 @@ class Room {
   // Returns room height.
   int height() const { return height_; }
 
+  // Returns the tiles of the room in row-major order.
+  absl::Span<const TileType> topology() const { return topology_; }
+
+  // Returns the Zobrist bitstrings used for hashing: one per cell for the
+  // player followed by one per cell for boxes.
+  absl::Span<const std::uint64_t> zobrist_bitstrings() const {
+    return zobrist_bitstrings_;
+  }
+
  private:
   // Applies the given action to the player (i.e. changes the player position).
   // Note the CanApplyAction must be called beforehand to ensure that the action
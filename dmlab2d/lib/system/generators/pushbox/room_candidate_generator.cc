@@ -14,9 +14,12 @@
 
 #include "dmlab2d/lib/system/generators/pushbox/room_candidate_generator.h"
 
-#include <utility>
+#include <algorithm>
+#include <cstdint>
 
 #include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/generators/pushbox/packed_room.h"
 
 namespace deepmind::lab2d::pushbox {
 
@@ -24,6 +27,7 @@ RoomCandidateGenerator::RoomCandidateGenerator(const Room& base_room)
     : width_(base_room.width()),
       height_(base_room.height()),
       last_visited_index_(std::numeric_limits<int>::min()),
+      first_accessible_location_(0),
       actions_{{{{{-1, 0}, true}, -1},
                 {{{1, 0}, true}, 1},
                 {{{0, -1}, true}, -width_},
@@ -42,38 +46,44 @@ RoomCandidateGenerator::RoomCandidateGenerator(const Room& base_room)
 }
 
 void RoomCandidateGenerator::GenerateRoomCandidates(
-    const Room& room, std::vector<Room>* candidates) {
+    const std::uint16_t* room, PackedRoomBuffer* candidates) {
   // Increment last visited index so the layout can be reused again without
   // cleaning up.
   ++last_visited_index_;
   CHECK_LT(last_visited_index_, kBox);
 
-  SetBoxPositions(room.GetBoxes());
+  absl::Span<const std::uint16_t> box_cells(room + PackedRoomBuffer::kBoxes,
+                                            candidates->num_boxes());
+  SetBoxPositions(box_cells);
 
   // Flood fill room layout with last_visited_index so we can find all
   // accessible positions.
-  FloodFillRoom(room.GetPlayerPosition());
+  FloodFillRoom(room[PackedRoomBuffer::kPlayer]);
 
-  for (const auto& box : room.GetBoxes()) {
-    int box_location = location(box.position());
+  for (int box_index = 0; box_index < box_cells.size(); ++box_index) {
+    int box_location = box_cells[box_index];
     for (const auto& action : actions_) {
       if (layout_[box_location + action.offset] == last_visited_index_ &&
           layout_[box_location + 2 * action.offset] == last_visited_index_) {
+        // The player stands next to the box and pulls it one step, ending up
+        // two cells away from the box's original location.
         int player_location = box_location + action.offset;
-        Room room_candidate = room;
-
-        room_candidate.SetPlayerPosition(
-            {player_location % width_, player_location / width_});
-        room_candidate.ApplyAction(action.player_action);
-
-        candidates->emplace_back(std::move(room_candidate));
+        std::uint16_t* candidate = candidates->Append(room);
+        candidate[PackedRoomBuffer::kPlayer] =
+            player_location + action.offset;
+        candidate[PackedRoomBuffer::kBoxes + box_index] = player_location;
+        ++candidate[PackedRoomBuffer::kNumActions];
+        if (candidate[PackedRoomBuffer::kLastBox] != box_index + 1) {
+          candidate[PackedRoomBuffer::kLastBox] = box_index + 1;
+          ++candidate[PackedRoomBuffer::kBoxChanges];
+        }
       }
     }
   }
 
   // Clean box positions in the room layout so it can be reused for other
   // rooms.
-  ClearBoxPositions(room.GetBoxes());
+  ClearBoxPositions(box_cells);
 }
 
 void RoomCandidateGenerator::MovePlayerToRandomAccessiblePosition(
@@ -107,6 +117,13 @@ void RoomCandidateGenerator::SetBoxPositions(const std::vector<Box>& boxes) {
   }
 }
 
+void RoomCandidateGenerator::SetBoxPositions(
+    absl::Span<const std::uint16_t> box_cells) {
+  for (int box_location : box_cells) {
+    layout_[box_location] = kBox;
+  }
+}
+
 void RoomCandidateGenerator::ClearBoxPositions(const std::vector<Box>& boxes) {
   for (const auto& box : boxes) {
     // Mark all box locations as not visited to another room boxes could be
@@ -115,13 +132,25 @@ void RoomCandidateGenerator::ClearBoxPositions(const std::vector<Box>& boxes) {
   }
 }
 
+void RoomCandidateGenerator::ClearBoxPositions(
+    absl::Span<const std::uint16_t> box_cells) {
+  for (int box_location : box_cells) {
+    layout_[box_location] = last_visited_index_;
+  }
+}
+
 void RoomCandidateGenerator::FloodFillRoom(
     const math::Vector2d& player_position) {
+  FloodFillRoom(location(player_position));
+}
+
+void RoomCandidateGenerator::FloodFillRoom(int player_location) {
   flood_fill_candidates_.clear();
   next_flood_fill_candidates_.clear();
 
-  layout_[location(player_position)] = last_visited_index_;
-  flood_fill_candidates_.push_back(location(player_position));
+  layout_[player_location] = last_visited_index_;
+  flood_fill_candidates_.push_back(player_location);
+  first_accessible_location_ = player_location;
 
   while (!flood_fill_candidates_.empty()) {
     for (int location : flood_fill_candidates_) {
@@ -129,6 +158,8 @@ void RoomCandidateGenerator::FloodFillRoom(
         int new_location = location + action.offset;
         if (layout_[new_location] < last_visited_index_) {
           layout_[new_location] = last_visited_index_;
+          first_accessible_location_ =
+              std::min(first_accessible_location_, new_location);
           next_flood_fill_candidates_.push_back(new_location);
         }
       }
@@ -16,11 +16,14 @@
 #define DMLAB2D_LIB_SYSTEM_GENERATORS_PUSHBOX_ROOM_CANDIDATE_GENERATOR_H_
 
 #include <array>
+#include <cstdint>
 #include <limits>
 #include <random>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/generators/pushbox/packed_room.h"
 #include "dmlab2d/lib/system/generators/pushbox/room.h"
 #include "dmlab2d/lib/system/math/math2d.h"
 
@@ -46,10 +49,17 @@ class RoomCandidateGenerator {
  public:
   explicit RoomCandidateGenerator(const Room& base_room);
 
-  // Generates a vector of room layout candidates for the next step. The room
-  // passed to this method is supposed to have the same walls layout as
-  // base_room used during construction.
-  void GenerateRoomCandidates(const Room& room, std::vector<Room>* candidates);
+  // Appends the packed room layout candidates for the next step to
+  // `candidates`. The packed room passed to this method is supposed to have
+  // the same walls layout as base_room used during construction and the same
+  // number of boxes as `candidates`.
+  void GenerateRoomCandidates(const std::uint16_t* room,
+                              PackedRoomBuffer* candidates);
+
+  // Returns the lowest location (x + y * width) the player could reach in the
+  // last room passed to GenerateRoomCandidates. Rooms with the same boxes
+  // share it exactly when their players can reach each other.
+  int first_accessible_location() const { return first_accessible_location_; }
 
   // Moves the player into a random position that can be accessed by the current
   // one without moving any boxes.
@@ -62,6 +72,9 @@ class RoomCandidateGenerator {
   // The index used to mark layout cells as visited.
   int last_visited_index_;
 
+  // See first_accessible_location().
+  int first_accessible_location_;
+
   // An array of possible actions and corresponding layout offsets.
   std::array<ActionOffset, 4> actions_;
 
@@ -83,10 +96,13 @@ class RoomCandidateGenerator {
   int location(const math::Vector2d& position) const;
 
   void SetBoxPositions(const std::vector<Box>& boxes);
+  void SetBoxPositions(absl::Span<const std::uint16_t> box_cells);
 
   void ClearBoxPositions(const std::vector<Box>& boxes);
+  void ClearBoxPositions(absl::Span<const std::uint16_t> box_cells);
 
   void FloodFillRoom(const math::Vector2d& player_position);
+  void FloodFillRoom(int player_location);
 
   math::Vector2d FindRandomAccessbilePosition(std::mt19937_64* rng) const;
 };
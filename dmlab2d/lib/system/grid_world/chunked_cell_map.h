@@ -0,0 +1,103 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DMLAB2D_LIB_SYSTEM_GRID_WORLD_CHUNKED_CELL_MAP_H_
+#define DMLAB2D_LIB_SYSTEM_GRID_WORLD_CHUNKED_CELL_MAP_H_
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/base/optimization.h"
+#include "absl/log/check.h"
+#include "dmlab2d/lib/system/grid_world/grid_shape.h"
+#include "dmlab2d/lib/system/grid_world/handles.h"
+
+namespace deepmind::lab2d {
+
+// Map of the cells of a GridShape to values of type `T`. Storage is allocated
+// a chunk at a time, when a cell of the chunk is first written; until then its
+// cells read as T(). A grid that is not chunked is allocated up front.
+template <typename T>
+class ChunkedCellMap {
+ public:
+  explicit ChunkedCellMap(const GridShape& shape)
+      : cell_bits_(shape.chunk_cell_bits()),
+        cell_mask_((1 << cell_bits_) - 1),
+        chunk_cell_count_(shape.chunk_cell_count()) {
+    CHECK_LE(shape.chunk_count() - 1,
+             std::numeric_limits<int>::max() >> cell_bits_)
+        << "Grid too large for cell-indices";
+    if (shape.chunked()) {
+      empty_chunk_ = std::make_unique<T[]>(chunk_cell_count_);
+    }
+    chunks_.assign(shape.chunk_count(), empty_chunk_.get());
+    if (!shape.chunked()) {
+      Allocate(&chunks_.front());
+      dense_ = chunks_.front();
+    }
+  }
+
+  const T& operator[](CellIndex cell) const {
+    const int value = cell.Value();
+    if (dense_ != nullptr) {
+      return dense_[value];
+    }
+    return chunks_[value >> cell_bits_][value & cell_mask_];
+  }
+
+  // Returns `cell` for writing, allocating its chunk if needed. Must not be
+  // called concurrently, even for cells in different chunks.
+  T& Mutable(CellIndex cell) {
+    const int value = cell.Value();
+    if (dense_ != nullptr) {
+      return dense_[value];
+    }
+    T*& chunk = chunks_[value >> cell_bits_];
+    if (ABSL_PREDICT_FALSE(chunk == empty_chunk_.get())) {
+      Allocate(&chunk);
+    }
+    return chunk[value & cell_mask_];
+  }
+
+  // Returns whether `chunk` has storage. Cells of other chunks read as T().
+  bool IsAllocated(int chunk) const {
+    return chunks_[chunk] != empty_chunk_.get();
+  }
+
+  // Returns the number of chunks with storage.
+  int NumAllocatedChunks() const { return storage_.size(); }
+
+ private:
+  void Allocate(T** chunk) {
+    storage_.push_back(std::make_unique<T[]>(chunk_cell_count_));
+    *chunk = storage_.back().get();
+  }
+
+  // The only chunk of a grid that is not chunked, otherwise null.
+  T* dense_ = nullptr;
+  int cell_bits_;
+  int cell_mask_;
+  int chunk_cell_count_;
+  // Shared by all chunks without storage. Never written.
+  std::unique_ptr<T[]> empty_chunk_;
+  std::vector<std::unique_ptr<T[]>> storage_;
+  std::vector<T*> chunks_;
+};
+
+}  // namespace deepmind::lab2d
+
+#endif  // DMLAB2D_LIB_SYSTEM_GRID_WORLD_CHUNKED_CELL_MAP_H_
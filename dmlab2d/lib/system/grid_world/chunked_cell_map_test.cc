@@ -0,0 +1,72 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/grid_world/chunked_cell_map.h"
+
+#include "dmlab2d/lib/system/grid_world/grid_shape.h"
+#include "dmlab2d/lib/system/grid_world/handles.h"
+#include "dmlab2d/lib/system/math/math2d.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+using ::testing::Eq;
+
+TEST(ChunkedCellMapTest, AllocatesSmallGridUpFront) {
+  const GridShape shape(math::Size2d{5, 3}, /*layer_count=*/2,
+                        GridShape::Topology::kBounded);
+  ChunkedCellMap<int> map(shape);
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(1));
+  const CellIndex cell = shape.ToCellIndex({4, 2}, Layer(1));
+  EXPECT_THAT(map[cell], Eq(0));
+  map.Mutable(cell) = 7;
+  EXPECT_THAT(map[cell], Eq(7));
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(1));
+  EXPECT_TRUE(map.IsAllocated(0));
+}
+
+TEST(ChunkedCellMapTest, AllocatesChunksOnWrite) {
+  const GridShape shape(math::Size2d{4096, 4096}, /*layer_count=*/4,
+                        GridShape::Topology::kTorus);
+  ChunkedCellMap<int> map(shape);
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(0));
+
+  const CellIndex cell = shape.ToCellIndex({1000, 2000}, Layer(3));
+  const CellIndex neighbour = shape.ToCellIndex({1001, 2000}, Layer(3));
+  const CellIndex far = shape.ToCellIndex({-1, -1}, Layer(0));
+  EXPECT_THAT(map[cell], Eq(0));
+  EXPECT_THAT(map[far], Eq(0));
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(0));
+
+  const int chunk = cell.Value() >> shape.chunk_cell_bits();
+  EXPECT_FALSE(map.IsAllocated(chunk));
+  map.Mutable(cell) = 1;
+  map.Mutable(neighbour) = 2;
+  EXPECT_TRUE(map.IsAllocated(chunk));
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(1));
+  map.Mutable(far) = 3;
+  EXPECT_THAT(map.NumAllocatedChunks(), Eq(2));
+
+  EXPECT_THAT(map[cell], Eq(1));
+  EXPECT_THAT(map[neighbour], Eq(2));
+  EXPECT_THAT(map[shape.ToCellIndex({4095, 4095}, Layer(0))], Eq(3));
+  EXPECT_THAT(map[shape.ToCellIndex({1000, 2000}, Layer(2))], Eq(0));
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d
@@ -48,6 +48,10 @@ class ShuffledSet {
     data_.erase(std::remove(data_.begin(), data_.end(), element), data_.end());
   }
 
+  // Returns the elements in the set in an unspecified order. Calls to
+  // non-const members will invalidate the returned reference.
+  absl::Span<const T> Elements() const { return absl::MakeConstSpan(data_); }
+
   // Shuffles the elements in the set and returns a reference to them.
   // Calls to non-const members will invalidate the returned reference.
   absl::Span<const T> ShuffledElements(std::mt19937_64* rng) {
@@ -49,6 +49,7 @@ TEST(ShuffledSetTest, CanInsert) {
   EXPECT_THAT(set.IsEmpty(), Eq(false));
   set.Insert(2);
   EXPECT_THAT(set.NumElements(), Eq(2));
+  EXPECT_THAT(set.Elements(), UnorderedElementsAre(1, 2));
 }
 
 TEST(ShuffledSetTest, CanRemove) {
@@ -0,0 +1,118 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/grid_world/free_cell_index.h"
+
+#include "absl/log/check.h"
+#include "dmlab2d/lib/system/grid_world/handles.h"
+
+namespace deepmind::lab2d {
+
+void FreeCellIndex::Insert(Piece piece, int position, bool is_free) {
+  if (piece.Value() >= static_cast<int>(members_.size())) {
+    members_.resize(piece.Value() + 1);
+  }
+  Member& member = members_[piece.Value()];
+  DCHECK(!member.present) << piece << " is already a member.";
+  member.present = true;
+  member.position = position;
+  member.free_index = -1;
+  member.next = -1;
+  if (position < 0) {
+    return;
+  }
+  auto [it, inserted] = first_at_position_.try_emplace(position, -1);
+  member.next = it->second;
+  it->second = piece.Value();
+  if (is_free) {
+    AddFree(piece);
+  }
+}
+
+void FreeCellIndex::Erase(Piece piece) {
+  if (!Contains(piece)) {
+    return;
+  }
+  Member& member = members_[piece.Value()];
+  if (member.position >= 0) {
+    RemoveFree(piece);
+    auto it = first_at_position_.find(member.position);
+    DCHECK(it != first_at_position_.end());
+    int* link = &it->second;
+    while (*link != piece.Value()) {
+      link = &members_[*link].next;
+    }
+    *link = member.next;
+    if (it->second == -1) {
+      first_at_position_.erase(it);
+    }
+  }
+  member = Member();
+}
+
+int FreeCellIndex::FirstAtPosition(int position) const {
+  auto it = first_at_position_.find(position);
+  return it != first_at_position_.end() ? it->second : -1;
+}
+
+void FreeCellIndex::SetPositionFree(int position, bool is_free) {
+  for (int value = FirstAtPosition(position); value != -1;
+       value = members_[value].next) {
+    if (is_free) {
+      AddFree(Piece(value));
+    } else {
+      RemoveFree(Piece(value));
+    }
+  }
+}
+
+int FreeCellIndex::NumAtPosition(int position) const {
+  int count = 0;
+  for (int value = FirstAtPosition(position); value != -1;
+       value = members_[value].next) {
+    ++count;
+  }
+  return count;
+}
+
+Piece FreeCellIndex::AtPosition(int position, int n) const {
+  int value = FirstAtPosition(position);
+  for (; n > 0; --n) {
+    value = members_[value].next;
+  }
+  return Piece(value);
+}
+
+void FreeCellIndex::AddFree(Piece piece) {
+  Member& member = members_[piece.Value()];
+  if (member.free_index == -1) {
+    member.free_index = free_.size();
+    free_.push_back(piece);
+  }
+}
+
+void FreeCellIndex::RemoveFree(Piece piece) {
+  Member& member = members_[piece.Value()];
+  if (member.free_index != -1) {
+    Piece last = free_.back();
+    free_[member.free_index] = last;
+    members_[last.Value()].free_index = member.free_index;
+    free_.pop_back();
+    member.free_index = -1;
+  }
+}
+
+}  // namespace deepmind::lab2d
@@ -0,0 +1,98 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DMLAB2D_LIB_SYSTEM_GRID_WORLD_FREE_CELL_INDEX_H_
+#define DMLAB2D_LIB_SYSTEM_GRID_WORLD_FREE_CELL_INDEX_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "dmlab2d/lib/system/grid_world/handles.h"
+
+namespace deepmind::lab2d {
+
+// Tracks which members of a group stand on a position whose cell on a given
+// layer is empty, so that a random one of them can be picked in constant time.
+// Positions are non-negative indices supplied by the caller; the caller
+// reports every change of a member's position and of a position's occupancy.
+// Memory grows with the number of members, not with the number of positions.
+class FreeCellIndex {
+ public:
+  FreeCellIndex(Group group, Layer layer) : group_(group), layer_(layer) {}
+
+  Group group() const { return group_; }
+  Layer layer() const { return layer_; }
+
+  // Returns whether `piece` is a member.
+  bool Contains(Piece piece) const {
+    return piece.Value() < static_cast<int>(members_.size()) &&
+           members_[piece.Value()].present;
+  }
+
+  // Adds `piece` at `position`, or off the grid if `position` is negative.
+  // `is_free` is whether the cell at `position` is empty. `piece` must not be
+  // a member.
+  void Insert(Piece piece, int position, bool is_free);
+
+  // Removes `piece` if it is a member.
+  void Erase(Piece piece);
+
+  // Marks the cell at `position` as empty or occupied.
+  void SetPositionFree(int position, bool is_free);
+
+  // Returns the number of members on an empty cell.
+  std::size_t NumFree() const { return free_.size(); }
+
+  // Returns the number of members at `position`.
+  int NumAtPosition(int position) const;
+
+  // Returns the `n`th member at `position`. Requires n < NumAtPosition().
+  Piece AtPosition(int position, int n) const;
+
+  // Returns the member on an empty cell selected by `index`. Requires
+  // index < NumFree().
+  Piece Free(std::size_t index) const { return free_[index]; }
+
+ private:
+  struct Member {
+    bool present = false;
+    int position = -1;
+    // Index in `free_` or -1.
+    int free_index = -1;
+    // Next member at the same position or -1.
+    int next = -1;
+  };
+
+  // Returns the first member at `position`, or -1.
+  int FirstAtPosition(int position) const;
+
+  void AddFree(Piece piece);
+  void RemoveFree(Piece piece);
+
+  Group group_;
+  Layer layer_;
+  // Indexed by piece value.
+  std::vector<Member> members_;
+  // Head of the list of members at each position with members, linked by
+  // Member::next.
+  absl::flat_hash_map<int, int> first_at_position_;
+  std::vector<Piece> free_;
+};
+
+}  // namespace deepmind::lab2d
+
+#endif  // DMLAB2D_LIB_SYSTEM_GRID_WORLD_FREE_CELL_INDEX_H_
@@ -0,0 +1,99 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/grid_world/free_cell_index.h"
+
+#include <vector>
+
+#include "dmlab2d/lib/system/grid_world/handles.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+std::vector<Piece> FreePieces(const FreeCellIndex& index) {
+  std::vector<Piece> result;
+  for (std::size_t i = 0; i < index.NumFree(); ++i) {
+    result.push_back(index.Free(i));
+  }
+  return result;
+}
+
+TEST(FreeCellIndexTest, TracksMembers) {
+  FreeCellIndex index(Group(0), Layer(1));
+  EXPECT_EQ(index.group(), Group(0));
+  EXPECT_EQ(index.layer(), Layer(1));
+  index.Insert(Piece(3), /*position=*/0, /*is_free=*/true);
+  index.Insert(Piece(1), /*position=*/2, /*is_free=*/false);
+  index.Insert(Piece(5), /*position=*/-1, /*is_free=*/false);
+  EXPECT_TRUE(index.Contains(Piece(3)));
+  EXPECT_TRUE(index.Contains(Piece(5)));
+  EXPECT_FALSE(index.Contains(Piece(2)));
+  EXPECT_FALSE(index.Contains(Piece(10)));
+  EXPECT_THAT(FreePieces(index), ElementsAre(Piece(3)));
+
+  index.Erase(Piece(3));
+  index.Erase(Piece(5));
+  index.Erase(Piece(7));
+  EXPECT_FALSE(index.Contains(Piece(3)));
+  EXPECT_EQ(index.NumFree(), 0);
+  EXPECT_EQ(index.NumAtPosition(0), 0);
+  EXPECT_EQ(index.NumAtPosition(2), 1);
+}
+
+TEST(FreeCellIndexTest, FollowsOccupancy) {
+  FreeCellIndex index(Group(0), Layer(0));
+  index.Insert(Piece(0), /*position=*/1, /*is_free=*/false);
+  index.Insert(Piece(1), /*position=*/1, /*is_free=*/false);
+  index.Insert(Piece(2), /*position=*/3, /*is_free=*/true);
+  EXPECT_EQ(index.NumAtPosition(1), 2);
+  EXPECT_THAT((std::vector<Piece>{index.AtPosition(1, 0),
+                                  index.AtPosition(1, 1)}),
+              UnorderedElementsAre(Piece(0), Piece(1)));
+
+  index.SetPositionFree(1, true);
+  EXPECT_THAT(FreePieces(index),
+              UnorderedElementsAre(Piece(0), Piece(1), Piece(2)));
+  index.SetPositionFree(1, true);
+  EXPECT_EQ(index.NumFree(), 3);
+  index.SetPositionFree(3, false);
+  EXPECT_THAT(FreePieces(index), UnorderedElementsAre(Piece(0), Piece(1)));
+  index.Erase(Piece(0));
+  EXPECT_THAT(FreePieces(index), ElementsAre(Piece(1)));
+  EXPECT_EQ(index.NumAtPosition(1), 1);
+  index.SetPositionFree(0, false);
+  EXPECT_THAT(FreePieces(index), ElementsAre(Piece(1)));
+}
+
+TEST(FreeCellIndexTest, AcceptsLargePositions) {
+  FreeCellIndex index(Group(0), Layer(0));
+  constexpr int kPosition = 4096 * 4096 - 1;
+  index.Insert(Piece(0), kPosition, /*is_free=*/false);
+  EXPECT_EQ(index.NumAtPosition(kPosition), 1);
+  EXPECT_EQ(index.NumAtPosition(0), 0);
+  index.SetPositionFree(kPosition, true);
+  EXPECT_THAT(FreePieces(index), ElementsAre(Piece(0)));
+  index.Erase(Piece(0));
+  EXPECT_EQ(index.NumAtPosition(kPosition), 0);
+  EXPECT_EQ(index.NumFree(), 0);
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d
@@ -17,7 +17,9 @@
 #include "dmlab2d/lib/system/grid_world/grid.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <random>
 #include <utility>
@@ -38,19 +40,22 @@ namespace {
 // Calls `func` on elements in `queue` in order. If the call returns true the
 // element is removed from the queue. Otherwise the elements will remain in the
 // queue for future processing. `func` is allowed to add entries to `queue`
-// while processing but will not be processed until next call.
+// while processing but will not be processed until next call. `processing` is
+// scratch space whose capacity is swapped into `queue`, so that neither
+// allocates once both have grown.
 template <typename T, typename F>
-void ProcessQueue(std::vector<T>* queue, F func) {
+void ProcessQueue(std::vector<T>* queue, std::vector<T>* processing, F func) {
   if (queue->empty()) {
     return;
   }
-  std::vector<T> processing;
-  std::swap(*queue, processing);
-  processing.erase(std::remove_if(processing.begin(), processing.end(), func),
-                   processing.end());
+  processing->clear();
+  std::swap(*queue, *processing);
+  processing->erase(
+      std::remove_if(processing->begin(), processing->end(), func),
+      processing->end());
   // Func may have inserted new elements in queue.
-  processing.insert(processing.end(), queue->begin(), queue->end());
-  std::swap(*queue, processing);
+  processing->insert(processing->end(), queue->begin(), queue->end());
+  std::swap(*queue, *processing);
 }
 
 math::Orientation2d PickOrientation(Grid::TeleportOrientation mode,
@@ -86,9 +91,10 @@ Piece Grid::CreateInstance(State state, math::Transform2d transform) {
   pieces_group_membership_.ChangeMembership(
       piece, {}, absl::MakeConstSpan(state_data.groups));
   if (!grid_position.IsEmpty()) {
-    grid_[grid_position] = piece;
+    SetCell(grid_position, piece);
     SetSprite(grid_position, {state_data.sprite_handle, transform.orientation});
   }
+  UpdateFreeCellIndices(piece);
   if (const auto& callback = callbacks_[state]) {
     callback->OnAdd(piece);
   }
@@ -129,10 +135,11 @@ void Grid::ReleaseInstanceActual(Piece piece) {
   }
   pieces_group_membership_.ChangeMembership(
       piece, absl::MakeConstSpan(state_data.groups), {});
+  RemoveFromFreeCellIndices(piece);
   const CellIndex grid_position =
       shape_.TryToCellIndex(piece_data.transform.position, piece_data.layer);
   if (!grid_position.IsEmpty()) {
-    grid_[grid_position] = Piece();
+    SetCell(grid_position, Piece());
     SetSprite(grid_position, {Sprite(), math::Orientation2d::kNorth});
   }
 
@@ -142,7 +149,7 @@ void Grid::ReleaseInstanceActual(Piece piece) {
 
 void Grid::SetSprite(CellIndex cell, SpriteInstance sprite) {
   if (in_update_) {
-    grid_render_[cell] = sprite;
+    grid_render_.Mutable(cell) = sprite;
   } else {
     set_sprite_queue_.push_back(SpriteAction{cell, sprite});
   }
@@ -156,7 +163,7 @@ void Grid::SetSpriteUntilNextUpdate(CellIndex cell, SpriteInstance sprite) {
     // Set sprite and queue for removal at start of next frame.
     temp_sprite_locations_immediate_.push_back(
         SpriteAction{cell, grid_render_[cell]});
-    grid_render_[cell] = sprite;
+    grid_render_.Mutable(cell) = sprite;
   }
 }
 
@@ -167,9 +174,14 @@ void Grid::RunUpdaters(std::mt19937_64* random) {
     if (info.group.IsEmpty()) {
       continue;
     }
-    for (Piece piece :
-         pieces_group_membership_[info.group].ShuffledElementsWithProbability(
-             random, info.probability)) {
+    auto selected =
+        pieces_group_membership_[info.group].ShuffledElementsWithProbability(
+            random, info.probability);
+    if (info.batch) {
+      RunBatchedUpdater(update_handle, selected, info.start_frame);
+      continue;
+    }
+    for (Piece piece : selected) {
       const auto& piece_data = piece_data_[piece];
       if (frame_counter_ - piece_data.frame_created >= info.start_frame) {
         const auto& callback = callbacks_[piece_data.state];
@@ -182,6 +194,34 @@ void Grid::RunUpdaters(std::mt19937_64* random) {
   }
 }
 
+void Grid::RunBatchedUpdater(Update update, absl::Span<const Piece> selected,
+                             int start_frame) {
+  batched_updates_.clear();
+  for (Piece piece : selected) {
+    const auto& piece_data = piece_data_[piece];
+    const int num_frames = frame_counter_ - piece_data.frame_created;
+    if (num_frames >= start_frame && callbacks_[piece_data.state]) {
+      batched_updates_.push_back({piece_data.state, piece, num_frames});
+    }
+  }
+  // Pieces keep their shuffled order within each state.
+  std::stable_sort(batched_updates_.begin(), batched_updates_.end(),
+                   [](const BatchedUpdate& lhs, const BatchedUpdate& rhs) {
+                     return lhs.state.Value() < rhs.state.Value();
+                   });
+  auto it = batched_updates_.begin();
+  while (it != batched_updates_.end()) {
+    const State state = it->state;
+    batch_pieces_.clear();
+    batch_frames_.clear();
+    for (; it != batched_updates_.end() && it->state == state; ++it) {
+      batch_pieces_.push_back(it->piece);
+      batch_frames_.push_back(it->num_frames_in_state);
+    }
+    callbacks_[state]->OnUpdateBatch(update, batch_pieces_, batch_frames_);
+  }
+}
+
 // When there are permanent sprites that are not on the grid_render_ yet. We
 // need to remove all temporary sprites apply permanent sprites then re-apply
 // temporary sprites. This will only occur rarely. (I.e. when sprites are
@@ -192,24 +232,24 @@ void Grid::Repaint() {
   }
   for (auto it = temp_sprite_locations_immediate_.rbegin();
        it != temp_sprite_locations_immediate_.rend(); ++it) {
-    std::swap(grid_render_[it->position], it->instance);
+    std::swap(grid_render_.Mutable(it->position), it->instance);
   }
   for (auto it = temp_sprite_locations_.rbegin();
        it != temp_sprite_locations_.rend(); ++it) {
-    std::swap(grid_render_[it->position], it->instance);
+    std::swap(grid_render_.Mutable(it->position), it->instance);
   }
 
   for (const auto& sprite_action : set_sprite_queue_) {
-    grid_render_[sprite_action.position] = sprite_action.instance;
+    grid_render_.Mutable(sprite_action.position) = sprite_action.instance;
   }
   set_sprite_queue_.clear();
 
   for (auto& temp_sprite : temp_sprite_locations_) {
-    std::swap(grid_render_[temp_sprite.position], temp_sprite.instance);
+    std::swap(grid_render_.Mutable(temp_sprite.position), temp_sprite.instance);
   }
 
   for (auto& temp_sprite : temp_sprite_locations_immediate_) {
-    std::swap(grid_render_[temp_sprite.position], temp_sprite.instance);
+    std::swap(grid_render_.Mutable(temp_sprite.position), temp_sprite.instance);
   }
 }
 
@@ -218,17 +258,17 @@ void Grid::DoUpdate(std::mt19937_64* random, int flush_count) {
   // Undo all temporary sprite rendering.
   for (auto it = temp_sprite_locations_immediate_.rbegin();
        it != temp_sprite_locations_immediate_.rend(); ++it) {
-    std::swap(grid_render_[it->position], it->instance);
+    std::swap(grid_render_.Mutable(it->position), it->instance);
   }
   temp_sprite_locations_immediate_.clear();
   for (auto it = temp_sprite_locations_.rbegin();
        it != temp_sprite_locations_.rend(); ++it) {
-    std::swap(grid_render_[it->position], it->instance);
+    std::swap(grid_render_.Mutable(it->position), it->instance);
   }
   temp_sprite_locations_.clear();
 
   for (auto& sprite_action : set_sprite_queue_) {
-    grid_render_[sprite_action.position] = sprite_action.instance;
+    grid_render_.Mutable(sprite_action.position) = sprite_action.instance;
   }
   set_sprite_queue_.clear();
 
@@ -239,14 +279,19 @@ void Grid::DoUpdate(std::mt19937_64* random, int flush_count) {
     if (action_queue_.empty()) {
       break;
     }
-    ProcessQueue(&action_queue_, [this, random](const Action& action) {
-      Piece piece = action.piece;
-      return absl::visit(
-          [this, random, piece](const auto& arg) -> bool {
-            return this->ProcessAction(random, piece, arg);
-          },
-          action.action_type);
-    });
+    CoalesceActions();
+    ProcessQueue(&action_queue_, &action_queue_processing_,
+                 [this, random](const Action& action) {
+                   Piece piece = action.piece;
+                   const bool completed = absl::visit(
+                       [this, random, piece](const auto& arg) -> bool {
+                         return this->ProcessAction(random, piece, arg);
+                       },
+                       action.action_type);
+                   ++(completed ? action_queue_stats_.processed
+                                : action_queue_stats_.deferred);
+                   return completed;
+                 });
     for (Piece piece : to_remove_) {
       ReleaseInstanceActual(piece);
     }
@@ -254,15 +299,63 @@ void Grid::DoUpdate(std::mt19937_64* random, int flush_count) {
   }
 
   for (auto& temp_sprite : temp_sprite_locations_) {
-    std::swap(grid_render_[temp_sprite.position], temp_sprite.instance);
+    std::swap(grid_render_.Mutable(temp_sprite.position), temp_sprite.instance);
   }
 
   for (auto& temp_sprite : temp_sprite_locations_immediate_) {
-    std::swap(grid_render_[temp_sprite.position], temp_sprite.instance);
+    std::swap(grid_render_.Mutable(temp_sprite.position), temp_sprite.instance);
   }
   in_update_ = false;
 }
 
+bool Grid::IsDisconnect(const ActionType& action) {
+  return absl::holds_alternative<ActionDisconnect>(action) ||
+         absl::holds_alternative<ActionDisconnectAll>(action);
+}
+
+void Grid::CoalesceActions() {
+  if (action_queue_.size() < 2) {
+    return;
+  }
+  auto out = action_queue_.begin();
+  for (auto it = std::next(out); it != action_queue_.end(); ++it) {
+    if (it->piece == out->piece) {
+      ActionType& previous = out->action_type;
+      const ActionType& next = it->action_type;
+      bool merged = true;
+      if (absl::holds_alternative<ActionSetOrientation>(next)) {
+        if (absl::holds_alternative<ActionSetOrientation>(previous) ||
+            absl::holds_alternative<ActionRotate>(previous)) {
+          previous = next;
+        } else {
+          merged = false;
+        }
+      } else if (const auto* rotate = absl::get_if<ActionRotate>(&next)) {
+        if (auto* set = absl::get_if<ActionSetOrientation>(&previous)) {
+          set->orientation = set->orientation + rotate->rotate;
+        } else if (auto* turn = absl::get_if<ActionRotate>(&previous)) {
+          turn->rotate = turn->rotate + rotate->rotate;
+        } else {
+          merged = false;
+        }
+      } else if (IsDisconnect(next)) {
+        // A piece that was just disconnected has nothing to disconnect from.
+        merged = IsDisconnect(previous);
+      } else {
+        merged = false;
+      }
+      if (merged) {
+        ++action_queue_stats_.coalesced;
+        continue;
+      }
+    }
+    if (++out != it) {
+      *out = std::move(*it);
+    }
+  }
+  action_queue_.erase(std::next(out), action_queue_.end());
+}
+
 void Grid::SetSpriteImmediate(math::Transform2d trans, Layer layer,
                               Sprite sprite) {
   const CellIndex cell = shape_.ToCellIndex(trans.position, layer);
@@ -272,8 +365,33 @@ void Grid::SetSpriteImmediate(math::Transform2d trans, Layer layer,
 }
 
 void Grid::SetCallback(State state, std::unique_ptr<StateCallback> callback) {
-  if (!state.IsEmpty()) {
-    callbacks_[state] = std::move(callback);
+  if (state.IsEmpty()) {
+    return;
+  }
+  callbacks_[state] = std::move(callback);
+  const Layer layer = world_.state_data(state).layer;
+  const std::size_t num_hits = world_.hits().NumElements();
+  for (std::size_t hit_index = 0; hit_index < num_hits; ++hit_index) {
+    const Hit hit(hit_index);
+    const bool handled =
+        callbacks_[state] != nullptr && callbacks_[state]->HandlesHit(hit);
+    const bool was_handled = HandlesHit(state, hit);
+    hit_handled_[state.Value() * num_hits + hit_index] = handled;
+    if (handled == was_handled || layer.IsEmpty()) {
+      continue;
+    }
+    // Only the entry for `layer` can change; keep `layers` sorted.
+    int& num_handlers =
+        hit_layer_handlers_[hit_index * shape_.layer_count() + layer.Value()];
+    auto& layers = hit_layers_[hit];
+    auto it = std::lower_bound(layers.begin(), layers.end(), layer);
+    if (handled) {
+      if (num_handlers++ == 0) {
+        layers.insert(it, layer);
+      }
+    } else if (--num_handlers == 0) {
+      layers.erase(it);
+    }
   }
 }
 
@@ -287,25 +405,34 @@ bool Grid::TeleportToGroupActual(std::mt19937_64* random, Piece piece,
   const Layer target_layer = target_state.IsEmpty()
                                  ? piece_data.layer
                                  : world_.state_data(target_state).layer;
+  if (target_layer.IsEmpty()) {
+    // A piece without a layer has no cell to teleport into.
+    return true;
+  }
 
   const CellIndex current_cell =
       shape_.TryToCellIndex(piece_data.transform.position, piece_data.layer);
-  CellIndex target_cell;
-  math::Transform2d target_transform;
-  auto& group = pieces_group_membership_[target_group];
-  const auto* found_piece = group.ShuffledElementsFind(
-      random, [this, target_layer, current_cell, &target_cell,
-               &target_transform](Piece handle) {
-        const auto& piece_data = piece_data_[handle];
-        target_transform = piece_data.transform;
-        target_cell =
-            shape_.ToCellIndex(target_transform.position, target_layer);
-        return !target_cell.IsEmpty() &&
-               (grid_[target_cell].IsEmpty() || current_cell == target_cell);
-      });
-  if (found_piece == nullptr) {
+  const FreeCellIndex& index = GetFreeCellIndex(target_group, target_layer);
+  // Members sharing the piece's own cell are candidates as well.
+  const int current_position =
+      !current_cell.IsEmpty() && piece_data.layer == target_layer
+          ? PositionIndex(current_cell)
+          : -1;
+  const int num_at_current =
+      current_position != -1 ? index.NumAtPosition(current_position) : 0;
+  const std::size_t num_candidates = index.NumFree() + num_at_current;
+  if (num_candidates == 0) {
     return false;
   }
+  const std::size_t selected = std::uniform_int_distribution<std::size_t>(
+      0, num_candidates - 1)(*random);
+  const Piece target_piece =
+      selected < index.NumFree()
+          ? index.Free(selected)
+          : index.AtPosition(current_position, selected - index.NumFree());
+  math::Transform2d target_transform = piece_data_[target_piece].transform;
+  const CellIndex target_cell =
+      shape_.ToCellIndex(target_transform.position, target_layer);
   target_transform.orientation =
       PickOrientation(teleport_orientation, piece_data.transform.orientation,
                       target_transform.orientation, random);
@@ -313,11 +440,12 @@ bool Grid::TeleportToGroupActual(std::mt19937_64* random, Piece piece,
 
   if (current_cell != target_cell) {
     if (!current_cell.IsEmpty()) {
-      // Current is valid, swap from current to target.
-      std::swap(grid_[target_cell], grid_[current_cell]);
-      grid_render_[current_cell] = grid_render_[target_cell];
+      // Current is valid, move from current to target.
+      SetCell(target_cell, piece);
+      SetCell(current_cell, Piece());
+      grid_render_.Mutable(current_cell) = grid_render_[target_cell];
     } else {
-      grid_[target_cell] = piece;
+      SetCell(target_cell, piece);
     }
   }
 
@@ -325,8 +453,8 @@ bool Grid::TeleportToGroupActual(std::mt19937_64* random, Piece piece,
 
   const World::StateData& target_state_data = world_.state_data(target_state);
 
-  grid_render_[target_cell] = SpriteInstance{target_state_data.sprite_handle,
-                                             target_transform.orientation};
+  grid_render_.Mutable(target_cell) = SpriteInstance{
+      target_state_data.sprite_handle, target_transform.orientation};
 
   const State source_state = piece_data.state;
   const World::StateData& source_state_data = world_.state_data(source_state);
@@ -342,11 +470,13 @@ bool Grid::TeleportToGroupActual(std::mt19937_64* random, Piece piece,
     piece_data.state = target_state;
     piece_data.frame_created = frame_counter_;
     piece_data.layer = target_state_data.layer;
+    UpdateFreeCellIndices(piece);
     if (const auto& callback = callbacks_[target_state]) {
       callback->OnAdd(piece);
     }
   } else {
     piece_data.transform = target_transform;
+    UpdateFreeCellIndices(piece);
   }
   TriggerOnEnterCallbacks(piece, piece_data.transform.position);
   return true;
@@ -370,24 +500,25 @@ bool Grid::SetStateActual(Piece piece, State target_state) {
     if (target_cell.IsEmpty()) {
       TriggerOnLeaveCallbacks(piece, piece_data.transform.position);
       // Target out of bounds, hide the piece.
-      grid_[current_cell] = Piece();
-      grid_render_[current_cell].handle = Sprite();
+      SetCell(current_cell, Piece());
+      grid_render_.Mutable(current_cell).handle = Sprite();
     } else if (!grid_[target_cell].IsEmpty()) {
       // Target occupied, cannot change state.
       return false;
     } else if (!current_cell.IsEmpty()) {
       TriggerOnLeaveCallbacks(piece, piece_data.transform.position);
-      // Current is valid, swap from current to target.
-      std::swap(grid_[target_cell], grid_[current_cell]);
-      grid_render_[current_cell] = grid_render_[target_cell];
+      // Current is valid, move from current to target.
+      SetCell(target_cell, piece);
+      SetCell(current_cell, Piece());
+      grid_render_.Mutable(current_cell) = grid_render_[target_cell];
     } else {
       // No piece at current, target is clear, so create new piece at target.
-      grid_[target_cell] = piece;
+      SetCell(target_cell, piece);
     }
   }
 
   if (!target_cell.IsEmpty()) {
-    grid_render_[target_cell] = SpriteInstance{
+    grid_render_.Mutable(target_cell) = SpriteInstance{
         target_state_data.sprite_handle, piece_data.transform.orientation};
   }
   if (const auto& callback = callbacks_[source_state]) {
@@ -399,6 +530,7 @@ bool Grid::SetStateActual(Piece piece, State target_state) {
   piece_data.frame_created = frame_counter_;
   piece_data.state = target_state;
   piece_data.layer = target_state_data.layer;
+  UpdateFreeCellIndices(piece);
   if (const auto& callback = callbacks_[target_state]) {
     callback->OnAdd(piece);
   }
@@ -408,6 +540,64 @@ bool Grid::SetStateActual(Piece piece, State target_state) {
   return true;
 }
 
+void Grid::SetCell(CellIndex cell, Piece piece) {
+  grid_.Mutable(cell) = piece;
+  const Layer layer = shape_.ToLayer(cell);
+  if (!layer_occupancy_.empty()) {
+    SetLayerOccupied(cell, !piece.IsEmpty());
+  }
+  if (free_cell_indices_.empty()) {
+    return;
+  }
+  for (auto& index : free_cell_indices_) {
+    if (index.layer() == layer) {
+      index.SetPositionFree(PositionIndex(cell), piece.IsEmpty());
+    }
+  }
+}
+
+FreeCellIndex& Grid::GetFreeCellIndex(Group group, Layer layer) {
+  for (auto& index : free_cell_indices_) {
+    if (index.group() == group && index.layer() == layer) {
+      return index;
+    }
+  }
+  auto& index = free_cell_indices_.emplace_back(group, layer);
+  for (Piece member : pieces_group_membership_[group].Elements()) {
+    AddToFreeCellIndex(member, &index);
+  }
+  return index;
+}
+
+void Grid::UpdateFreeCellIndices(Piece piece) {
+  if (free_cell_indices_.empty()) {
+    return;
+  }
+  const auto& groups = world_.state_data(piece_data_[piece].state).groups;
+  for (auto& index : free_cell_indices_) {
+    index.Erase(piece);
+    if (std::binary_search(groups.begin(), groups.end(), index.group())) {
+      AddToFreeCellIndex(piece, &index);
+    }
+  }
+}
+
+void Grid::RemoveFromFreeCellIndices(Piece piece) {
+  for (auto& index : free_cell_indices_) {
+    index.Erase(piece);
+  }
+}
+
+void Grid::AddToFreeCellIndex(Piece piece, FreeCellIndex* index) const {
+  const CellIndex cell = shape_.TryToCellIndex(
+      piece_data_[piece].transform.position, index->layer());
+  if (cell.IsEmpty()) {
+    index->Insert(piece, -1, false);
+  } else {
+    index->Insert(piece, PositionIndex(cell), grid_[cell].IsEmpty());
+  }
+}
+
 absl::Span<const SpriteInstance> Grid::AllSpriteInstances(
     math::Position2d pos) {
   Repaint();
@@ -424,7 +614,7 @@ void Grid::UpdateRenderOrientation(const PieceData& piece_data) {
   const CellIndex cell =
       shape_.TryToCellIndex(piece_data.transform.position, piece_data.layer);
   if (!cell.IsEmpty()) {
-    grid_render_[cell].orientation = piece_data.transform.orientation;
+    grid_render_.Mutable(cell).orientation = piece_data.transform.orientation;
   }
 }
 
@@ -452,6 +642,7 @@ void Grid::TeleportPieceActual(std::mt19937_64* random, Piece piece,
   if (piece_data.layer.IsEmpty()) {
     if (shape_.InBounds(position)) {
       piece_data.transform = {position, orientation};
+      UpdateFreeCellIndices(piece);
     }
     return;
   }
@@ -482,8 +673,8 @@ void Grid::LiftPiece(Piece piece) {
     const CellIndex current_cell =
         shape_.TryToCellIndex(piece_data.transform.position, piece_data.layer);
     if (!current_cell.IsEmpty()) {
-      grid_[current_cell] = Piece();
-      grid_render_[current_cell].handle = Sprite();
+      SetCell(current_cell, Piece());
+      grid_render_.Mutable(current_cell).handle = Sprite();
     }
   });
 }
@@ -499,12 +690,13 @@ void Grid::PlacePiece(Piece piece, math::Vector2d offset, Layer layer) {
     const CellIndex target_cell =
         shape_.TryToCellIndex(piece_data.transform.position, piece_data_layer);
     if (!target_cell.IsEmpty()) {
-      grid_[target_cell] = handle;
+      SetCell(target_cell, handle);
       const auto& state_data = world_.state_data(piece_data.state);
-      grid_render_[target_cell] = {state_data.sprite_handle,
-                                   piece_data.transform.orientation};
+      grid_render_.Mutable(target_cell) = {state_data.sprite_handle,
+                                           piece_data.transform.orientation};
       TriggerOnEnterCallbacks(handle, piece_data.transform.position);
     }
+    UpdateFreeCellIndices(handle);
   });
 }
 
@@ -555,6 +747,7 @@ void Grid::PushPieceActual(Piece piece, math::Orientation2d push_direction,
     math::Position2d new_position = piece_data.transform.position + direction;
     if (shape_.InBounds(new_position)) {
       piece_data.transform.position = new_position;
+      UpdateFreeCellIndices(piece);
     } else {
       if (auto& callback_mover = callbacks_[piece_data.state];
           callback_mover != nullptr) {
@@ -722,6 +915,31 @@ struct GridToView {
   int offset_y;  // See span_y.
 };
 
+namespace {
+
+// Writes the sprite-ids of `run_length` positions with consecutive cells,
+// starting at `render_run`, to `output` starting at `view_pos` and advancing
+// `view_step` per position.
+void RenderRun(const SpriteInstance* render_run, int run_length,
+               int layer_count, int view_pos, int view_step,
+               math::Orientation2d view_orientation, const GridView& grid_view,
+               absl::Span<int> output) {
+  const int num_render_layers = grid_view.NumRenderLayers();
+  int* output_cell = output.data() + view_pos;
+  for (int n = 0; n < run_length; ++n) {
+    for (int i = 0; i < num_render_layers; ++i) {
+      SpriteInstance instance = render_run[i];
+      instance.orientation =
+          math::FromView(view_orientation, instance.orientation);
+      output_cell[i] = grid_view.ToSpriteId(instance);
+    }
+    render_run += layer_count;
+    output_cell += view_step;
+  }
+}
+
+}  // namespace
+
 void Grid::RenderTorus(math::Transform2d transform, const GridView& grid_view,
                        absl::Span<int> output_sprites) const {
   const int num_render_layers = grid_view.NumRenderLayers();
@@ -731,23 +949,35 @@ void Grid::RenderTorus(math::Transform2d transform, const GridView& grid_view,
 
   GridToView grid_to_view(transform, grid_size, grid_view);
 
-  const SpriteInstance* render_grid = &grid_render_[CellIndex(0)];
+  // The view is split into runs of positions that neither wrap around the
+  // grid nor cross a chunk, so only the start of each row and run is wrapped.
+  // A view no wider than the grid has at most two runs per row in an
+  // unchunked grid.
   const int layer_count = shape_.layer_count();
-
+  const int view_step = grid_to_view.span_x * num_render_layers;
+  int grid_y = shape_.ModuloHeight(grid_to_view.first_y);
   for (int y = grid_to_view.first_y; y <= grid_to_view.last_y; ++y) {
     int view_y = (y - grid_to_view.offset_y) * grid_to_view.span_y;
-    int grid_y = GetShape().ModuloHeight(y) * grid_size.width;
-    for (int x = grid_to_view.first_x; x <= grid_to_view.last_x; ++x) {
-      int view_x = (x - grid_to_view.offset_x) * grid_to_view.span_x;
-      int view_pos = (view_y + view_x) * num_render_layers;
-      int grid_pos = (grid_y + GetShape().ModuloWidth(x)) * layer_count;
-      for (int i = 0; i < num_render_layers; ++i) {
-        CHECK_LT(grid_pos, grid_render_.size());
-        SpriteInstance instance = render_grid[grid_pos + i];
-        instance.orientation =
-            math::FromView(transform.orientation, instance.orientation);
-        output_sprites[view_pos + i] = grid_view.ToSpriteId(instance);
+    int grid_x = shape_.ModuloWidth(grid_to_view.first_x);
+    for (int run_x = grid_to_view.first_x; run_x <= grid_to_view.last_x;) {
+      const int run_end =
+          std::min(run_x + shape_.RowRunLength({grid_x, grid_y}),
+                   grid_to_view.last_x + 1);
+      const CellIndex run_cell = shape_.ToCellIndex({grid_x, grid_y}, Layer(0));
+      CHECK_LT(shape_.ToPositionIndex(run_cell) + (run_end - run_x) - 1,
+               shape_.GetPositionCount());
+      const int view_x = (run_x - grid_to_view.offset_x) * grid_to_view.span_x;
+      RenderRun(&grid_render_[run_cell], run_end - run_x, layer_count,
+                (view_y + view_x) * num_render_layers, view_step,
+                transform.orientation, grid_view, output_sprites);
+      grid_x += run_end - run_x;
+      if (grid_x == grid_size.width) {
+        grid_x = 0;
       }
+      run_x = run_end;
+    }
+    if (++grid_y == grid_size.height) {
+      grid_y = 0;
     }
   }
 }
@@ -788,21 +1018,20 @@ void Grid::RenderBounded(math::Transform2d transform, const GridView& grid_view,
               grid_view.ToSpriteId(clear));
   }
 
-  const SpriteInstance* render_grid = &grid_render_[CellIndex(0)];
   const int layer_count = shape_.layer_count();
+  const int view_step = grid_to_view.span_x * num_render_layers;
   for (int y = first_inbounds_y; y <= last_inbounds_y; ++y) {
     int view_y = (y - grid_to_view.offset_y) * grid_to_view.span_y;
-    int grid_y = y * grid_size.width;
-    for (int x = first_inbounds_x; x <= last_inbounds_x; ++x) {
-      int view_x = (x - grid_to_view.offset_x) * grid_to_view.span_x;
-      int view_pos = (view_y + view_x) * num_render_layers;
-      int grid_pos = (grid_y + x) * layer_count;
-      for (int i = 0; i < num_render_layers; ++i) {
-        SpriteInstance instance = render_grid[grid_pos + i];
-        instance.orientation =
-            math::FromView(transform.orientation, instance.orientation);
-        output_sprites[view_pos + i] = grid_view.ToSpriteId(instance);
-      }
+    // Each run of positions has consecutive cells; see GridShape.
+    for (int run_x = first_inbounds_x; run_x <= last_inbounds_x;) {
+      const int run_end = std::min(run_x + shape_.RowRunLength({run_x, y}),
+                                   last_inbounds_x + 1);
+      const int view_x = (run_x - grid_to_view.offset_x) * grid_to_view.span_x;
+      RenderRun(&grid_render_[shape_.ToCellIndex({run_x, y}, Layer(0))],
+                run_end - run_x, layer_count,
+                (view_y + view_x) * num_render_layers, view_step,
+                transform.orientation, grid_view, output_sprites);
+      run_x = run_end;
     }
   }
 }
@@ -845,14 +1074,17 @@ Grid::HitResponse Grid::DoHit(Piece instigator, Hit hit,
   }
 
   bool blocked = false;
-  // Hit every piece at x, y return whether any blocked.
-  for (Piece target_handle : AllPieceHandles(trans.position)) {
+  // Hit every piece at x, y that responds to `hit`, return whether any
+  // blocked.
+  const int first_cell = shape_.ToCellIndex(trans.position, Layer(0)).Value();
+  for (Layer layer : hit_layers_[hit]) {
+    const Piece target_handle = grid_[CellIndex(first_cell + layer.Value())];
     if (target_handle.IsEmpty()) continue;
-    PieceData& target_piece_data = piece_data_[target_handle];
-    const auto& callback = callbacks_[target_piece_data.state];
-    bool on_hit = callback != nullptr &&
-                  callback->OnHit(hit, target_handle, instigator) ==
-                      HitResponse::kBlocked;
+    const State target_state = piece_data_[target_handle].state;
+    if (!HandlesHit(target_state, hit)) continue;
+    bool on_hit = callbacks_[target_state]->OnHit(hit, target_handle,
+                                                  instigator) ==
+                  HitResponse::kBlocked;
     blocked = blocked || on_hit;
   }
 
@@ -865,46 +1097,76 @@ Grid::HitResponse Grid::DoHit(Piece instigator, Hit hit,
   return blocked ? HitResponse::kBlocked : HitResponse::kContinue;
 }
 
-Grid::HitResponse Grid::CheckHitLineSegment(Piece instigator, Hit hit,
-                                            const World::HitData& hit_data,
-                                            math::Transform2d trans,
-                                            int length) {
-  math::Vector2d dir = math::Vector2d::FromOrientation(trans.orientation);
-  for (int i = 0; i < length; ++i) {
+const Grid::BeamStencil& Grid::GetBeamStencil(int length, int radius,
+                                              math::Orientation2d orientation) {
+  auto [it, inserted] = beam_stencils_.try_emplace(
+      std::make_tuple(length, radius, static_cast<int>(orientation)));
+  BeamStencil& stencil = it->second;
+  if (!inserted) {
+    return stencil;
+  }
+  const math::Rotate2d north_to_forward =
+      orientation - math::Orientation2d::kNorth;
+  const math::Vector2d forward = math::Vector2d::North() * north_to_forward;
+  auto add_line = [&stencil, forward](math::Vector2d start, int line_length) {
+    const int begin = stencil.offsets.size();
+    for (int i = 0; i < line_length; ++i) {
+      stencil.offsets.push_back(start + i * forward);
+    }
+    const int end = stencil.offsets.size();
+    stencil.lines.push_back({begin, end, /*next_if_blocked=*/0});
+  };
+  // Side lines run west then east, each from the centre outwards, followed by
+  // the centre line.
+  for (auto direction : {math::Vector2d::West(), math::Vector2d::East()}) {
+    const math::Vector2d sideways = direction * north_to_forward;
+    const std::size_t first_line = stencil.lines.size();
+    for (int r = 1; r <= radius; ++r) {
+      add_line(r * sideways, length - r + 1);
+    }
+    for (std::size_t i = first_line; i < stencil.lines.size(); ++i) {
+      stencil.lines[i].next_if_blocked = stencil.lines.size();
+    }
+  }
+  add_line(forward, length);
+  stencil.lines.back().next_if_blocked = stencil.lines.size();
+  return stencil;
+}
+
+Grid::HitResponse Grid::CheckHitLine(Piece instigator, Hit hit,
+                                     const World::HitData& hit_data,
+                                     const math::Transform2d& start,
+                                     const BeamStencil& stencil,
+                                     const BeamStencil::Line& line) {
+  math::Transform2d trans = start;
+  for (int i = line.begin; i < line.end; ++i) {
+    trans.position = start.position + stencil.offsets[i];
     if (DoHit(instigator, hit, trans, hit_data) == HitResponse::kBlocked) {
-      return i == 0 ? HitResponse::kBlocked : HitResponse::kContinue;
+      return i == line.begin ? HitResponse::kBlocked : HitResponse::kContinue;
     }
-    trans.position += dir;
   }
   return HitResponse::kContinue;
 }
 
 void Grid::HitBeamActual(Piece instigator, Hit hit, int length, int radius) {
   const auto& piece_data = piece_data_[instigator];
-  math::Transform2d start = piece_data.transform;
+  const math::Transform2d start = piece_data.transform;
   const CellIndex cell =
       shape_.TryToCellIndex(start.position, piece_data.layer);
   if (cell.IsEmpty()) {
     return;
   }
   const auto& hit_data = world_.hit_data(hit);
-  const math::Rotate2d north_to_forward =
-      start.orientation - math::Orientation2d::kNorth;
-  const math::Vector2d forward = math::Vector2d::North() * north_to_forward;
-
-  for (auto direction : {math::Vector2d::West(), math::Vector2d::East()}) {
-    math::Vector2d sideways = direction * north_to_forward;
-    for (int r = 1; r <= radius; ++r) {
-      math::Transform2d trans = start;
-      trans.position += r * sideways;
-      if (CheckHitLineSegment(instigator, hit, hit_data, trans,
-                              length - r + 1) == HitResponse::kBlocked) {
-        break;
-      }
-    }
+  const BeamStencil& stencil =
+      GetBeamStencil(length, radius, start.orientation);
+  std::size_t i = 0;
+  while (i < stencil.lines.size()) {
+    const BeamStencil::Line& line = stencil.lines[i];
+    i = CheckHitLine(instigator, hit, hit_data, start, stencil, line) ==
+                HitResponse::kBlocked
+            ? line.next_if_blocked
+            : i + 1;
   }
-  start.position += forward;
-  CheckHitLineSegment(instigator, hit, hit_data, start, length);
 }
 
 void Grid::ConnectActual(Piece piece1_handle, Piece piece2_handle) {
@@ -1029,6 +1291,123 @@ absl::optional<Grid::FindPieceResult> Grid::RayCast(
   return RayCastDirection(layer, start, GetShape().SmallestVector(start, end));
 }
 
+void Grid::BuildLayerOccupancy() {
+  layer_occupancy_.assign(shape_.chunk_count(), {});
+  for (int chunk = 0; chunk < shape_.chunk_count(); ++chunk) {
+    if (!grid_.IsAllocated(chunk)) {
+      continue;
+    }
+    const int first_cell = chunk << shape_.chunk_cell_bits();
+    for (int i = 0; i < shape_.chunk_cell_count(); ++i) {
+      const CellIndex cell(first_cell | i);
+      if (!grid_[cell].IsEmpty()) {
+        SetLayerOccupied(cell, true);
+      }
+    }
+  }
+}
+
+const std::uint64_t* Grid::LayerOccupancy(CellIndex cell) const {
+  const int chunk = cell.Value() >> shape_.chunk_cell_bits();
+  const std::vector<std::uint64_t>& words = layer_occupancy_[chunk];
+  if (words.empty()) {
+    return nullptr;
+  }
+  const int position =
+      PositionIndex(cell) - chunk * shape_.chunk_position_count();
+  return &words[position * LayerOccupancyWords()];
+}
+
+void Grid::SetLayerOccupied(CellIndex cell, bool occupied) {
+  const int chunk = cell.Value() >> shape_.chunk_cell_bits();
+  std::vector<std::uint64_t>& words = layer_occupancy_[chunk];
+  if (words.empty()) {
+    if (!occupied) {
+      return;
+    }
+    words.assign(shape_.chunk_position_count() * LayerOccupancyWords(), 0);
+  }
+  const int position =
+      PositionIndex(cell) - chunk * shape_.chunk_position_count();
+  const int layer = shape_.ToLayer(cell).Value();
+  std::uint64_t& word = words[position * LayerOccupancyWords() + layer / 64];
+  const std::uint64_t bit = std::uint64_t{1} << (layer % 64);
+  if (occupied) {
+    word |= bit;
+  } else {
+    word &= ~bit;
+  }
+}
+
+void Grid::RayCastBatch(absl::Span<const Layer> layers,
+                        absl::Span<const math::Position2d> starts,
+                        absl::Span<const math::Vector2d> directions,
+                        absl::Span<RayCastBatchResult> results) {
+  CHECK_EQ(directions.size(), starts.size());
+  CHECK_EQ(results.size(), starts.size());
+  if (layer_occupancy_.empty()) {
+    BuildLayerOccupancy();
+  }
+  const int words = LayerOccupancyWords();
+  ray_layer_mask_.assign(words, 0);
+  ray_layers_.clear();
+  for (Layer layer : layers) {
+    if (!layer.IsEmpty() && layer.Value() < shape_.layer_count()) {
+      ray_layer_mask_[layer.Value() / 64] |= std::uint64_t{1}
+                                             << (layer.Value() % 64);
+      ray_layers_.push_back(layer);
+    }
+  }
+  std::sort(ray_layers_.begin(), ray_layers_.end());
+
+  auto is_occupied = [this, words](math::Position2d position) {
+    const std::uint64_t* occupancy = LayerOccupancy(
+        shape_.ToCellIndex(shape_.Normalised(position), Layer(0)));
+    if (occupancy == nullptr) {
+      return false;
+    }
+    for (int w = 0; w < words; ++w) {
+      if ((occupancy[w] & ray_layer_mask_[w]) != 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  for (std::size_t i = 0; i < starts.size(); ++i) {
+    auto& result = results[i];
+    result = RayCastBatchResult();
+    const math::Position2d start = starts[i];
+    if (!shape_.InBounds(start)) {
+      continue;
+    }
+    math::Position2d reached = start;
+    math::RayCastLine(
+        start, start + directions[i],
+        [this, &is_occupied, &reached, &result](math::Position2d position) {
+          if (!shape_.InBounds(position)) {
+            return true;
+          }
+          reached = position;
+          if (!is_occupied(position)) {
+            return false;
+          }
+          for (Layer layer : ray_layers_) {
+            const Piece piece = grid_[shape_.ToCellIndex(position, layer)];
+            if (!piece.IsEmpty()) {
+              result.piece = piece;
+              result.state = piece_data_[piece].state;
+              break;
+            }
+          }
+          return true;
+        });
+    const math::Vector2d offset = reached - start;
+    result.distance = std::sqrt(static_cast<double>(offset.x * offset.x +
+                                                    offset.y * offset.y));
+  }
+}
+
 Piece Grid::GetPieceAtPosition(Layer layer, math::Position2d position) {
   const CellIndex cell = shape_.TryToCellIndex(position, layer);
   if (cell.IsEmpty()) {
@@ -1052,79 +1431,101 @@ std::vector<Grid::FindPieceResult> Grid::DiscFindAll(Layer layer,
                                                      math::Position2d center,
                                                      int radius) {
   std::vector<Grid::FindPieceResult> result;
+  DiscFindAll(layer, center, radius, &result);
+  return result;
+}
+
+std::vector<Grid::FindPieceResult> Grid::DiamondFindAll(Layer layer,
+                                                        math::Position2d center,
+                                                        int radius) {
+  std::vector<Grid::FindPieceResult> result;
+  DiamondFindAll(layer, center, radius, &result);
+  return result;
+}
+
+std::vector<Grid::FindPieceResult> Grid::RectangleFindAll(
+    Layer layer, math::Position2d corner0, math::Position2d corner1) {
+  std::vector<Grid::FindPieceResult> result;
+  RectangleFindAll(layer, corner0, corner1, &result);
+  return result;
+}
+
+void Grid::DiscFindAll(Layer layer, math::Position2d center, int radius,
+                       std::vector<FindPieceResult>* result) {
+  result->clear();
   if (layer.IsEmpty() || radius < 0) {
-    return result;
+    return;
   }
   switch (GetShape().topology()) {
     case GridShape::Topology::kBounded:
       math::VisitDisc(center, radius,
-                      [this, layer, &result](math::Position2d position) {
+                      [this, layer, result](math::Position2d position) {
                         if (!shape_.InBounds(position)) {
                           return;
                         }
-                        FindPiece(position, layer, &result);
+                        FindPiece(position, layer, result);
                       });
-      return result;
+      return;
     case GridShape::Topology::kTorus:
       math::VisitDisc(center, radius,
-                      [this, layer, &result](math::Position2d position) {
-                        FindPiece(position, layer, &result);
+                      [this, layer, result](math::Position2d position) {
+                        FindPiece(position, layer, result);
                       });
-      return result;
+      return;
   }
 
   LOG(FATAL) << "Invalid topology " << static_cast<int>(GetShape().topology());
 }
 
-std::vector<Grid::FindPieceResult> Grid::DiamondFindAll(Layer layer,
-                                                        math::Position2d center,
-                                                        int radius) {
-  std::vector<Grid::FindPieceResult> result;
+void Grid::DiamondFindAll(Layer layer, math::Position2d center, int radius,
+                          std::vector<FindPieceResult>* result) {
+  result->clear();
   if (layer.IsEmpty() || radius < 0) {
-    return result;
+    return;
   }
 
   switch (GetShape().topology()) {
     case GridShape::Topology::kBounded:
       math::VisitDiamond(center, radius,
-                         [this, layer, &result](math::Position2d position) {
+                         [this, layer, result](math::Position2d position) {
                            if (!shape_.InBounds(position)) {
                              return;
                            }
-                           FindPiece(position, layer, &result);
+                           FindPiece(position, layer, result);
                          });
-      return result;
+      return;
     case GridShape::Topology::kTorus:
       math::VisitDiamond(center, radius,
-                         [this, layer, &result](math::Position2d position) {
-                           FindPiece(position, layer, &result);
+                         [this, layer, result](math::Position2d position) {
+                           FindPiece(position, layer, result);
                          });
-      return result;
+      return;
   }
 
   LOG(FATAL) << "Invalid topology " << static_cast<int>(GetShape().topology());
 }
 
-std::vector<Grid::FindPieceResult> Grid::RectangleFindAll(
-    Layer layer, math::Position2d corner0, math::Position2d corner1) {
-  std::vector<Grid::FindPieceResult> result{};
+void Grid::RectangleFindAll(Layer layer, math::Position2d corner0,
+                            math::Position2d corner1,
+                            std::vector<FindPieceResult>* result) {
+  result->clear();
   if (layer.IsEmpty()) {
-    return result;
+    return;
   }
   switch (GetShape().topology()) {
     case GridShape::Topology::kBounded:
       math::VisitRectangleClamped(
           corner0, corner1, shape_.GridSize2d(),
-          [layer, &result, this](math::Position2d position) {
-            FindPiece(position, layer, &result);
+          [layer, result, this](math::Position2d position) {
+            FindPiece(position, layer, result);
           });
-      return result;
+      return;
     case GridShape::Topology::kTorus:
       math::VisitRectangle(corner0, corner1,
-                           [layer, &result, this](math::Position2d position) {
-                             FindPiece(position, layer, &result);
+                           [layer, result, this](math::Position2d position) {
+                             FindPiece(position, layer, result);
                            });
-      return result;
+      return;
   }
   LOG(FATAL) << "Invalid topology " << static_cast<int>(GetShape().topology());
 }
@@ -17,18 +17,25 @@
 #ifndef DMLAB2D_LIB_SYSTEM_GRID_WORLD_GRID_H_
 #define DMLAB2D_LIB_SYSTEM_GRID_WORLD_GRID_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <random>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/any.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "dmlab2d/lib/system/grid_world/chunked_cell_map.h"
 #include "dmlab2d/lib/system/grid_world/collections/fixed_handle_map.h"
 #include "dmlab2d/lib/system/grid_world/collections/object_pool.h"
 #include "dmlab2d/lib/system/grid_world/collections/shuffled_membership.h"
+#include "dmlab2d/lib/system/grid_world/free_cell_index.h"
 #include "dmlab2d/lib/system/grid_world/grid_shape.h"
 #include "dmlab2d/lib/system/grid_world/grid_view.h"
 #include "dmlab2d/lib/system/grid_world/handles.h"
@@ -55,6 +62,25 @@ class Grid {
     Piece piece;
   };
 
+  // Running totals of actions handled by DoUpdate.
+  struct ActionQueueStats {
+    // Actions that completed.
+    std::int64_t processed = 0;
+    // Actions merged into or made redundant by the next action on the same
+    // piece, and so never run.
+    std::int64_t coalesced = 0;
+    // Attempts that could not complete and were kept for a later flush.
+    std::int64_t deferred = 0;
+  };
+
+  struct RayCastBatchResult {
+    // Euclidean distance from the start of the ray to `piece`, or to the last
+    // position reached when no piece was found.
+    double distance = 0.0;
+    Piece piece;
+    State state;
+  };
+
   // Callbacks from events in the engine.
   class StateCallback {
    public:
@@ -63,10 +89,23 @@ class Grid {
     virtual void OnRemove(Piece piece) = 0;
     virtual void OnUpdate(Update update, Piece piece,
                           int num_frames_in_state) = 0;
+    // Called instead of OnUpdate for batched updates, once per frame with all
+    // selected pieces in this callback's state. `num_frames_in_state[i]` is
+    // the number of frames `pieces[i]` has been in its state.
+    virtual void OnUpdateBatch(Update update, absl::Span<const Piece> pieces,
+                               absl::Span<const int> num_frames_in_state) {
+      for (std::size_t i = 0; i < pieces.size(); ++i) {
+        OnUpdate(update, pieces[i], num_frames_in_state[i]);
+      }
+    }
     virtual void OnBlocked(Piece piece, Piece blocker) = 0;
     virtual void OnEnter(Contact contact, Piece piece, Piece instigator) = 0;
     virtual void OnLeave(Contact contact, Piece piece, Piece instigator) = 0;
     virtual HitResponse OnHit(Hit hit, Piece piece, Piece instigator) = 0;
+    // Returns whether OnHit for a hit may do anything other than return
+    // kContinue. If not, beams pass pieces in this state without calling
+    // OnHit. Queried when the callback is set and must not change afterwards.
+    virtual bool HandlesHit(Hit) const { return true; }
   };
 
   // `world` is captured by reference and must out-last *this.
@@ -76,21 +115,31 @@ class Grid {
         pieces_group_membership_(world_.groups().NumElements()),
         update_infos_(world_.updates().NumElements()),
         callbacks_(world_.states().NumElements()),
-        grid_(shape_.GetCellCount()),
-        grid_render_(shape_.GetCellCount()) {}
+        hit_handled_(world_.states().NumElements() *
+                         world_.hits().NumElements(),
+                     false),
+        hit_layers_(world_.hits().NumElements()),
+        hit_layer_handlers_(world_.hits().NumElements() *
+                                world_.layers().NumElements(),
+                            0),
+        grid_(shape_),
+        grid_render_(shape_) {}
 
   Grid(Grid&&) = default;
 
   // Sets which pieces to update during `update`. `group` - The set of pieces to
   // update. `probability` - The probability of updating any individual piece
   // within the set. `start_frame` - The number of frames as state for any piece
-  // before the piece begins updating.
+  // before the piece begins updating. `batch` - Whether the selected pieces
+  // are passed to StateCallback::OnUpdateBatch, one call per state, rather
+  // than to OnUpdate one piece at a time.
   void SetUpdateInfo(Update update, Group group, double probability,
-                     int start_frame) {
+                     int start_frame, bool batch = false) {
     auto& info = update_infos_[update];
     info.group = group;
     info.probability = probability;
     info.start_frame = start_frame;
+    info.batch = batch;
   }
 
   void SetCallback(State state, std::unique_ptr<StateCallback> callback);
@@ -207,6 +256,17 @@ class Grid {
   absl::optional<FindPieceResult> RayCastDirection(
       Layer layer, math::Position2d start, math::Vector2d Direction) const;
 
+  // Casts one ray per element of `starts`, from `starts[i]` in direction
+  // `directions[i]`, and writes the outcome to `results[i]`. Rays follow the
+  // same traversal as RayCastDirection and stop at the first position where
+  // any of `layers` is occupied; the result holds the piece on the lowest of
+  // those layers. A ray starting off the grid has distance 0 and no piece.
+  // `directions` and `results` must be the same size as `starts`.
+  void RayCastBatch(absl::Span<const Layer> layers,
+                    absl::Span<const math::Position2d> starts,
+                    absl::Span<const math::Vector2d> directions,
+                    absl::Span<RayCastBatchResult> results);
+
   // Returns piece at `position` and `layer`.
   Piece GetPieceAtPosition(Layer layer, math::Position2d position);
 
@@ -224,6 +284,16 @@ class Grid {
                                                 math::Position2d corner0,
                                                 math::Position2d corner1);
 
+  // Overloads of the above that replace the contents of `result`, so callers
+  // can reuse its storage between queries.
+  void DiscFindAll(Layer layer, math::Position2d center, int radius,
+                   std::vector<FindPieceResult>* result);
+  void DiamondFindAll(Layer layer, math::Position2d center, int radius,
+                      std::vector<FindPieceResult>* result);
+  void RectangleFindAll(Layer layer, math::Position2d corner0,
+                        math::Position2d corner1,
+                        std::vector<FindPieceResult>* result);
+
   Piece RandomPieceByGroup(Group group_handle, std::mt19937_64* random) {
     if (group_handle.IsEmpty()) {
       return Piece();
@@ -329,6 +399,10 @@ class Grid {
 
   const World& GetWorld() const { return world_; }
 
+  const ActionQueueStats& GetActionQueueStats() const {
+    return action_queue_stats_;
+  }
+
   void Connect(Piece piece1, Piece piece2) {
     action_queue_.push_back({piece1, ActionConnect{piece2}});
   }
@@ -387,6 +461,29 @@ class Grid {
     Group group = Group();
     int start_frame = 0;
     double probability = 0.0;
+    bool batch = false;
+  };
+
+  // A piece selected for a batched update.
+  struct BatchedUpdate {
+    State state;
+    Piece piece;
+    int num_frames_in_state;
+  };
+
+  // Cells covered by a beam relative to the instigator, split into the lines
+  // along which the beam travels until blocked.
+  struct BeamStencil {
+    struct Line {
+      // Range of `offsets`.
+      int begin;
+      int end;
+      // Index of the line to continue with if this line is blocked at its
+      // first cell, which skips the rest of that side of the beam.
+      int next_if_blocked;
+    };
+    std::vector<math::Vector2d> offsets;
+    std::vector<Line> lines;
   };
 
   struct SpriteAction {
@@ -445,6 +542,12 @@ class Grid {
     Piece piece;
     ActionType action_type;
   };
+  // Merges consecutive actions on the same piece where the result does not
+  // depend on running each of them: orientation changes, and repeated
+  // disconnects. None of these can fail or call back into the level.
+  void CoalesceActions();
+  static bool IsDisconnect(const ActionType& action);
+
   // All `ProcessAction`s return whether the operation was completed. If the
   // actions is not completed it will be attempted in the next update.
 
@@ -516,6 +619,10 @@ class Grid {
 
   void RunUpdaters(std::mt19937_64* random);
 
+  // Calls OnUpdateBatch for each state of the pieces selected for `update`.
+  void RunBatchedUpdater(Update update, absl::Span<const Piece> selected,
+                         int start_frame);
+
   void ConnectActual(Piece piece1, Piece piece2);
   void DisconnectActual(Piece piece);
   void DisconnectAllActual(Piece piece);
@@ -543,12 +650,24 @@ class Grid {
 
   void HitBeamActual(Piece instigator, Hit hit, int length, int radius);
 
-  // Hits until all points until blocked from `trans.position` to `length` steps
-  // forwards (`trans.orientation` relative.) Returns the hit response of the
-  // first position only.
-  HitResponse CheckHitLineSegment(Piece instigator, Hit hit,
-                                  const World::HitData& hit_data,
-                                  math::Transform2d trans, int length);
+  // Returns the cached stencil of a beam of `length` and `radius` fired
+  // towards `orientation`.
+  const BeamStencil& GetBeamStencil(int length, int radius,
+                                    math::Orientation2d orientation);
+
+  // Hits all cells of `line` offset from `start` until blocked. Returns the
+  // hit response of the first cell only.
+  HitResponse CheckHitLine(Piece instigator, Hit hit,
+                           const World::HitData& hit_data,
+                           const math::Transform2d& start,
+                           const BeamStencil& stencil,
+                           const BeamStencil::Line& line);
+
+  // Returns whether pieces in `state` respond to `hit`.
+  bool HandlesHit(State state, Hit hit) const {
+    return hit_handled_[state.Value() * world_.hits().NumElements() +
+                        hit.Value()];
+  }
 
   // Returns whether the hit was blocked.
   HitResponse DoHit(Piece instigator, Hit hit, const math::Transform2d& trans,
@@ -557,6 +676,38 @@ class Grid {
   void SetSprite(CellIndex cell, SpriteInstance sprite);
   void SetSpriteUntilNextUpdate(CellIndex cell, SpriteInstance sprite);
 
+  // Sets the piece occupying `cell` and keeps `free_cell_indices_` and
+  // `layer_occupancy_` in sync. All writes to `grid_` go through here.
+  void SetCell(CellIndex cell, Piece piece);
+
+  // Returns the index of free cells of `group` on `layer`, building it on
+  // first use.
+  FreeCellIndex& GetFreeCellIndex(Group group, Layer layer);
+
+  // Re-files `piece` in `free_cell_indices_` after its state, layer or
+  // position changed.
+  void UpdateFreeCellIndices(Piece piece);
+  void RemoveFromFreeCellIndices(Piece piece);
+  void AddToFreeCellIndex(Piece piece, FreeCellIndex* index) const;
+
+  // Number of words per position in `layer_occupancy_`.
+  int LayerOccupancyWords() const { return (shape_.layer_count() + 63) / 64; }
+
+  // Fills `layer_occupancy_` from `grid_`.
+  void BuildLayerOccupancy();
+
+  // Returns the words of `layer_occupancy_` for the position of `cell`, or
+  // null if no cell in its chunk is occupied.
+  const std::uint64_t* LayerOccupancy(CellIndex cell) const;
+
+  // Sets or clears the bit of `cell` in `layer_occupancy_`.
+  void SetLayerOccupied(CellIndex cell, bool occupied);
+
+  // Returns the position of `cell` in a FreeCellIndex.
+  int PositionIndex(CellIndex cell) const {
+    return shape_.ToPositionIndex(cell);
+  }
+
   // Position and layer must be valid and within the grid.
   void FindPiece(math::Position2d position, Layer layer,
                  std::vector<FindPieceResult>* result);
@@ -569,17 +720,44 @@ class Grid {
 
   ObjectPool<Piece, PieceData> piece_data_;
   FixedHandleMap<State, std::unique_ptr<StateCallback>> callbacks_;
-  FixedHandleMap<CellIndex, Piece> grid_;
-  FixedHandleMap<CellIndex, SpriteInstance> grid_render_;
+  // Indexed by state and hit; see HandlesHit.
+  std::vector<bool> hit_handled_;
+  // Layers holding states that respond to each hit, in ascending order.
+  FixedHandleMap<Hit, std::vector<Layer>> hit_layers_;
+  // Indexed by hit and layer; number of states on the layer that respond to
+  // the hit.
+  std::vector<int> hit_layer_handlers_;
+  absl::flat_hash_map<std::tuple<int, int, int>, BeamStencil> beam_stencils_;
+  ChunkedCellMap<Piece> grid_;
+  ChunkedCellMap<SpriteInstance> grid_render_;
   int frame_counter_ = 0;
 
+  // One entry per (group, layer) pair used as a TeleportToGroup target.
+  std::vector<FreeCellIndex> free_cell_indices_;
+
+  // One bit per layer for each position, set when the cell is occupied. Stored
+  // per chunk of `shape_`; a chunk is allocated when one of its cells is first
+  // occupied. Empty until the first RayCastBatch.
+  std::vector<std::vector<std::uint64_t>> layer_occupancy_;
+  // Scratch space for RayCastBatch.
+  std::vector<std::uint64_t> ray_layer_mask_;
+  std::vector<Layer> ray_layers_;
+
   std::vector<Action> action_queue_;
+  // Scratch space for DoUpdate, kept to reuse its capacity.
+  std::vector<Action> action_queue_processing_;
+  ActionQueueStats action_queue_stats_;
   std::vector<SpriteAction> set_sprite_queue_;
 
   std::vector<SpriteAction> temp_sprite_locations_;
   std::vector<SpriteAction> temp_sprite_locations_immediate_;
   std::vector<Piece> to_remove_;
   bool in_update_ = false;
+
+  // Scratch space for RunBatchedUpdater.
+  std::vector<BatchedUpdate> batched_updates_;
+  std::vector<Piece> batch_pieces_;
+  std::vector<int> batch_frames_;
 };
 
 }  // namespace deepmind::lab2d
@@ -0,0 +1,308 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/system/grid_world/collections/fixed_handle_map.h"
+#include "dmlab2d/lib/system/grid_world/grid.h"
+#include "dmlab2d/lib/system/grid_world/grid_shape.h"
+#include "dmlab2d/lib/system/grid_world/grid_view.h"
+#include "dmlab2d/lib/system/grid_world/grid_window.h"
+#include "dmlab2d/lib/system/grid_world/handles.h"
+#include "dmlab2d/lib/system/grid_world/world.h"
+#include "dmlab2d/lib/system/math/math2d.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+struct SpawnWorld {
+  explicit SpawnWorld(const World::Args& args)
+      : world(args),
+        spawn_state(world.states().ToHandle("Spawn")),
+        player_state(world.states().ToHandle("Player")),
+        dead_state(world.states().ToHandle("Dead")),
+        spawn_group(world.groups().ToHandle("spawnPoints")) {}
+  World world;
+  State spawn_state;
+  State player_state;
+  State dead_state;
+  Group spawn_group;
+};
+
+World::Args SpawnWorldArgs() {
+  World::Args args = {};
+  args.render_order = {"pieces"};
+  args.states["Spawn"] = World::StateArg{"spawns", "Spawn", {"spawnPoints"}};
+  args.states["Player"] = World::StateArg{"pieces", "Player"};
+  args.states["Dead"] = World::StateArg{};
+  return args;
+}
+
+// Creates `num_spawns` spawn points, the first `num_players` of which are
+// occupied by the returned players.
+std::vector<Piece> PlaceSpawnPoints(const SpawnWorld& spawn_world,
+                                    int num_spawns, int num_players,
+                                    Grid* grid) {
+  const int width = grid->GetShape().GridSize2d().width;
+  std::vector<Piece> players;
+  for (int i = 0; i < num_spawns; ++i) {
+    const math::Transform2d transform = {{i % width, i / width},
+                                         math::Orientation2d::kNorth};
+    grid->CreateInstance(spawn_world.spawn_state, transform);
+    if (i < num_players) {
+      players.push_back(
+          grid->CreateInstance(spawn_world.player_state, transform));
+    }
+  }
+  return players;
+}
+
+math::Size2d GridSizeFor(int num_spawns) {
+  return {100, (num_spawns + 99) / 100};
+}
+
+// Respawns one player per iteration into a group of state.range(0) spawn
+// points of which 90% are occupied, as avatars do when they are zapped and
+// come back. Each iteration removes a player from the grid and teleports it
+// back to a random free spawn point.
+void BM_TeleportToGroup(benchmark::State& state) {
+  const int num_spawns = state.range(0);
+  const int num_players = num_spawns * 9 / 10;
+  const SpawnWorld spawn_world(SpawnWorldArgs());
+  Grid grid(spawn_world.world, GridSizeFor(num_spawns),
+            GridShape::Topology::kBounded);
+  std::vector<Piece> players =
+      PlaceSpawnPoints(spawn_world, num_spawns, num_players, &grid);
+
+  std::mt19937_64 random(0);
+  std::uniform_int_distribution<int> pick(0, num_players - 1);
+  for (auto _ : state) {
+    const Piece player = players[pick(random)];
+    grid.SetState(player, spawn_world.dead_state);
+    grid.DoUpdate(&random);
+    grid.TeleportToGroup(player, spawn_world.spawn_group,
+                         spawn_world.player_state,
+                         Grid::TeleportOrientation::kPickRandom);
+    grid.DoUpdate(&random);
+  }
+}
+
+BENCHMARK(BM_TeleportToGroup)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Runs one update per iteration while a player waits for a spawn point in a
+// group of state.range(0) spawn points that are all occupied. The teleport
+// fails and is retried on every flush of the update.
+void BM_TeleportToFullGroup(benchmark::State& state) {
+  const int num_spawns = state.range(0);
+  const SpawnWorld spawn_world(SpawnWorldArgs());
+  Grid grid(spawn_world.world, GridSizeFor(num_spawns),
+            GridShape::Topology::kBounded);
+  PlaceSpawnPoints(spawn_world, num_spawns, num_spawns, &grid);
+  const Piece waiting = grid.CreateInstance(
+      spawn_world.dead_state, {{0, 0}, math::Orientation2d::kNorth});
+
+  std::mt19937_64 random(0);
+  grid.TeleportToGroup(waiting, spawn_world.spawn_group,
+                       spawn_world.player_state,
+                       Grid::TeleportOrientation::kPickRandom);
+  for (auto _ : state) {
+    grid.DoUpdate(&random);
+  }
+}
+
+BENCHMARK(BM_TeleportToFullGroup)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Responds to hits without blocking them, like an avatar that records being
+// zapped, or ignores hits, like a piece whose state has no onHit.
+class HitCallback : public Grid::StateCallback {
+ public:
+  explicit HitCallback(bool handles_hit) : handles_hit_(handles_hit) {}
+  void OnAdd(Piece piece) override {}
+  void OnRemove(Piece piece) override {}
+  void OnUpdate(Update update, Piece piece, int num_frames_in_state) override {}
+  void OnBlocked(Piece piece, Piece blocker) override {}
+  void OnEnter(Contact contact, Piece piece, Piece instigator) override {}
+  void OnLeave(Contact contact, Piece piece, Piece instigator) override {}
+  Grid::HitResponse OnHit(Hit hit, Piece piece, Piece instigator) override {
+    ++num_hits_;
+    return Grid::HitResponse::kContinue;
+  }
+  bool HandlesHit(Hit hit) const override { return handles_hit_; }
+
+ private:
+  bool handles_hit_;
+  int num_hits_ = 0;
+};
+
+// Fires one beam of length 3 and radius state.range(0) from each of 16
+// avatars per iteration, on a 32x32 grid whose floor is covered with grass and
+// every other cell with an apple. Only the avatars respond to the beam.
+void BM_HitBeam(benchmark::State& state) {
+  constexpr int kSize = 32;
+  constexpr int kNumAvatars = 16;
+  World::Args args = {};
+  args.render_order = {"floor", "fruit", "pieces", "beam"};
+  args.states["Grass"] = World::StateArg{"floor", "Grass"};
+  args.states["Apple"] = World::StateArg{"fruit", "Apple"};
+  args.states["Avatar"] = World::StateArg{"pieces", "Avatar"};
+  args.hits["zap"] = World::HitArg{"beam", "Beam"};
+  const World world(args);
+  const State grass = world.states().ToHandle("Grass");
+  const State apple = world.states().ToHandle("Apple");
+  const State avatar = world.states().ToHandle("Avatar");
+  const Hit zap = world.hits().ToHandle("zap");
+
+  Grid grid(world, math::Size2d{kSize, kSize}, GridShape::Topology::kBounded);
+  grid.SetCallback(grass, std::make_unique<HitCallback>(false));
+  grid.SetCallback(apple, std::make_unique<HitCallback>(false));
+  grid.SetCallback(avatar, std::make_unique<HitCallback>(true));
+  for (int y = 0; y < kSize; ++y) {
+    for (int x = 0; x < kSize; ++x) {
+      const math::Transform2d transform = {{x, y}, math::Orientation2d::kNorth};
+      grid.CreateInstance(grass, transform);
+      if ((x + y) % 2 == 0) {
+        grid.CreateInstance(apple, transform);
+      }
+    }
+  }
+  std::vector<Piece> avatars;
+  for (int i = 0; i < kNumAvatars; ++i) {
+    const math::Orientation2d orientation =
+        static_cast<math::Orientation2d>(i % 4);
+    avatars.push_back(grid.CreateInstance(
+        avatar, {{2 + 7 * (i % 4), 2 + 7 * (i / 4)}, orientation}));
+  }
+
+  std::mt19937_64 random(0);
+  const int radius = state.range(0);
+  for (auto _ : state) {
+    for (Piece piece : avatars) {
+      grid.HitBeam(piece, zap, /*length=*/3, radius);
+    }
+    grid.DoUpdate(&random);
+  }
+}
+
+BENCHMARK(BM_HitBeam)->Arg(0)->Arg(1)->Arg(3);
+
+// Runs one update per iteration in which each of state.range(0) avatars on a
+// 64x64 grid faces a direction, turns and steps forward, as an avatar's
+// onUpdate does for a policy's turn and move actions.
+void BM_QueueActions(benchmark::State& state) {
+  constexpr int kSize = 64;
+  World::Args args = {};
+  args.render_order = {"pieces"};
+  args.states["Avatar"] = World::StateArg{"pieces", "Avatar"};
+  const World world(args);
+  const State avatar = world.states().ToHandle("Avatar");
+
+  Grid grid(world, math::Size2d{kSize, kSize}, GridShape::Topology::kTorus);
+  const int num_avatars = state.range(0);
+  std::vector<Piece> avatars;
+  for (int i = 0; i < num_avatars; ++i) {
+    avatars.push_back(grid.CreateInstance(
+        avatar, {{i % kSize, 4 * (i / kSize)}, math::Orientation2d::kNorth}));
+  }
+
+  std::mt19937_64 random(0);
+  std::uniform_int_distribution<int> direction(0, 3);
+  for (auto _ : state) {
+    for (Piece piece : avatars) {
+      grid.SetPieceOrientation(
+          piece, static_cast<math::Orientation2d>(direction(random)));
+      grid.RotatePiece(piece, static_cast<math::Rotate2d>(direction(random)));
+      grid.PushPiece(piece, math::Orientation2d::kNorth,
+                     Grid::Perspective::kPiece);
+    }
+    grid.DoUpdate(&random);
+  }
+  const Grid::ActionQueueStats& stats = grid.GetActionQueueStats();
+  state.SetItemsProcessed(stats.processed + stats.coalesced);
+  state.counters["processed"] = benchmark::Counter(
+      stats.processed, benchmark::Counter::kAvgIterations);
+  state.counters["coalesced"] = benchmark::Counter(
+      stats.coalesced, benchmark::Counter::kAvgIterations);
+  state.counters["deferred"] = benchmark::Counter(
+      stats.deferred, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_QueueActions)->Arg(64)->Arg(1024);
+
+// Renders one centred view of state.range(0) x state.range(0) cells per
+// iteration of a 64x64 grid with a floor piece on every position and an avatar
+// on every fourth. The view moves across the grid between iterations, so torus
+// views wrap around the edges and bounded views are partly out of bounds.
+void RunRender(benchmark::State& state, GridShape::Topology topology) {
+  constexpr int kSize = 64;
+  World::Args args = {};
+  args.render_order = {"floor", "pieces"};
+  args.states["Floor"] = World::StateArg{"floor", "Floor"};
+  args.states["Avatar"] = World::StateArg{"pieces", "Avatar"};
+  const World world(args);
+  const State floor = world.states().ToHandle("Floor");
+  const State avatar = world.states().ToHandle("Avatar");
+
+  Grid grid(world, math::Size2d{kSize, kSize}, topology);
+  for (int y = 0; y < kSize; ++y) {
+    for (int x = 0; x < kSize; ++x) {
+      grid.CreateInstance(floor, {{x, y}, math::Orientation2d::kNorth});
+      if ((x + y) % 4 == 0) {
+        grid.CreateInstance(avatar, {{x, y}, math::Orientation2d::kEast});
+      }
+    }
+  }
+
+  FixedHandleMap<Sprite, Sprite> sprite_map(world.sprites().NumElements());
+  for (std::size_t i = 0; i < sprite_map.size(); ++i) {
+    sprite_map[Sprite(i)] = Sprite(i);
+  }
+  const int radius = state.range(0) / 2;
+  const GridView grid_view(
+      GridWindow(/*centered=*/true, radius, radius, radius, radius),
+      world.NumRenderLayers(), std::move(sprite_map),
+      world.out_of_bounds_sprite(), world.out_of_view_sprite());
+  std::vector<int> output_sprites(grid_view.NumCells());
+
+  math::Transform2d transform = {{0, 0}, math::Orientation2d::kNorth};
+  for (auto _ : state) {
+    grid.Render(transform, grid_view, absl::MakeSpan(output_sprites));
+    benchmark::DoNotOptimize(output_sprites.data());
+    transform.position = {(transform.position.x + 7) % kSize,
+                          (transform.position.y + 5) % kSize};
+  }
+  state.SetItemsProcessed(state.iterations() * grid_view.NumCells());
+}
+
+void BM_RenderBounded(benchmark::State& state) {
+  RunRender(state, GridShape::Topology::kBounded);
+}
+
+BENCHMARK(BM_RenderBounded)->Arg(11)->Arg(41);
+
+void BM_RenderTorus(benchmark::State& state) {
+  RunRender(state, GridShape::Topology::kTorus);
+}
+
+BENCHMARK(BM_RenderTorus)->Arg(11)->Arg(41);
+
+}  // namespace
+}  // namespace deepmind::lab2d
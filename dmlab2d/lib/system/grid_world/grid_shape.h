@@ -17,6 +17,8 @@
 #ifndef DMLAB2D_LIB_SYSTEM_GRID_WORLD_GRID_SHAPE_H_
 #define DMLAB2D_LIB_SYSTEM_GRID_WORLD_GRID_SHAPE_H_
 
+#include <algorithm>
+
 #include "absl/log/log.h"
 #include "dmlab2d/lib/system/grid_world/handles.h"
 #include "dmlab2d/lib/system/math/math2d.h"
@@ -24,14 +26,38 @@
 namespace deepmind::lab2d {
 
 // Stores the shape of a 2D grid with layers.
+//
+// Grids with more than kMaxDensePositions positions are split into chunks of
+// kChunkSize x kChunkSize positions, so that storage for a chunk can be
+// allocated when it is first used (see ChunkedCellMap). A cell-index is then
+// `chunk << chunk_cell_bits() | cell_in_chunk`. Smaller grids are a single
+// chunk holding all positions in row-major order. In both layouts the cells of
+// a position are consecutive, one per layer.
 class GridShape {
  public:
   enum class Topology { kBounded, kTorus };
+
+  static constexpr int kMaxDensePositions = 512 * 512;
+  static constexpr int kChunkShift = 5;
+  static constexpr int kChunkSize = 1 << kChunkShift;
+
   constexpr GridShape(math::Size2d grid_size_2d, int layer_count,
                       Topology topology)
       : grid_size_2d_(grid_size_2d),
         layer_count_(layer_count),
-        topology_(topology) {}
+        topology_(topology),
+        chunked_(grid_size_2d.Area() > kMaxDensePositions),
+        chunks_per_row_(chunked_ ? (grid_size_2d.width + kChunkSize - 1) >>
+                                       kChunkShift
+                                 : 1),
+        chunk_count_(chunked_ ? chunks_per_row_ *
+                                    ((grid_size_2d.height + kChunkSize - 1) >>
+                                     kChunkShift)
+                              : 1),
+        chunk_position_count_(chunked_ ? kChunkSize * kChunkSize
+                                       : grid_size_2d.Area()),
+        chunk_cell_bits_(
+            BitWidth(std::max(chunk_position_count_ * layer_count - 1, 0))) {}
 
   // Returns whether `position` is within the bounds of the grid.
   constexpr bool InBounds(math::Position2d position) const {
@@ -79,6 +105,9 @@ class GridShape {
       position.x = ModuloWidth(position.x);
       position.y = ModuloHeight(position.y);
     }
+    if (chunked_) {
+      return ToChunkedCellIndex(position, layer);
+    }
     return CellIndex((position.y * grid_size_2d_.width + position.x) *
                          layer_count() +
                      layer.Value());
@@ -100,6 +129,63 @@ class GridShape {
     return grid_size_2d_.Area() * layer_count_;
   }
 
+  // Returns a dense index in [0, GetPositionCount()) of an in-bounds,
+  // normalised `position`.
+  constexpr int ToPositionIndex(math::Position2d position) const {
+    if (!chunked_) {
+      return position.y * grid_size_2d_.width + position.x;
+    }
+    return ChunkOf(position) * chunk_position_count_ +
+           PositionInChunk(position);
+  }
+
+  // Returns ToPositionIndex of the position holding `cell`.
+  int ToPositionIndex(CellIndex cell) const {
+    return (cell.Value() >> chunk_cell_bits_) * chunk_position_count_ +
+           (cell.Value() & ((1 << chunk_cell_bits_) - 1)) / layer_count_;
+  }
+
+  // Returns the layer of `cell`.
+  Layer ToLayer(CellIndex cell) const {
+    return Layer((cell.Value() & ((1 << chunk_cell_bits_) - 1)) % layer_count_);
+  }
+
+  // Returns the number of position indices. This is the area of the grid
+  // rounded up to whole chunks.
+  constexpr int GetPositionCount() const {
+    return chunk_count_ * chunk_position_count_;
+  }
+
+  // Returns the number of positions from an in-bounds, normalised `position`
+  // towards +x, before the end of the row or chunk, whose cells are at a
+  // fixed stride of layer_count() cell-indices.
+  constexpr int RowRunLength(math::Position2d position) const {
+    const int to_row_end = grid_size_2d_.width - position.x;
+    if (!chunked_) {
+      return to_row_end;
+    }
+    const int to_chunk_end = kChunkSize - (position.x & (kChunkSize - 1));
+    return to_chunk_end < to_row_end ? to_chunk_end : to_row_end;
+  }
+
+  // Returns whether the grid is stored in more than one chunk.
+  constexpr bool chunked() const { return chunked_; }
+
+  // Returns the number of chunks.
+  constexpr int chunk_count() const { return chunk_count_; }
+
+  // Returns the number of positions in each chunk.
+  constexpr int chunk_position_count() const { return chunk_position_count_; }
+
+  // Returns the number of cells in each chunk.
+  constexpr int chunk_cell_count() const {
+    return chunk_position_count_ * layer_count_;
+  }
+
+  // Returns the number of low bits of a cell-index that select a cell within
+  // its chunk.
+  constexpr int chunk_cell_bits() const { return chunk_cell_bits_; }
+
   // Returns the width and height of the grid.
   constexpr math::Size2d GridSize2d() const { return grid_size_2d_; }
 
@@ -120,9 +206,39 @@ class GridShape {
     return output;
   }
 
+  // Returns the number of bits needed to represent `value`.
+  static constexpr int BitWidth(int value) {
+    int bits = 0;
+    for (; value > 0; value >>= 1) {
+      ++bits;
+    }
+    return bits;
+  }
+
+  CellIndex ToChunkedCellIndex(math::Position2d position, Layer layer) const {
+    return CellIndex(ChunkOf(position) << chunk_cell_bits_ |
+                     (PositionInChunk(position) * layer_count() +
+                      layer.Value()));
+  }
+
+  constexpr int ChunkOf(math::Position2d position) const {
+    return (position.y >> kChunkShift) * chunks_per_row_ +
+           (position.x >> kChunkShift);
+  }
+
+  static constexpr int PositionInChunk(math::Position2d position) {
+    return (position.y & (kChunkSize - 1)) << kChunkShift |
+           (position.x & (kChunkSize - 1));
+  }
+
   const math::Size2d grid_size_2d_;
   const int layer_count_;
   const Topology topology_;
+  const bool chunked_;
+  const int chunks_per_row_;
+  const int chunk_count_;
+  const int chunk_position_count_;
+  const int chunk_cell_bits_;
 };
 
 }  // namespace deepmind::lab2d
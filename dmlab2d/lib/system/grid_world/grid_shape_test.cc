@@ -136,6 +136,58 @@ TEST(GridShapeTest, GetCellCountWorks) {
   EXPECT_THAT(grid_shape.GetCellCount(), Eq(5 * 3 * 2));
 }
 
+TEST(GridShapeTest, SmallGridIsOneChunk) {
+  const GridShape grid_shape(/*grid_size_2d=*/math::Size2d{5, 3},
+                             /*layer_count=*/2, GridShape::Topology::kBounded);
+  EXPECT_THAT(grid_shape.chunked(), IsFalse());
+  EXPECT_THAT(grid_shape.chunk_count(), Eq(1));
+  EXPECT_THAT(grid_shape.chunk_cell_count(), Eq(5 * 3 * 2));
+  EXPECT_THAT(grid_shape.GetPositionCount(), Eq(5 * 3));
+  EXPECT_THAT(grid_shape.ToPositionIndex(math::Position2d{4, 2}), Eq(14));
+  EXPECT_THAT(grid_shape.ToPositionIndex(CellIndex(2 * 14 + 1)), Eq(14));
+  EXPECT_THAT(grid_shape.ToLayer(CellIndex(2 * 14 + 1)), Eq(Layer(1)));
+  EXPECT_THAT(grid_shape.RowRunLength(math::Position2d{1, 2}), Eq(4));
+}
+
+TEST(GridShapeTest, LargeGridIsChunked) {
+  constexpr int kChunkSize = GridShape::kChunkSize;
+  const GridShape grid_shape(
+      /*grid_size_2d=*/math::Size2d{1000, 1000},
+      /*layer_count=*/3, GridShape::Topology::kTorus);
+  EXPECT_THAT(grid_shape.chunked(), IsTrue());
+  // 1000 positions need 32 chunks per row.
+  EXPECT_THAT(grid_shape.chunk_count(), Eq(32 * 32));
+  EXPECT_THAT(grid_shape.chunk_cell_count(), Eq(kChunkSize * kChunkSize * 3));
+  EXPECT_THAT(grid_shape.GetPositionCount(),
+              Eq(32 * 32 * kChunkSize * kChunkSize));
+
+  // Layers of a position and positions along a chunk row are consecutive.
+  const CellIndex cell = grid_shape.ToCellIndex({33, 65}, Layer(0));
+  EXPECT_THAT(grid_shape.ToCellIndex({33, 65}, Layer(2)),
+              Eq(CellIndex(cell.Value() + 2)));
+  EXPECT_THAT(grid_shape.ToCellIndex({34, 65}, Layer(0)),
+              Eq(CellIndex(cell.Value() + 3)));
+  EXPECT_THAT(grid_shape.RowRunLength({33, 65}), Eq(kChunkSize - 1));
+  EXPECT_THAT(grid_shape.RowRunLength({993, 65}), Eq(7));
+  EXPECT_THAT(grid_shape.ToCellIndex({33 - 1000, 65 + 1000}, Layer(0)),
+              Eq(cell));
+
+  // Position indices are distinct and dense.
+  const int position = grid_shape.ToPositionIndex(math::Position2d{33, 65});
+  EXPECT_THAT(grid_shape.ToPositionIndex(cell), Eq(position));
+  // Chunks start at multiples of a power of two, not of the layer count.
+  for (int layer = 0; layer < 3; ++layer) {
+    EXPECT_THAT(
+        grid_shape.ToLayer(grid_shape.ToCellIndex({33, 65}, Layer(layer))),
+        Eq(Layer(layer)));
+  }
+  EXPECT_THAT(grid_shape.ToPositionIndex(math::Position2d{34, 65}),
+              Eq(position + 1));
+  EXPECT_THAT(grid_shape.ToPositionIndex(math::Position2d{999, 999}),
+              Eq(grid_shape.GetPositionCount() - kChunkSize * kChunkSize +
+                 (999 % kChunkSize) * kChunkSize + 999 % kChunkSize));
+}
+
 TEST(GridShapeTest, GridSize2dWorks) {
   const GridShape grid_shape(/*grid_size_2d=*/math::Size2d{5, 3},
                              /*layer_count=*/2, GridShape::Topology::kBounded);
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -47,6 +49,7 @@ namespace {
 
 using ::testing::_;
 using ::testing::AnyOf;
+using ::testing::DoubleEq;
 using ::testing::Each;
 using ::testing::ElementsAre;
 using ::testing::Eq;
@@ -97,6 +100,11 @@ class MockStateCallback : public Grid::StateCallback {
               (Update update, Piece piece, int num_frames_in_state),
               (override));
 
+  MOCK_METHOD(void, OnUpdateBatch,
+              (Update update, absl::Span<const Piece> pieces,
+               absl::Span<const int> num_frames_in_state),
+              (override));
+
   MOCK_METHOD(void, OnBlocked, (Piece mover, Piece blocker), (override));
 
   MOCK_METHOD(void, OnEnter, (Contact contact, Piece piece, Piece instigator),
@@ -410,6 +418,51 @@ TEST(GridTest, UpdateWorks) {
   EXPECT_THAT(grid.GetPieceFrames(player3), Eq(0));
 }
 
+TEST(GridTest, BatchedUpdateWorks) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.update_order = {{"one"}};
+  args.states["Player"].group_names = {"things"};
+  args.states["Apple"].group_names = {"things"};
+  const World world(args);
+  const Update update = world.updates().ToHandle("one");
+  Grid grid(world, math::Size2d{3, 1}, GridShape::Topology::kBounded);
+  const State player = world.states().ToHandle("Player");
+  const State apple = world.states().ToHandle("Apple");
+  Piece player0 = grid.CreateInstance(player, {{0, 0}});
+  Piece player1 = grid.CreateInstance(player, {{1, 0}});
+  Piece player2 = grid.CreateInstance(player, {{2, 0}});
+  Piece apple0 = grid.CreateInstance(apple, {{0, 0}});
+
+  auto mock_player_callback = std::make_unique<MockStateCallback>();
+  auto mock_apple_callback = std::make_unique<MockStateCallback>();
+  EXPECT_CALL(*mock_player_callback, OnUpdate(_, _, _)).Times(0);
+  EXPECT_CALL(*mock_apple_callback, OnUpdate(_, _, _)).Times(0);
+  EXPECT_CALL(*mock_player_callback,
+              OnUpdateBatch(update,
+                            UnorderedElementsAre(player0, player1, player2),
+                            ElementsAre(0, 0, 0)));
+  EXPECT_CALL(*mock_player_callback,
+              OnUpdateBatch(update,
+                            UnorderedElementsAre(player0, player1, player2),
+                            ElementsAre(1, 1, 1)));
+  EXPECT_CALL(*mock_apple_callback,
+              OnUpdateBatch(update, ElementsAre(apple0), ElementsAre(0)));
+  EXPECT_CALL(*mock_apple_callback,
+              OnUpdateBatch(update, ElementsAre(apple0), ElementsAre(1)));
+  grid.SetCallback(player, std::move(mock_player_callback));
+  grid.SetCallback(apple, std::move(mock_apple_callback));
+
+  grid.SetUpdateInfo(update, world.groups().ToHandle("things"),
+                     /*probability=*/1.0, /*start_frame=*/0, /*batch=*/true);
+  grid.DoUpdate(&random);
+  // Not updated as it is in its first frame.
+  grid.CreateInstance(apple, {{2, 0}});
+  grid.SetUpdateInfo(update, world.groups().ToHandle("things"),
+                     /*probability=*/1.0, /*start_frame=*/1, /*batch=*/true);
+  grid.DoUpdate(&random);
+}
+
 TEST(GridTest, SetStateSameLayerWorks) {
   std::mt19937_64 random;
   const World world(CreateWorldArgs());
@@ -954,6 +1007,76 @@ TEST(GridTest, RenderTorusWorks) {
       Eq(kGridRenderTorusSouthResult));
 }
 
+TEST(GridTest, ChunkedGridMatchesSmallGrid) {
+  const World world(CreateWorldArgs());
+  const GridView view = CreateGridView(world, /*left=*/2, /*right=*/2,
+                                       /*forward=*/4, /*backward=*/0);
+  CharMap char_to_state = {};
+  char_to_state['P'] = world.states().ToHandle("Player");
+  char_to_state['*'] = world.states().ToHandle("Wall");
+  char_to_state['A'] = world.states().ToHandle("Apple");
+  const math::Size2d pattern_size = GetSize2dOfText(kGridRenderTorus);
+  for (auto topology :
+       {GridShape::Topology::kBounded, GridShape::Topology::kTorus}) {
+    Grid small(world, pattern_size, topology);
+    PlaceGrid(char_to_state, kGridRenderTorus, math::Orientation2d::kNorth,
+              &small);
+    // The pattern straddles chunk boundaries, and the edges of the torus.
+    Grid large(world, math::Size2d{4096, 4096}, topology);
+    ASSERT_THAT(large.GetShape().chunked(), IsTrue());
+    const math::Vector2d offset = topology == GridShape::Topology::kTorus
+                                      ? math::Vector2d{4094, 4094}
+                                      : math::Vector2d{1021, 3070};
+    Piece small_player;
+    Piece large_player;
+    for (int y = 0; y < pattern_size.height; ++y) {
+      for (int x = 0; x < pattern_size.width; ++x) {
+        for (Piece piece : small.AllPieceHandles({x, y})) {
+          if (piece.IsEmpty()) continue;
+          const Piece copy = large.CreateInstance(
+              small.GetState(piece),
+              {math::Position2d{x, y} + offset, math::Orientation2d::kNorth});
+          ASSERT_THAT(copy, Ne(Piece()));
+          if (small.GetState(piece) == char_to_state['P']) {
+            small_player = piece;
+            large_player = copy;
+          }
+        }
+      }
+    }
+
+    for (auto direction :
+         {math::Orientation2d::kWest, math::Orientation2d::kNorth,
+          math::Orientation2d::kNorth, math::Orientation2d::kEast}) {
+      small.PushPiece(small_player, direction, Grid::Perspective::kGrid);
+      large.PushPiece(large_player, direction, Grid::Perspective::kGrid);
+      std::mt19937_64 random;
+      small.DoUpdate(&random);
+      large.DoUpdate(&random);
+      const math::Transform2d small_transform =
+          small.GetPieceTransform(small_player);
+      const math::Transform2d large_transform =
+          large.GetPieceTransform(large_player);
+      EXPECT_THAT(large_transform.position,
+                  Eq(large.GetShape().Normalised(small_transform.position +
+                                                 offset)));
+      // The view covers exactly the pattern.
+      const math::Transform2d view_transform = {{2, 4},
+                                                math::Orientation2d::kNorth};
+      EXPECT_THAT(
+          RenderToString(view,
+                         {view_transform.position + offset,
+                          view_transform.orientation},
+                         &large),
+          Eq(RenderToString(view, view_transform, &small)));
+      EXPECT_THAT(large.GetPieceAtPosition(
+                      world.layers().ToHandle("pieces"),
+                      large_transform.position),
+                  Eq(large_player));
+    }
+  }
+}
+
 int CenterOffset(const GridView& grid_view, int offset_x, int offset_y,
                  Layer layer) {
   int y = grid_view.GetWindow().forward() + offset_y;
@@ -1277,6 +1400,53 @@ TEST(GridTest, PlayerCanTeleportToGroupAndFlush) {
   EXPECT_THAT(grid.GetPieceTransform(piece3).position.y, Eq(0));
 }
 
+TEST(GridTest, TeleportToGroupFollowsSpawnPoints) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.states["Spawn"].group_names = {"spawns"};
+  const World world(args);
+  State spawn_state = world.states().ToHandle("Spawn");
+  State player_state = world.states().ToHandle("Player");
+  Group spawn_group = world.groups().ToHandle("spawns");
+  ASSERT_FALSE(spawn_group.IsEmpty());
+
+  Grid grid(world, math::Size2d{3, 1}, GridShape::Topology::kBounded);
+  Piece spawn =
+      grid.CreateInstance(spawn_state, {{0, 0}, math::Orientation2d::kNorth});
+  Piece player0 =
+      grid.CreateInstance(player_state, {{0, 0}, math::Orientation2d::kNorth});
+  math::Transform2d off_grid = {{-1, -1}, math::Orientation2d::kEast};
+  Piece player1 = grid.CreateInstance(player_state, off_grid);
+
+  // The only spawn point is occupied.
+  grid.TeleportToGroup(player1, spawn_group, State(),
+                       Grid::TeleportOrientation::kMatchTarget);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(player1).position.y, Eq(-1));
+
+  // Moving the spawn point frees it.
+  grid.TeleportPiece(spawn, {2, 0}, Grid::TeleportOrientation::kKeepOriginal);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(player1).position,
+              Eq(math::Position2d{2, 0}));
+
+  // A piece may teleport to a spawn point it already stands on.
+  grid.TeleportToGroup(player1, spawn_group, State(),
+                       Grid::TeleportOrientation::kMatchTarget);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(player1).position,
+              Eq(math::Position2d{2, 0}));
+
+  // New and released spawn points are picked up.
+  grid.ReleaseInstance(spawn);
+  grid.CreateInstance(spawn_state, {{1, 0}, math::Orientation2d::kNorth});
+  grid.TeleportToGroup(player0, spawn_group, State(),
+                       Grid::TeleportOrientation::kMatchTarget);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(player0).position,
+              Eq(math::Position2d{1, 0}));
+}
+
 constexpr const absl::string_view kPlayerMoveRelative = R"(
    *
  * *
@@ -1486,6 +1656,50 @@ TEST(GridTest, PlayerCanRotate) {
   }
 }
 
+TEST(GridTest, ActionQueueCoalescesAndCountsActions) {
+  std::mt19937_64 random;
+  const World world(CreateWorldArgs());
+  State player_state = world.states().ToHandle("Player");
+  State apple_state = world.states().ToHandle("Apple");
+  Grid grid(world, math::Size2d{3, 1}, GridShape::Topology::kBounded);
+  Piece player0 =
+      grid.CreateInstance(player_state, {{0, 0}, math::Orientation2d::kNorth});
+  Piece player1 =
+      grid.CreateInstance(player_state, {{2, 0}, math::Orientation2d::kNorth});
+  Piece apple =
+      grid.CreateInstance(apple_state, {{2, 0}, math::Orientation2d::kNorth});
+
+  // Consecutive orientation changes and disconnects of one piece merge.
+  grid.RotatePiece(player0, math::Rotate2d::k90);
+  grid.SetPieceOrientation(player0, math::Orientation2d::kSouth);
+  grid.RotatePiece(player0, math::Rotate2d::k90);
+  grid.Disconnect(player0);
+  grid.DisconnectAll(player0);
+  // Interleaved pieces do not.
+  grid.RotatePiece(player1, math::Rotate2d::k90);
+  grid.RotatePiece(player0, math::Rotate2d::k180);
+  grid.RotatePiece(player1, math::Rotate2d::k90);
+  // Blocked by `apple` on every flush.
+  grid.SetState(player1, apple_state);
+  grid.DoUpdate(&random, /*flush_count=*/1);
+
+  EXPECT_THAT(grid.GetPieceTransform(player0).orientation,
+              Eq(math::Orientation2d::kEast));
+  EXPECT_THAT(grid.GetPieceTransform(player1).orientation,
+              Eq(math::Orientation2d::kSouth));
+  EXPECT_THAT(grid.GetState(player1), Eq(player_state));
+  const Grid::ActionQueueStats& stats = grid.GetActionQueueStats();
+  EXPECT_THAT(stats.processed, Eq(5));
+  EXPECT_THAT(stats.coalesced, Eq(3));
+  EXPECT_THAT(stats.deferred, Eq(2));
+
+  grid.ReleaseInstance(apple);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetState(player1), Eq(apple_state));
+  EXPECT_THAT(stats.processed, Eq(6));
+  EXPECT_THAT(stats.deferred, Eq(2));
+}
+
 //
 constexpr const absl::string_view kCanHitBeam = R"(
 ************
@@ -1584,6 +1798,73 @@ TEST(GridTest, CanHitBeamCallBack0) {
               Eq(RemoveLeadingAndTrailingNewLines(kCanHitBeamCallBack0Expect)));
 }
 
+// A callback that never responds to hits.
+class MockHitIgnoringStateCallback : public MockStateCallback {
+ public:
+  bool HandlesHit(Hit) const override { return false; }
+};
+
+TEST(GridTest, HitBeamSkipsPiecesIgnoringHit) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.render_order.push_back("hitLayer0");
+  args.hits["Hit0"] = World::HitArg{"hitLayer0", "ohit"};
+  const World world(args);
+  CharMap char_to_state = {};
+  State wall_state = world.states().ToHandle("Wall");
+  char_to_state['*'] = wall_state;
+  Grid grid(world, GetSize2dOfText(CanHitBeamCallBack0),
+            GridShape::Topology::kBounded);
+  PlaceGrid(char_to_state, CanHitBeamCallBack0, math::Orientation2d::kNorth,
+            &grid);
+
+  auto mock_wall_state_callback =
+      std::make_unique<MockHitIgnoringStateCallback>();
+  EXPECT_CALL(*mock_wall_state_callback.get(), OnHit(_, _, _)).Times(0);
+  grid.SetCallback(wall_state, std::move(mock_wall_state_callback));
+
+  math::Transform2d player_transform = {{0, 4}, math::Orientation2d::kEast};
+  State player_state = world.states().ToHandle("Player");
+  Hit hit = world.hits().ToHandle("Hit0");
+  Piece player = grid.CreateInstance(player_state, player_transform);
+  grid.HitBeam(player, hit, /*length=*/10, /*radius=*/3);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(RemoveLeadingAndTrailingNewLines(grid.ToString()),
+              Eq(RemoveLeadingAndTrailingNewLines(kCanHitBeamExpect)));
+}
+
+TEST(GridTest, HitBeamSkipsPiecesAfterCallbackReplaced) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.render_order.push_back("hitLayer0");
+  args.hits["Hit0"] = World::HitArg{"hitLayer0", "ohit"};
+  const World world(args);
+  CharMap char_to_state = {};
+  State wall_state = world.states().ToHandle("Wall");
+  char_to_state['*'] = wall_state;
+  Grid grid(world, GetSize2dOfText(CanHitBeamCallBack0),
+            GridShape::Topology::kBounded);
+  PlaceGrid(char_to_state, CanHitBeamCallBack0, math::Orientation2d::kNorth,
+            &grid);
+
+  auto mock_blocking_callback = std::make_unique<MockStateCallback>();
+  EXPECT_CALL(*mock_blocking_callback.get(), OnHit(_, _, _)).Times(0);
+  grid.SetCallback(wall_state, std::move(mock_blocking_callback));
+  auto mock_ignoring_callback =
+      std::make_unique<MockHitIgnoringStateCallback>();
+  EXPECT_CALL(*mock_ignoring_callback.get(), OnHit(_, _, _)).Times(0);
+  grid.SetCallback(wall_state, std::move(mock_ignoring_callback));
+
+  math::Transform2d player_transform = {{0, 4}, math::Orientation2d::kEast};
+  State player_state = world.states().ToHandle("Player");
+  Hit hit = world.hits().ToHandle("Hit0");
+  Piece player = grid.CreateInstance(player_state, player_transform);
+  grid.HitBeam(player, hit, /*length=*/10, /*radius=*/3);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(RemoveLeadingAndTrailingNewLines(grid.ToString()),
+              Eq(RemoveLeadingAndTrailingNewLines(kCanHitBeamExpect)));
+}
+
 constexpr const absl::string_view kCanHitBeamCallBack1 = R"(
 ************
            *
@@ -2191,6 +2472,185 @@ TEST(GridTest, RayCastFromOutOfBounds) {
   EXPECT_THAT(leave_grid->position, Eq(math::Position2d{11, 5}));
 }
 
+TEST(GridTest, RayCastBatchMatchesRayCast) {
+  World::Args args = CreateWorldArgs();
+  const World world(args);
+  CharMap char_to_state = {};
+  char_to_state['*'] = world.states().ToHandle("Wall");
+  const math::Size2d grid_size = GetSize2dOfText(kRayCastTest);
+  Grid grid(world, grid_size, GridShape::Topology::kBounded);
+  PlaceGrid(char_to_state, kRayCastTest, math::Orientation2d::kNorth, &grid);
+  const Layer piece_layer = world.layers().ToHandle("pieces");
+
+  std::vector<math::Position2d> starts;
+  std::vector<math::Vector2d> directions;
+  for (math::Position2d start : {math::Position2d{0, 0},
+                                 math::Position2d{grid_size.width - 2, 0},
+                                 math::Position2d{0, grid_size.height - 1}}) {
+    for (int y = -1; y <= grid_size.height; ++y) {
+      for (int x = -1; x <= grid_size.width; ++x) {
+        starts.push_back(start);
+        directions.push_back(math::Position2d{x, y} - start);
+      }
+    }
+  }
+  std::vector<Grid::RayCastBatchResult> results(starts.size());
+  const Layer layers[] = {piece_layer};
+  grid.RayCastBatch(layers, starts, directions, absl::MakeSpan(results));
+
+  for (std::size_t i = 0; i < starts.size(); ++i) {
+    auto expected =
+        grid.RayCastDirection(piece_layer, starts[i], directions[i]);
+    const math::Vector2d offset =
+        expected.has_value() ? expected->position - starts[i] : directions[i];
+    EXPECT_THAT(results[i].piece,
+                Eq(expected.has_value() ? expected->piece : Piece()));
+    EXPECT_THAT(results[i].distance,
+                DoubleEq(std::sqrt(offset.x * offset.x + offset.y * offset.y)));
+  }
+}
+
+TEST(GridTest, RayCastBatchStopsAtAnyLayer) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  const World world(args);
+  const Layer fruit_layer = world.layers().ToHandle("fruit");
+  const Layer piece_layer = world.layers().ToHandle("pieces");
+  const State apple_state = world.states().ToHandle("Apple");
+  const State wall_state = world.states().ToHandle("Wall");
+  Grid grid(world, math::Size2d{5, 1}, GridShape::Topology::kBounded);
+  Piece apple =
+      grid.CreateInstance(apple_state, {{2, 0}, math::Orientation2d::kNorth});
+  Piece wall =
+      grid.CreateInstance(wall_state, {{4, 0}, math::Orientation2d::kNorth});
+
+  const math::Position2d starts[] = {{0, 0}, {0, 0}, {-1, 0}};
+  const math::Vector2d directions[] = {{4, 0}, {-3, 0}, {4, 0}};
+  std::vector<Grid::RayCastBatchResult> results(3);
+  const Layer both[] = {piece_layer, fruit_layer};
+  grid.RayCastBatch(both, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(apple));
+  EXPECT_THAT(results[0].state, Eq(apple_state));
+  EXPECT_THAT(results[0].distance, DoubleEq(2.0));
+  // Leaves the grid.
+  EXPECT_THAT(results[1].piece, Eq(Piece()));
+  EXPECT_THAT(results[1].distance, DoubleEq(0.0));
+  // Starts off the grid.
+  EXPECT_THAT(results[2].piece, Eq(Piece()));
+  EXPECT_THAT(results[2].distance, DoubleEq(0.0));
+
+  const Layer pieces_only[] = {piece_layer};
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(wall));
+  EXPECT_THAT(results[0].state, Eq(wall_state));
+  EXPECT_THAT(results[0].distance, DoubleEq(4.0));
+
+  // Changes to the grid are seen by later casts.
+  grid.ReleaseInstance(apple);
+  grid.TeleportPiece(wall, {3, 0}, Grid::TeleportOrientation::kKeepOriginal);
+  grid.DoUpdate(&random);
+  grid.RayCastBatch(both, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(wall));
+  EXPECT_THAT(results[0].distance, DoubleEq(3.0));
+}
+
+TEST(GridTest, ChunkedGridWithThreeLayers) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.states["Spawn"].group_names = {"spawns"};
+  const World world(args);
+  ASSERT_THAT(world.layers().NumElements(), Eq(3));
+  const Layer fruit_layer = world.layers().ToHandle("fruit");
+  const Layer piece_layer = world.layers().ToHandle("pieces");
+  const State spawn_state = world.states().ToHandle("Spawn");
+  const State player_state = world.states().ToHandle("Player");
+  const State apple_state = world.states().ToHandle("Apple");
+  const Group spawn_group = world.groups().ToHandle("spawns");
+  // Chunks are not a multiple of three cells apart.
+  Grid grid(world, math::Size2d{300000, 1}, GridShape::Topology::kBounded);
+  ASSERT_THAT(grid.GetShape().chunked(), IsTrue());
+
+  // One spawn point in each of three consecutive chunks.
+  for (int x : {40, 70, 100}) {
+    grid.CreateInstance(spawn_state, {{x, 0}, math::Orientation2d::kNorth});
+  }
+  const math::Position2d starts[] = {{0, 0}};
+  const math::Vector2d directions[] = {{200, 0}};
+  std::vector<Grid::RayCastBatchResult> results(1);
+  const Layer pieces_only[] = {piece_layer};
+  const Layer fruit_only[] = {fruit_layer};
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(Piece()));
+
+  math::Transform2d off_grid = {{-1, -1}, math::Orientation2d::kEast};
+  std::vector<Piece> players;
+  for (int i = 0; i < 3; ++i) {
+    players.push_back(grid.CreateInstance(player_state, off_grid));
+    grid.TeleportToGroup(players.back(), spawn_group, State(),
+                         Grid::TeleportOrientation::kMatchTarget);
+  }
+  grid.DoUpdate(&random);
+  std::vector<int> xs;
+  for (Piece player : players) {
+    xs.push_back(grid.GetPieceTransform(player).position.x);
+  }
+  EXPECT_THAT(xs, UnorderedElementsAre(40, 70, 100));
+  Piece first = players[std::min_element(xs.begin(), xs.end()) - xs.begin()];
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(first));
+  EXPECT_THAT(results[0].distance, DoubleEq(40.0));
+
+  // Moving the first player to the fruit layer frees its cell.
+  grid.SetState(first, apple_state);
+  grid.DoUpdate(&random);
+  grid.RayCastBatch(fruit_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(first));
+  EXPECT_THAT(results[0].distance, DoubleEq(40.0));
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].distance, DoubleEq(70.0));
+
+  Piece late = grid.CreateInstance(player_state, off_grid);
+  grid.TeleportToGroup(late, spawn_group, State(),
+                       Grid::TeleportOrientation::kMatchTarget);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(late).position,
+              Eq(math::Position2d{40, 0}));
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(late));
+}
+
+TEST(GridTest, SparseHugeGridTeleportsAndRayCasts) {
+  std::mt19937_64 random;
+  World::Args args = CreateWorldArgs();
+  args.states["Spawn"].group_names = {"spawns"};
+  const World world(args);
+  const Layer piece_layer = world.layers().ToHandle("pieces");
+  const State spawn_state = world.states().ToHandle("Spawn");
+  const State player_state = world.states().ToHandle("Player");
+  const Group spawn_group = world.groups().ToHandle("spawns");
+  // 2^28 positions; storage per position would need gigabytes.
+  Grid grid(world, math::Size2d{16384, 16384}, GridShape::Topology::kTorus);
+
+  grid.CreateInstance(spawn_state,
+                      {{10000, 12000}, math::Orientation2d::kNorth});
+  Piece player = grid.CreateInstance(
+      player_state, {{-1, -1}, math::Orientation2d::kNorth});
+  grid.TeleportToGroup(player, spawn_group, State(),
+                       Grid::TeleportOrientation::kMatchTarget);
+  grid.DoUpdate(&random);
+  EXPECT_THAT(grid.GetPieceTransform(player).position,
+              Eq(math::Position2d{10000, 12000}));
+
+  const math::Position2d starts[] = {{9990, 12000}, {0, 0}};
+  const math::Vector2d directions[] = {{20, 0}, {-20, -20}};
+  const Layer pieces_only[] = {piece_layer};
+  std::vector<Grid::RayCastBatchResult> results(2);
+  grid.RayCastBatch(pieces_only, starts, directions, absl::MakeSpan(results));
+  EXPECT_THAT(results[0].piece, Eq(player));
+  EXPECT_THAT(results[0].distance, DoubleEq(10.0));
+  EXPECT_THAT(results[1].piece, Eq(Piece()));
+}
+
 constexpr const absl::string_view kDiscFindAllTest = R"(
 ************
 *****P     *
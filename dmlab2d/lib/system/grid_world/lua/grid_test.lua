@@ -17,6 +17,7 @@ local asserts = require 'testing.asserts'
 local test_runner = require 'testing.test_runner'
 local grid_world = require 'system.grid_world'
 local random = require 'system.random'
+local tensor = require 'system.tensor'
 
 local mocking = require 'testing.mocking'
 local mock = mocking.mock
@@ -370,6 +371,18 @@ function tests.canRotatePiece()
   asserts.tablesEQ(grid:transform(piece), {pos = {0, 0}, orientation = 'S'})
 end
 
+function tests.actionQueueStatsCountActions()
+  local random = require 'system.random'
+  local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
+  local piece = grid:createPiece('type0', {pos = {0, 0}, orientation = 'N'})
+  grid:setOrientation(piece, 'E')
+  grid:turn(piece, 1)
+  grid:moveAbs(piece, 'E')
+  grid:update(random)
+  asserts.tablesEQ(grid:actionQueueStats(),
+                   {processed = 2, coalesced = 1, deferred = 0})
+end
+
 function tests.canPushPiece()
   local random = require 'system.random'
   local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
@@ -675,6 +688,35 @@ function tests.canRayCastDirection()
   asserts.tablesEQ(result2, {false, nil, {1, 0}})
 end
 
+function tests.canRayCastBatch()
+  local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
+  local piece0 = grid:createPiece('type0', {pos = {0, 0}, orientation = 'N'})
+  local piece1 = grid:createPiece('type1', {pos = {2, 0}, orientation = 'N'})
+  local piece2 = grid:createPiece('type0', {pos = {4, 0}, orientation = 'N'})
+  local stateIds = {}
+  for i, name in ipairs(TEST_WORLD.world:stateNames()) do
+    stateIds[name] = i - 1
+  end
+  local origins = tensor.Int32Tensor{{0, 0}, {4, 0}, {2, 0}}
+  local directions = tensor.Int32Tensor{{4, 0}, {-4, 0}, {-1, 0}}
+  local result = tensor.DoubleTensor(3, 3)
+
+  asserts.EQ(grid:rayCastBatch('layer0', origins, directions, result), 2)
+  asserts.tablesEQ(result:val(), {
+      {4, piece2, stateIds.type0},
+      {4, piece0, stateIds.type0},
+      {1, -1, -1},
+  })
+
+  asserts.EQ(grid:rayCastBatch(
+      {'layer0', 'layer1'}, origins, directions, result), 2)
+  asserts.tablesEQ(result:val(), {
+      {2, piece1, stateIds.type1},
+      {2, piece1, stateIds.type1},
+      {1, -1, -1},
+  })
+end
+
 function tests.groupRandomWorks()
   local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
   local piece0 = grid:createPiece('type0', {pos = {0, 0}, orientation = 'N'})
@@ -859,6 +901,40 @@ function tests.updateCallbackWorksWithStartFrame()
   verifyNoMoreInteractions(onUpdate)
 end
 
+function tests.updateCallbackWorksBatched()
+  local calls = {}
+  local grid = TEST_WORLD.world:createGrid{
+      size = {width = 5, height = 1},
+      stateCallbacks = {
+          type2 = {
+              onUpdate = {
+                  funcPhase1 = function(g, pieces, frames)
+                    calls[#calls + 1] = {pieces = pieces, frames = frames}
+                  end
+              }
+          }
+      },
+  }
+  grid:setUpdater{update = 'phase1', group = 'type2', batch = true}
+  local piece0 = grid:createPiece('type2', {pos = {0, 0}, orientation = 'E'})
+  grid:update(random)
+  local piece1 = grid:createPiece('type2', {pos = {1, 0}, orientation = 'E'})
+  grid:update(random)
+  asserts.EQ(#calls, 2)
+  asserts.tablesEQ(calls[1], {pieces = {piece0}, frames = {0}})
+  local second = calls[2]
+  asserts.EQ(#second.pieces, 2)
+  for i, piece in ipairs(second.pieces) do
+    asserts.EQ(second.frames[i], piece == piece0 and 1 or 0)
+  end
+  asserts.shouldFail(
+      function()
+        grid:setUpdater{update = 'phase1', group = 'type2', batch = 1}
+      end,
+      '\'batch\' must be a boolean'
+  )
+end
+
 function tests.canCallHitBeam()
   local world = grid_world.World{
       renderOrder = {'dot', 'pieceLayer', 'hitLayer'},
@@ -1354,4 +1430,83 @@ function tests.canQueryRectangleTorus()
   asserts.EQ(countPlus, 6 * 6 - 4 * 4)
 end
 
+function tests.queryIntoMatchesQuery()
+  local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 5}}
+  for x = 0, 4 do
+    for y = 0, 4 do
+      if (x + y) % 2 == 0 then
+        grid:createPiece('type0', {pos = {x, y}, orientation = 'N'})
+      end
+    end
+  end
+  local function checkInto(query, ...)
+    local expected = grid[query](grid, 'layer0', ...)
+    local pieces, positions = {}, {}
+    local args = {...}
+    args[#args + 1] = pieces
+    args[#args + 1] = positions
+    local count = grid[query .. 'Into'](grid, 'layer0', unpack(args))
+    asserts.EQ(count, #pieces)
+    local expectedCount = 0
+    for _ in pairs(expected) do
+      expectedCount = expectedCount + 1
+    end
+    asserts.EQ(count, expectedCount)
+    for i, piece in ipairs(pieces) do
+      asserts.tablesEQ(positions[i], expected[piece])
+    end
+  end
+  checkInto('queryRectangle', {1, 1}, {3, 4})
+  checkInto('queryDiamond', {2, 2}, 2)
+  checkInto('queryDisc', {2, 2}, 2)
+end
+
+function tests.queryIntoReusesArrays()
+  local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
+  local piece0 = grid:createPiece('type0', {pos = {0, 0}, orientation = 'N'})
+  local piece1 = grid:createPiece('type0', {pos = {1, 0}, orientation = 'N'})
+  local piece2 = grid:createPiece('type0', {pos = {2, 0}, orientation = 'N'})
+  local pieces, positions = {}, {}
+  asserts.EQ(grid:queryRectangleInto('layer0', {0, 0}, {4, 0}, pieces,
+                                     positions), 3)
+  local position0 = positions[1]
+  asserts.EQ(grid:queryRectangleInto('layer0', {1, 0}, {4, 0}, pieces,
+                                     positions), 2)
+  asserts.tablesEQ(pieces, {piece1, piece2})
+  asserts.tablesEQ(positions[1], {1, 0})
+  asserts.tablesEQ(positions[2], {2, 0})
+  asserts.EQ(positions[1], position0)
+  -- Stale positions are kept for reuse.
+  asserts.EQ(#positions, 3)
+
+  -- Positions are optional.
+  asserts.EQ(grid:queryDiamondInto('layer0', {0, 0}, 1, pieces), 2)
+  asserts.EQ(#pieces, 2)
+  asserts.EQ(grid:queryDiscInto('layer0', {4, 0}, 1, pieces), 0)
+  asserts.EQ(#pieces, 0)
+
+  asserts.shouldFail(function()
+    grid:queryDiscInto('layer0', {4, 0}, 1)
+  end)
+  asserts.shouldFail(function()
+    grid:queryDiscInto('layer0', {4, 0}, 1, pieces, 'positions')
+  end)
+end
+
+function tests.shuffledGroupIntoWorks()
+  local grid = TEST_WORLD.world:createGrid{size = {width = 5, height = 1}}
+  grid:createPiece('type0', {pos = {0, 0}, orientation = 'N'})
+  grid:createPiece('type1', {pos = {1, 0}, orientation = 'N'})
+  grid:createPiece('type0', {pos = {3, 0}, orientation = 'N'})
+  local pieces = {}
+  asserts.EQ(grid:groupShuffledInto(random, 'type0or1', pieces), 3)
+  asserts.EQ(#pieces, 3)
+  asserts.EQ(grid:groupShuffledInto(random, 'type0', pieces), 2)
+  asserts.EQ(#pieces, 2)
+  for _, piece in ipairs(pieces) do
+    asserts.EQ(grid:state(piece), 'type0')
+  end
+  asserts.shouldFail(function() grid:groupShuffledInto(random, 'type0') end)
+end
+
 return test_runner.run(tests)
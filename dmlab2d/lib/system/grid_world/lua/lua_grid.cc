@@ -15,15 +15,20 @@
 #include "dmlab2d/lib/system/grid_world/lua/lua_grid.h"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "dmlab2d/lib/lua/call.h"
 #include "dmlab2d/lib/lua/lua.h"
 #include "dmlab2d/lib/lua/n_results_or.h"
@@ -37,6 +42,7 @@
 #include "dmlab2d/lib/system/math/lua/math2d.h"
 #include "dmlab2d/lib/system/math/math2d.h"
 #include "dmlab2d/lib/system/random/lua/random.h"
+#include "dmlab2d/lib/system/tensor/lua/tensor.h"
 
 namespace deepmind::lab2d {
 namespace {
@@ -150,6 +156,11 @@ class LuaStateCallback : public Grid::StateCallback {
     on_update_[update].Call("OnUpdate", grid_ref_, piece, num_frames_in_state);
   }
 
+  void OnUpdateBatch(Update update, absl::Span<const Piece> pieces,
+                     absl::Span<const int> num_frames_in_state) override {
+    on_update_[update].Call("OnUpdate", grid_ref_, pieces, num_frames_in_state);
+  }
+
   void OnEnter(Contact contact, Piece piece, Piece instigator) override {
     on_enter_[contact].Call("OnEnter", grid_ref_, piece, instigator);
   }
@@ -164,6 +175,10 @@ class LuaStateCallback : public Grid::StateCallback {
                : Grid::HitResponse::kContinue;
   }
 
+  bool HandlesHit(Hit hit) const override {
+    return !on_hit_[hit].IsConstant(false);
+  }
+
  private:
   struct Callback {
    public:
@@ -231,6 +246,11 @@ class LuaStateCallback : public Grid::StateCallback {
       }
     }
 
+    // Returns whether Call always returns `value` without calling Lua.
+    bool IsConstant(bool value) const {
+      return func_ref_.is_unbound() && value_ == value;
+    }
+
    private:
     lua::Ref func_ref_;
     bool value_;
@@ -283,6 +303,111 @@ void PushFindPieceResults(lua_State* L,
   }
 }
 
+lua::NResultsOr CheckArrayArg(lua_State* L, int arg) {
+  if (lua_type(L, arg) != LUA_TTABLE) {
+    return absl::StrCat("Arg ", arg - 1, " must be an array to write into.");
+  }
+  return 0;
+}
+
+// Clears the entries of the array at `arg` from `size` + 1 up to `old_size`.
+void TruncateArray(lua_State* L, int arg, std::size_t size,
+                   std::size_t old_size) {
+  for (std::size_t i = size; i < old_size; ++i) {
+    lua_pushnil(L);
+    lua_rawseti(L, arg, i + 1);
+  }
+}
+
+// Overwrites the array at `arg` with `pieces` and pushes the piece count.
+lua::NResultsOr WritePieces(lua_State* L, int arg,
+                            absl::Span<const Piece> pieces) {
+  if (auto result = CheckArrayArg(L, arg); !result.ok()) {
+    return result;
+  }
+  const std::size_t old_size = lua::ArrayLength(L, arg);
+  for (std::size_t i = 0; i < pieces.size(); ++i) {
+    Push(L, pieces[i]);
+    lua_rawseti(L, arg, i + 1);
+  }
+  TruncateArray(L, arg, pieces.size(), old_size);
+  lua::Push(L, pieces.size());
+  return 1;
+}
+
+// Overwrites the array at `arg` with the pieces in `results` and, unless the
+// next argument is nil, that array with their positions. Position tables
+// already in the array are updated in place, and any past the count are kept
+// for later queries. Pushes the piece count.
+lua::NResultsOr WriteFindPieceResults(
+    lua_State* L, int arg, absl::Span<const Grid::FindPieceResult> results) {
+  if (auto result = CheckArrayArg(L, arg); !result.ok()) {
+    return result;
+  }
+  const int positions_arg = arg + 1;
+  if (!lua_isnoneornil(L, positions_arg)) {
+    if (auto result = CheckArrayArg(L, positions_arg); !result.ok()) {
+      return result;
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      lua_rawgeti(L, positions_arg, i + 1);
+      if (lua_type(L, -1) == LUA_TTABLE) {
+        lua::Push(L, results[i].position.x);
+        lua_rawseti(L, -2, 1);
+        lua::Push(L, results[i].position.y);
+        lua_rawseti(L, -2, 2);
+        lua_pop(L, 1);
+      } else {
+        lua_pop(L, 1);
+        Push(L, results[i].position);
+        lua_rawseti(L, positions_arg, i + 1);
+      }
+    }
+  }
+  const std::size_t old_size = lua::ArrayLength(L, arg);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    Push(L, results[i].piece);
+    lua_rawseti(L, arg, i + 1);
+  }
+  TruncateArray(L, arg, results.size(), old_size);
+  lua::Push(L, results.size());
+  return 1;
+}
+
+// Reads an Int32Tensor of shape {`rows`, 2} at `arg` into `points`. Sets `rows`
+// from the tensor when it is negative.
+template <typename T>
+lua::NResultsOr ReadPointTensor(lua_State* L, int arg, int* rows,
+                                std::vector<T>* points) {
+  const auto* points_tensor = tensor::LuaTensor<int>::ReadObject(L, arg);
+  if (points_tensor == nullptr) {
+    return absl::StrCat("Arg ", arg - 1, " must be an Int32Tensor.");
+  }
+  const auto& view = points_tensor->tensor_view();
+  const auto& shape = view.shape();
+  if (shape.size() != 2 || shape[1] != 2 ||
+      (*rows >= 0 && shape[0] != static_cast<std::size_t>(*rows))) {
+    return absl::StrCat("Arg ", arg - 1, " must have shape {",
+                        *rows >= 0 ? absl::StrCat(*rows) : "n", ", 2}, got {",
+                        absl::StrJoin(shape, ", "), "}.");
+  }
+  *rows = shape[0];
+  points->resize(shape[0]);
+  if (view.IsContiguous()) {
+    const int* values = view.storage() + view.start_offset();
+    for (auto& point : *points) {
+      point.x = *values++;
+      point.y = *values++;
+    }
+  } else {
+    view.ForEachIndexed([points](const tensor::ShapeVector& index, int value) {
+      auto& point = (*points)[index[0]];
+      (index[1] == 0 ? point.x : point.y) = value;
+    });
+  }
+  return 0;
+}
+
 }  // namespace
 
 void LuaGrid::SubModule(lua::TableRef module) {
@@ -419,12 +544,17 @@ void LuaGrid::Register(lua_State* L) {
       {"frames", &Class::Member<&LuaGrid::Frames>},
       {"rayCast", &Class::Member<&LuaGrid::RayCast>},
       {"rayCastDirection", &Class::Member<&LuaGrid::RayCastDirection>},
+      {"rayCastBatch", &Class::Member<&LuaGrid::RayCastBatch>},
       {"queryPosition", &Class::Member<&LuaGrid::QueryPosition>},
       {"queryRectangle", &Class::Member<&LuaGrid::QueryRectangle>},
       {"queryDiamond", &Class::Member<&LuaGrid::QueryDiamond>},
       {"queryDisc", &Class::Member<&LuaGrid::QueryDisc>},
+      {"queryRectangleInto", &Class::Member<&LuaGrid::QueryRectangleInto>},
+      {"queryDiamondInto", &Class::Member<&LuaGrid::QueryDiamondInto>},
+      {"queryDiscInto", &Class::Member<&LuaGrid::QueryDiscInto>},
       {"groupCount", &Class::Member<&LuaGrid::GroupCount>},
       {"groupShuffled", &Class::Member<&LuaGrid::GroupShuffled>},
+      {"groupShuffledInto", &Class::Member<&LuaGrid::GroupShuffledInto>},
       {"groupShuffledWithCount",
        &Class::Member<&LuaGrid::GroupShuffledWithCount>},
       {"groupShuffledWithProbability",
@@ -446,6 +576,7 @@ void LuaGrid::Register(lua_State* L) {
       {"connect", &Class::Member<&LuaGrid::Connect>},
       {"disconnect", &Class::Member<&LuaGrid::Disconnect>},
       {"disconnectAll", &Class::Member<&LuaGrid::DisconnectAll>},
+      {"actionQueueStats", &Class::Member<&LuaGrid::ActionQueueStats>},
   };
   Class::Register(L, methods);
 }
@@ -876,6 +1007,74 @@ lua::NResultsOr LuaGrid::RayCastDirection(lua_State* L) {
   return 3;
 }
 
+// Returns 1 value.
+// The number of rays that hit a piece.
+lua::NResultsOr LuaGrid::RayCastBatch(lua_State* L) {
+  const World& world = grid_->GetWorld();
+  ray_layers_.clear();
+  if (absl::string_view layer_string; IsFound(lua::Read(L, 2, &layer_string))) {
+    ray_layers_.push_back(world.layers().ToHandle(layer_string));
+  } else if (std::vector<absl::string_view> layer_strings;
+             IsFound(lua::Read(L, 2, &layer_strings))) {
+    for (absl::string_view name : layer_strings) {
+      ray_layers_.push_back(world.layers().ToHandle(name));
+    }
+  } else {
+    return "Arg 1 must be a layer name or an array of layer names.";
+  }
+  int num_rays = -1;
+  if (auto result = ReadPointTensor(L, 3, &num_rays, &ray_starts_);
+      !result.ok()) {
+    return result;
+  }
+  if (auto result = ReadPointTensor(L, 4, &num_rays, &ray_directions_);
+      !result.ok()) {
+    return result;
+  }
+  auto* output = tensor::LuaTensor<double>::ReadObject(L, 5);
+  if (output == nullptr) {
+    return "Arg 4 must be a DoubleTensor to write into.";
+  }
+  auto* output_view = output->mutable_tensor_view();
+  const auto& output_shape = output_view->shape();
+  if (output_shape.size() != 2 ||
+      output_shape[0] != static_cast<std::size_t>(num_rays) ||
+      output_shape[1] != 3) {
+    return absl::StrCat("Arg 4 must have shape {", num_rays, ", 3}, got {",
+                        absl::StrJoin(output_shape, ", "), "}.");
+  }
+
+  ray_results_.resize(num_rays);
+  grid_->RayCastBatch(ray_layers_, ray_starts_, ray_directions_,
+                      absl::MakeSpan(ray_results_));
+  int num_hits = 0;
+  for (const auto& result : ray_results_) {
+    num_hits += !result.piece.IsEmpty();
+  }
+  auto to_row = [](const Grid::RayCastBatchResult& result) {
+    return std::array<double, 3>{
+        result.distance,
+        result.piece.IsEmpty() ? -1.0 : result.piece.Value(),
+        result.state.IsEmpty() ? -1.0 : result.state.Value()};
+  };
+  if (output_view->IsContiguous()) {
+    double* values =
+        output_view->mutable_storage() + output_view->start_offset();
+    for (const auto& result : ray_results_) {
+      for (double value : to_row(result)) {
+        *values++ = value;
+      }
+    }
+  } else {
+    output_view->ForEachIndexedMutable(
+        [this, &to_row](const tensor::ShapeVector& index, double* value) {
+          *value = to_row(ray_results_[index[0]])[index[1]];
+        });
+  }
+  lua::Push(L, num_hits);
+  return 1;
+}
+
 lua::NResultsOr LuaGrid::QueryPosition(lua_State* L) {
   absl::string_view layer_string;
   if (!IsFound(lua::Read(L, 2, &layer_string))) {
@@ -894,7 +1093,7 @@ lua::NResultsOr LuaGrid::QueryPosition(lua_State* L) {
   return 1;
 }
 
-lua::NResultsOr LuaGrid::QueryRectangle(lua_State* L) {
+lua::NResultsOr LuaGrid::FindInRectangle(lua_State* L) {
   absl::string_view layer_string;
   if (!IsFound(lua::Read(L, 2, &layer_string))) {
     return "Arg 1 must be a layer name";
@@ -908,11 +1107,26 @@ lua::NResultsOr LuaGrid::QueryRectangle(lua_State* L) {
   if (!IsFound(Read(L, 4, &position1))) {
     return "Arg 3 must be a valid position.";
   }
-  PushFindPieceResults(L, grid_->RectangleFindAll(layer, position0, position1));
+  grid_->RectangleFindAll(layer, position0, position1, &find_results_);
+  return 0;
+}
+
+lua::NResultsOr LuaGrid::QueryRectangle(lua_State* L) {
+  if (auto result = FindInRectangle(L); !result.ok()) {
+    return result;
+  }
+  PushFindPieceResults(L, find_results_);
   return 1;
 }
 
-lua::NResultsOr LuaGrid::QueryDiamond(lua_State* L) {
+lua::NResultsOr LuaGrid::QueryRectangleInto(lua_State* L) {
+  if (auto result = FindInRectangle(L); !result.ok()) {
+    return result;
+  }
+  return WriteFindPieceResults(L, 5, find_results_);
+}
+
+lua::NResultsOr LuaGrid::FindInDiamond(lua_State* L) {
   absl::string_view layer_string;
   if (!IsFound(lua::Read(L, 2, &layer_string))) {
     return "Arg 1 must be a layer name";
@@ -926,11 +1140,26 @@ lua::NResultsOr LuaGrid::QueryDiamond(lua_State* L) {
   if (!IsFound(lua::Read(L, 4, &radius)) || radius < 0) {
     return "Arg 3 must be a non-negative radius.";
   }
-  PushFindPieceResults(L, grid_->DiamondFindAll(layer, position, radius));
+  grid_->DiamondFindAll(layer, position, radius, &find_results_);
+  return 0;
+}
+
+lua::NResultsOr LuaGrid::QueryDiamond(lua_State* L) {
+  if (auto result = FindInDiamond(L); !result.ok()) {
+    return result;
+  }
+  PushFindPieceResults(L, find_results_);
   return 1;
 }
 
-lua::NResultsOr LuaGrid::QueryDisc(lua_State* L) {
+lua::NResultsOr LuaGrid::QueryDiamondInto(lua_State* L) {
+  if (auto result = FindInDiamond(L); !result.ok()) {
+    return result;
+  }
+  return WriteFindPieceResults(L, 5, find_results_);
+}
+
+lua::NResultsOr LuaGrid::FindInDisc(lua_State* L) {
   absl::string_view layer_string;
   if (!IsFound(lua::Read(L, 2, &layer_string))) {
     return "Arg 1 must be a layer name";
@@ -944,11 +1173,25 @@ lua::NResultsOr LuaGrid::QueryDisc(lua_State* L) {
   if (!IsFound(lua::Read(L, 4, &radius)) || radius < 0) {
     return "Arg 3 must be a non-negative radius.";
   }
+  grid_->DiscFindAll(layer, position, radius, &find_results_);
+  return 0;
+}
 
-  PushFindPieceResults(L, grid_->DiscFindAll(layer, position, radius));
+lua::NResultsOr LuaGrid::QueryDisc(lua_State* L) {
+  if (auto result = FindInDisc(L); !result.ok()) {
+    return result;
+  }
+  PushFindPieceResults(L, find_results_);
   return 1;
 }
 
+lua::NResultsOr LuaGrid::QueryDiscInto(lua_State* L) {
+  if (auto result = FindInDisc(L); !result.ok()) {
+    return result;
+  }
+  return WriteFindPieceResults(L, 5, find_results_);
+}
+
 lua::NResultsOr LuaGrid::GroupCount(lua_State* L) {
   absl::string_view group_name;
   if (!IsFound(lua::Read(L, 2, &group_name))) {
@@ -1003,6 +1246,25 @@ lua::NResultsOr LuaGrid::GroupShuffled(lua_State* L) {
   return 1;
 }
 
+lua::NResultsOr LuaGrid::GroupShuffledInto(lua_State* L) {
+  auto* random = LuaRandom::ReadObject(L, 2);
+  if (!random) {
+    return "Arg 1 must be a random number generator.";
+  }
+  absl::string_view group_name;
+  if (!IsFound(lua::Read(L, 3, &group_name))) {
+    return "Arg 2 must be a group name.";
+  }
+  Group group = grid_->GetWorld().groups().ToHandle(group_name);
+  if (group.IsEmpty()) {
+    return absl::StrCat("Arg 2 must be a *valid* group name. '", group_name,
+                        "'");
+  }
+
+  return WritePieces(L, 4,
+                     grid_->PiecesByGroupShuffled(group, random->GetPrbg()));
+}
+
 lua::NResultsOr LuaGrid::HitBeam(lua_State* L) {
   Piece piece;
   if (!IsFound(Read(L, 2, &piece))) {
@@ -1140,7 +1402,12 @@ lua::NResultsOr LuaGrid::SetUpdater(lua_State* L) {
     return "'start_frame' must be a number";
   }
 
-  grid_->SetUpdateInfo(update, group, probability, start_frame);
+  bool batch = false;
+  if (IsTypeMismatch(table.LookUp("batch", &batch))) {
+    return "'batch' must be a boolean";
+  }
+
+  grid_->SetUpdateInfo(update, group, probability, start_frame, batch);
   return 0;
 }
 
@@ -1173,4 +1440,14 @@ lua::NResultsOr LuaGrid::DisconnectAll(lua_State* L) {
   return 0;
 }
 
+lua::NResultsOr LuaGrid::ActionQueueStats(lua_State* L) {
+  const Grid::ActionQueueStats& stats = grid_->GetActionQueueStats();
+  auto table = lua::TableRef::Create(L);
+  table.Insert("processed", stats.processed);
+  table.Insert("coalesced", stats.coalesced);
+  table.Insert("deferred", stats.deferred);
+  lua::Push(L, table);
+  return 1;
+}
+
 }  // namespace deepmind::lab2d
@@ -15,6 +15,8 @@
 #ifndef DMLAB2D_LIB_SYSTEM_GRID_WORLD_LUA_LUA_GRID_H_
 #define DMLAB2D_LIB_SYSTEM_GRID_WORLD_LUA_LUA_GRID_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "dmlab2d/lib/lua/class.h"
 #include "dmlab2d/lib/lua/lua.h"
@@ -83,15 +85,25 @@ class LuaGrid : public lua::Class<LuaGrid> {
   // Query Grid.
   lua::NResultsOr RayCast(lua_State* L);
   lua::NResultsOr RayCastDirection(lua_State* L);
+  lua::NResultsOr RayCastBatch(lua_State* L);
   lua::NResultsOr QueryPosition(lua_State* L);
   lua::NResultsOr QueryRectangle(lua_State* L);
   lua::NResultsOr QueryDiamond(lua_State* L);
   lua::NResultsOr QueryDisc(lua_State* L);
+  lua::NResultsOr QueryRectangleInto(lua_State* L);
+  lua::NResultsOr QueryDiamondInto(lua_State* L);
+  lua::NResultsOr QueryDiscInto(lua_State* L);
+
+  // Store the pieces matching the query arguments in `find_results_`.
+  lua::NResultsOr FindInRectangle(lua_State* L);
+  lua::NResultsOr FindInDiamond(lua_State* L);
+  lua::NResultsOr FindInDisc(lua_State* L);
 
   // Group.
   lua::NResultsOr GroupCount(lua_State* L);
   lua::NResultsOr GroupRandom(lua_State* L);
   lua::NResultsOr GroupShuffled(lua_State* L);
+  lua::NResultsOr GroupShuffledInto(lua_State* L);
   lua::NResultsOr GroupShuffledWithCount(lua_State* L);
   lua::NResultsOr GroupShuffledWithProbability(lua_State* L);
 
@@ -100,8 +112,18 @@ class LuaGrid : public lua::Class<LuaGrid> {
   lua::NResultsOr Disconnect(lua_State* L);
   lua::NResultsOr DisconnectAll(lua_State* L);
 
+  // Debug.
+  lua::NResultsOr ActionQueueStats(lua_State* L);
+
   absl::optional<Grid> grid_;
 
+  // Reused between queries to avoid allocating a result per call.
+  std::vector<Grid::FindPieceResult> find_results_;
+  std::vector<Layer> ray_layers_;
+  std::vector<math::Position2d> ray_starts_;
+  std::vector<math::Vector2d> ray_directions_;
+  std::vector<Grid::RayCastBatchResult> ray_results_;
+
   // Required to keep `grid_` valid.
   lua::Ref world_ref_;
 };
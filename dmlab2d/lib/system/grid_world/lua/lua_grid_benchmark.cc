@@ -0,0 +1,331 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <random>
+
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/lua/call.h"
+#include "dmlab2d/lib/lua/lua.h"
+#include "dmlab2d/lib/lua/push.h"
+#include "dmlab2d/lib/lua/push_script.h"
+#include "dmlab2d/lib/lua/vm.h"
+#include "dmlab2d/lib/system/grid_world/lua/lua_world.h"
+#include "dmlab2d/lib/system/random/lua/random.h"
+#include "dmlab2d/lib/system/tensor/lua/tensor.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+// Creates a square grid of the given size with a piece in every cell. The
+// pieces are updated every frame if `with_callback` is true, in one call if
+// `batch` is true.
+constexpr absl::string_view kCreateGrid = R"(
+local grid_world = require 'system.grid_world'
+local size, withCallback, batch = ...
+local world = grid_world.World{
+    renderOrder = {'main'},
+    updateOrder = {'tick'},
+    types = {
+        ticker = {layer = 'main', sprite = 'Ticker', groups = {'tickers'}},
+    },
+}
+local rows = {}
+for i = 1, size do
+  rows[i] = string.rep('t', size)
+end
+local onUpdate = {}
+if withCallback then
+  if batch then
+    onUpdate.tick = function(grid, pieces, framesInState)
+      for i = 1, #pieces do
+        local piece, frames = pieces[i], framesInState[i]
+      end
+    end
+  else
+    onUpdate.tick = function(grid, piece, framesInState) end
+  end
+end
+local grid = world:createGrid{
+    layout = table.concat(rows, '\n'),
+    stateMap = {t = 'ticker'},
+    stateCallbacks = {ticker = {onUpdate = onUpdate}},
+}
+grid:setUpdater{update = 'tick', group = 'tickers', batch = batch}
+return function(random)
+  grid:update(random)
+end
+)";
+
+// Runs one grid update per iteration on a state.range(0)^2 grid.
+void UpdateGrid(benchmark::State& state, bool with_callback, bool batch) {
+  auto lua_vm = lua::CreateVm();
+  lua_State* L = lua_vm.get();
+  lua_vm.AddCModuleToSearchers("system.grid_world", &LuaWorld::Module);
+  LuaRandom::Register(L);
+  std::mt19937_64 prbg(0);
+  LuaRandom::CreateObject(L, &prbg, 0);
+
+  const int size = state.range(0);
+  if (auto result = lua::PushScript(L, kCreateGrid, "kCreateGrid");
+      !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  lua::Push(L, size);
+  lua::Push(L, with_callback);
+  lua::Push(L, batch);
+  if (auto result = lua::Call(L, 3); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+
+  // Lua stack: random, update
+  for (auto _ : state) {
+    lua_pushvalue(L, -1);
+    lua_pushvalue(L, -3);
+    if (auto result = lua::Call(L, 1); !result.ok()) {
+      LOG(FATAL) << result.error();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+  lua_pop(L, 2);
+}
+
+void BM_UpdateWithOnUpdate(benchmark::State& state) {
+  UpdateGrid(state, /*with_callback=*/true, /*batch=*/false);
+}
+
+BENCHMARK(BM_UpdateWithOnUpdate)->Arg(16)->Arg(64);
+
+void BM_UpdateWithBatchedOnUpdate(benchmark::State& state) {
+  UpdateGrid(state, /*with_callback=*/true, /*batch=*/true);
+}
+
+BENCHMARK(BM_UpdateWithBatchedOnUpdate)->Arg(16)->Arg(64);
+
+void BM_UpdateWithoutOnUpdate(benchmark::State& state) {
+  UpdateGrid(state, /*with_callback=*/false, /*batch=*/false);
+}
+
+BENCHMARK(BM_UpdateWithoutOnUpdate)->Arg(16)->Arg(64);
+
+// Creates a square grid of the given size with an apple in every other cell
+// and returns a function running a radius 3 diamond query around every cell,
+// as commons_harvest does when apples are eaten or respawn. `mode` selects
+// 'table' for grid:queryDiamond, 'pieces' for grid:queryDiamondInto or
+// 'positions' for grid:queryDiamondInto with positions.
+constexpr absl::string_view kQueryGrid = R"(
+local grid_world = require 'system.grid_world'
+local size, mode = ...
+local world = grid_world.World{
+    renderOrder = {'logic'},
+    types = {apple = {layer = 'logic', sprite = 'Apple'}},
+}
+local rows = {}
+for i = 1, size do
+  rows[i] = string.rep(i % 2 == 0 and 'a.' or '.a', size / 2)
+end
+local grid = world:createGrid{
+    layout = table.concat(rows, '\n'),
+    stateMap = {a = 'apple'},
+}
+local pieces, positions = {}, {}
+local pos = {0, 0}
+return function()
+  local total = 0
+  for y = 0, size - 1 do
+    for x = 0, size - 1 do
+      pos[1], pos[2] = x, y
+      if mode == 'table' then
+        for _ in pairs(grid:queryDiamond('logic', pos, 3)) do
+          total = total + 1
+        end
+      elseif mode == 'pieces' then
+        total = total + grid:queryDiamondInto('logic', pos, 3, pieces)
+      else
+        total = total +
+            grid:queryDiamondInto('logic', pos, 3, pieces, positions)
+      end
+    end
+  end
+  return total
+end
+)";
+
+// Runs one query per cell of a state.range(0)^2 grid per iteration. Reports
+// the bytes Lua allocates per query, measured over one extra pass with the
+// collector stopped.
+void QueryGrid(benchmark::State& state, absl::string_view mode) {
+  auto lua_vm = lua::CreateVm();
+  lua_State* L = lua_vm.get();
+  lua_vm.AddCModuleToSearchers("system.grid_world", &LuaWorld::Module);
+
+  const int size = state.range(0);
+  if (auto result = lua::PushScript(L, kQueryGrid, "kQueryGrid");
+      !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  lua::Push(L, size);
+  lua::Push(L, mode);
+  if (auto result = lua::Call(L, 2); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+
+  // Lua stack: query
+  auto run_queries = [L] {
+    lua_pushvalue(L, -1);
+    if (auto result = lua::Call(L, 0); !result.ok()) {
+      LOG(FATAL) << result.error();
+    }
+    lua_pop(L, 1);
+  };
+
+  // Warm up reused buffers before measuring allocations.
+  run_queries();
+  lua_gc(L, LUA_GCCOLLECT, 0);
+  lua_gc(L, LUA_GCSTOP, 0);
+  const double kb_before = lua_gc(L, LUA_GCCOUNT, 0) +
+                           lua_gc(L, LUA_GCCOUNTB, 0) / 1024.0;
+  run_queries();
+  const double kb_after = lua_gc(L, LUA_GCCOUNT, 0) +
+                          lua_gc(L, LUA_GCCOUNTB, 0) / 1024.0;
+  lua_gc(L, LUA_GCRESTART, 0);
+
+  for (auto _ : state) {
+    run_queries();
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+  state.counters["bytes_per_query"] =
+      (kb_after - kb_before) * 1024.0 / (size * size);
+  lua_pop(L, 1);
+}
+
+void BM_QueryDiamond(benchmark::State& state) { QueryGrid(state, "table"); }
+
+BENCHMARK(BM_QueryDiamond)->Arg(32);
+
+void BM_QueryDiamondInto(benchmark::State& state) {
+  QueryGrid(state, "pieces");
+}
+
+BENCHMARK(BM_QueryDiamondInto)->Arg(32);
+
+void BM_QueryDiamondIntoWithPositions(benchmark::State& state) {
+  QueryGrid(state, "positions");
+}
+
+BENCHMARK(BM_QueryDiamondIntoWithPositions)->Arg(32);
+
+// Creates a 32x32 grid with walls in every fourth cell and 16 agents, and
+// returns a function casting 32 rays of length 8 from every agent. `batch`
+// selects one grid:rayCastBatch call instead of one grid:rayCastDirection
+// call per ray.
+constexpr absl::string_view kCastRays = R"(
+local grid_world = require 'system.grid_world'
+local tensor = require 'system.tensor'
+local batch = ...
+local kSize, kAgents, kRays, kLength = 32, 16, 32, 8
+local world = grid_world.World{
+    renderOrder = {'pieces'},
+    types = {
+        wall = {layer = 'pieces', sprite = 'Wall'},
+        agent = {layer = 'pieces', sprite = 'Agent'},
+    },
+}
+local rows = {}
+for i = 1, kSize do
+  rows[i] = string.rep(i % 2 == 0 and 'w...' or '..w.', kSize / 4)
+end
+local grid = world:createGrid{
+    layout = table.concat(rows, '\n'),
+    stateMap = {w = 'wall'},
+}
+local agentPositions = {}
+for i = 1, kAgents do
+  local pos = {(i * 7) % kSize, (i * 13) % kSize}
+  grid:createPiece('agent', {pos = pos, orientation = 'N'})
+  agentPositions[i] = pos
+end
+local directions = {}
+for r = 1, kRays do
+  local angle = 2 * math.pi * r / kRays
+  directions[r] = {
+      math.floor(kLength * math.cos(angle) + 0.5),
+      math.floor(kLength * math.sin(angle) + 0.5),
+  }
+end
+local origins = tensor.Int32Tensor(kAgents * kRays, 2)
+local rayDirections = tensor.Int32Tensor(kAgents * kRays, 2)
+for i, pos in ipairs(agentPositions) do
+  for r, direction in ipairs(directions) do
+    local row = (i - 1) * kRays + r
+    origins(row):val(pos)
+    rayDirections(row):val(direction)
+  end
+end
+local result = tensor.DoubleTensor(kAgents * kRays, 3)
+return function()
+  if batch then
+    return grid:rayCastBatch('pieces', origins, rayDirections, result)
+  end
+  local hits = 0
+  for _, pos in ipairs(agentPositions) do
+    for _, direction in ipairs(directions) do
+      if grid:rayCastDirection('pieces', pos, direction) then
+        hits = hits + 1
+      end
+    end
+  end
+  return hits
+end
+)";
+
+void CastRays(benchmark::State& state, bool batch) {
+  auto lua_vm = lua::CreateVm();
+  lua_State* L = lua_vm.get();
+  lua_vm.AddCModuleToSearchers("system.grid_world", &LuaWorld::Module);
+  tensor::LuaTensorRegister(L);
+  lua_vm.AddCModuleToSearchers("system.tensor", tensor::LuaTensorConstructors);
+  if (auto result = lua::PushScript(L, kCastRays, "kCastRays"); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+  lua::Push(L, batch);
+  if (auto result = lua::Call(L, 1); !result.ok()) {
+    LOG(FATAL) << result.error();
+  }
+
+  // Lua stack: cast
+  for (auto _ : state) {
+    lua_pushvalue(L, -1);
+    if (auto result = lua::Call(L, 0); !result.ok()) {
+      LOG(FATAL) << result.error();
+    }
+    lua_pop(L, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * 16 * 32);
+  lua_pop(L, 1);
+}
+
+void BM_RayCastDirection(benchmark::State& state) { CastRays(state, false); }
+
+BENCHMARK(BM_RayCastDirection);
+
+void BM_RayCastBatch(benchmark::State& state) { CastRays(state, true); }
+
+BENCHMARK(BM_RayCastBatch);
+
+}  // namespace
+}  // namespace deepmind::lab2d
@@ -110,6 +110,7 @@ void LuaWorld::Register(lua_State* L) {
       {"createGrid", &Class::Member<&LuaWorld::CreateGrid>},
       {"createView", &Class::Member<&LuaWorld::CreateLayerView>},
       {"spriteNames", &Class::Member<&LuaWorld::SpriteNames>},
+      {"stateNames", &Class::Member<&LuaWorld::StateNames>},
   };
   Class::Register(L, methods);
   LuaGrid::Register(L);
@@ -222,4 +223,9 @@ lua::NResultsOr LuaWorld::SpriteNames(lua_State* L) {
   return 1;
 }
 
+lua::NResultsOr LuaWorld::StateNames(lua_State* L) {
+  lua::Push(L, world_.states().Names());
+  return 1;
+}
+
 }  // namespace deepmind::lab2d
@@ -38,6 +38,7 @@ class LuaWorld : lua::Class<LuaWorld> {
   lua::NResultsOr CreateGrid(lua_State* L);
   lua::NResultsOr CreateLayerView(lua_State* L);
   lua::NResultsOr SpriteNames(lua_State* L);
+  lua::NResultsOr StateNames(lua_State* L);
   const World world_;
 };
 
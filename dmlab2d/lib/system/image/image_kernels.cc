@@ -0,0 +1,370 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/image/image_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Eigen/Dense"
+
+namespace deepmind::lab2d {
+namespace {
+
+// Pixels are processed in blocks of this size so that intermediate values stay
+// in small stack buffers.
+constexpr std::size_t kBlockSize = 64;
+
+using ByteArrayMap =
+    Eigen::Map<Eigen::Array<unsigned char, Eigen::Dynamic, 1>>;
+
+// Source pixels contributing to each target pixel of a scanline scaled from
+// `source_len` to `target_len` pixels. Target pixel `t` is
+//
+//   (sum of weight[i] * source[index[i]] for i in [begin[t], begin[t + 1]))
+//       / divisor[t]
+//
+// accumulated in order. The taps only depend on the lengths, so they are
+// computed once per axis rather than once per row.
+struct ScaleTaps {
+  std::vector<std::size_t> begin;
+  std::vector<std::size_t> index;
+  std::vector<double> weight;
+  std::vector<double> divisor;
+
+  void AddTap(std::size_t source_index, double source_weight) {
+    index.push_back(source_index);
+    weight.push_back(source_weight);
+  }
+
+  void EndTarget(double target_divisor) {
+    begin.push_back(index.size());
+    divisor.push_back(target_divisor);
+  }
+};
+
+// Supersampling: linearly interpolate between neighbouring source pixels.
+void AddLinearMagnifyTaps(std::size_t source_len, std::size_t target_len,
+                          ScaleTaps* taps) {
+  double stride = (target_len - 1) / static_cast<double>(source_len - 1);
+  double top_idx_f = 0.0;
+  std::size_t top_idx_i = 0;
+  for (std::size_t i = 1; i < source_len; ++i) {
+    std::size_t low_idx_i = top_idx_i;
+    top_idx_f += stride;
+    top_idx_i = top_idx_f + 0.5;
+    double rcp_stride = 1.0 / (top_idx_i - low_idx_i);
+    for (std::size_t j = low_idx_i; j < top_idx_i; ++j) {
+      double low_wgt = (top_idx_i - j) * rcp_stride;
+      taps->AddTap(i - 1, low_wgt);
+      taps->AddTap(i, 1.0 - low_wgt);
+      taps->EndTarget(1.0);
+    }
+  }
+  taps->AddTap(source_len - 1, 1.0);
+  taps->EndTarget(1.0);
+}
+
+// Supersampling: sample the nearest source pixel.
+void AddNearestMagnifyTaps(std::size_t source_len, std::size_t target_len,
+                           ScaleTaps* taps) {
+  double stride = target_len / static_cast<double>(source_len);
+  double top_idx_f = 0.0;
+  std::size_t top_idx_i = 0;
+  for (std::size_t i = 0; i < source_len; ++i) {
+    std::size_t low_idx_i = top_idx_i;
+    top_idx_f += stride;
+    top_idx_i = top_idx_f + 0.5;
+    for (std::size_t j = low_idx_i; j < top_idx_i; ++j) {
+      taps->AddTap(i, 1.0);
+      taps->EndTarget(1.0);
+    }
+  }
+}
+
+// Subsampling: average all source pixels mapped onto a single target pixel,
+// accounting for source pixels which are split between adjacent target pixels.
+void AddAveragingMinifyTaps(std::size_t source_len, std::size_t target_len,
+                            ScaleTaps* taps) {
+  double stride = source_len / static_cast<double>(target_len);
+  double top_idx_f = 0.0;
+  std::size_t top_idx_i = 0;
+  for (std::size_t i = 0; i < target_len; ++i) {
+    double low_idx_f = top_idx_f;
+    std::size_t low_idx_i = top_idx_i;
+    top_idx_f += stride;
+    top_idx_i = static_cast<std::size_t>(top_idx_f);
+    taps->AddTap(low_idx_i, 1.0 - (low_idx_f - low_idx_i));
+    for (std::size_t j = low_idx_i + 1; j < top_idx_i; j++) {
+      taps->AddTap(j, 1.0);
+    }
+    if (top_idx_f > top_idx_i) {
+      taps->AddTap(std::min(top_idx_i, source_len - 1), top_idx_f - top_idx_i);
+    }
+    taps->EndTarget(stride);
+  }
+}
+
+ScaleTaps MakeScaleTaps(ScaleMode mode, std::size_t source_len,
+                        std::size_t target_len) {
+  ScaleTaps taps;
+  taps.begin.reserve(target_len + 1);
+  taps.divisor.reserve(target_len);
+  taps.begin.push_back(0);
+  if (source_len == 1) {
+    for (std::size_t i = 0; i < target_len; ++i) {
+      taps.AddTap(0, 1.0);
+      taps.EndTarget(1.0);
+    }
+  } else if (source_len >= target_len) {
+    AddAveragingMinifyTaps(source_len, target_len, &taps);
+  } else if (mode == ScaleMode::kBilinear) {
+    AddLinearMagnifyTaps(source_len, target_len, &taps);
+  } else {
+    AddNearestMagnifyTaps(source_len, target_len, &taps);
+  }
+  assert(taps.divisor.size() == target_len);
+  return taps;
+}
+
+// Scales each of `rows` rows of `source` from `source_cols` to the number of
+// target pixels in `taps`.
+void ScaleColumns(std::size_t num_channels, std::size_t rows,
+                  std::size_t source_cols, const unsigned char* source,
+                  const ScaleTaps& taps, double* target) {
+  const std::size_t target_cols = taps.divisor.size();
+  std::array<double, 4> acc;
+  for (std::size_t r = 0; r < rows; ++r) {
+    const unsigned char* source_row = source + r * source_cols * num_channels;
+    for (std::size_t t = 0; t < target_cols; ++t) {
+      const std::size_t first = taps.begin[t];
+      const std::size_t last = taps.begin[t + 1];
+      const unsigned char* pixel =
+          source_row + taps.index[first] * num_channels;
+      for (std::size_t c = 0; c < num_channels; ++c) {
+        acc[c] = taps.weight[first] * pixel[c];
+      }
+      for (std::size_t k = first + 1; k < last; ++k) {
+        pixel = source_row + taps.index[k] * num_channels;
+        for (std::size_t c = 0; c < num_channels; ++c) {
+          acc[c] += taps.weight[k] * pixel[c];
+        }
+      }
+      // Dividing by 1.0 is exact, so magnification can skip it.
+      if (taps.divisor[t] != 1.0) {
+        for (std::size_t c = 0; c < num_channels; ++c) {
+          acc[c] /= taps.divisor[t];
+        }
+      }
+      target = std::copy_n(acc.begin(), num_channels, target);
+    }
+  }
+}
+
+// Combines whole rows of `source`, each `row_len` elements long, into the
+// target rows described by `taps`. Each step operates on entire rows.
+void ScaleRows(std::size_t row_len, const double* source,
+               const ScaleTaps& taps, unsigned char* target) {
+  auto source_row = [source, row_len](std::size_t row) {
+    return Eigen::Map<const Eigen::ArrayXd>(source + row * row_len, row_len);
+  };
+  Eigen::ArrayXd acc(row_len);
+  const std::size_t target_rows = taps.divisor.size();
+  for (std::size_t t = 0; t < target_rows; ++t) {
+    const std::size_t first = taps.begin[t];
+    const std::size_t last = taps.begin[t + 1];
+    acc = taps.weight[first] * source_row(taps.index[first]);
+    for (std::size_t k = first + 1; k < last; ++k) {
+      acc += taps.weight[k] * source_row(taps.index[k]);
+    }
+    if (taps.divisor[t] != 1.0) {
+      acc /= taps.divisor[t];
+    }
+    ByteArrayMap(target + t * row_len, row_len) =
+        acc.cast<int>().cast<unsigned char>();
+  }
+}
+
+// Hue specific values used when converting Hue, Saturation and Lightness to
+// RGB.
+struct HueParams {
+  explicit HueParams(double hue) {
+    double hue_prime = hue / 60.0;
+    if (!(0 <= hue_prime && hue_prime < 6.0)) {
+      hue_prime -= 6.0 * std::floor(hue_prime / 6.0);
+    }
+    double hue_mod_2 = hue_prime - 2.0 * (std::floor(hue_prime / 2.0));
+    partial = 1.0 - std::abs(hue_mod_2 - 1.0);
+    // Channels receiving the largest, middle and smallest component.
+    switch (static_cast<int>(hue_prime)) {
+      default:
+      case 0:
+        c_channel = 0, x_channel = 1, m_channel = 2;
+        break;
+      case 1:
+        c_channel = 1, x_channel = 0, m_channel = 2;
+        break;
+      case 2:
+        c_channel = 1, x_channel = 2, m_channel = 0;
+        break;
+      case 3:
+        c_channel = 2, x_channel = 1, m_channel = 0;
+        break;
+      case 4:
+        c_channel = 2, x_channel = 0, m_channel = 1;
+        break;
+      case 5:
+        c_channel = 0, x_channel = 2, m_channel = 1;
+        break;
+    }
+  }
+
+  double partial;
+  int c_channel;
+  int x_channel;
+  int m_channel;
+};
+
+// Returns the largest, middle and smallest components of a pixel with the new
+// hue, given the smallest and largest of its RGB components. Only S and L of
+// HSL are needed from the source pixel and both are functions of these two
+// components.
+std::array<unsigned char, 3> HueComponents(const HueParams& params,
+                                           unsigned char min_value,
+                                           unsigned char max_value) {
+  double hmin = (0.5 / 255.0) * min_value;
+  double hmax = (0.5 / 255.0) * max_value;
+  double l = hmax + hmin;
+  double hdif = hmax - hmin;
+  double s;
+  if (min_value == max_value) {
+    s = 0;
+  } else if (l > 0.5) {
+    s = hdif / (1.0 - l);
+  } else {
+    s = hdif / l;
+  }
+  double c = s * (1.0 - std::abs(2.0 * l - 1.0));
+  double x = c * params.partial;
+  double m = l - 0.5 * c;
+  c += m;
+  x += m;
+  return {static_cast<unsigned char>(c * 255.0),
+          static_cast<unsigned char>(x * 255.0),
+          static_cast<unsigned char>(m * 255.0)};
+}
+
+// Returns `value` / 255 rounded down, for `value` in [0, 65535).
+inline std::uint16_t Div255(std::uint16_t value) {
+  return (value + 1 + (value >> 8)) >> 8;
+}
+
+}  // namespace
+
+void ScaleImage(ScaleMode mode, std::size_t num_channels,
+                std::size_t source_rows, std::size_t source_cols,
+                const unsigned char* source, std::size_t target_rows,
+                std::size_t target_cols, unsigned char* target) {
+  assert(num_channels <= 4);
+  ScaleTaps col_taps = MakeScaleTaps(mode, source_cols, target_cols);
+  ScaleTaps row_taps = MakeScaleTaps(mode, source_rows, target_rows);
+  std::vector<double> tmp(source_rows * target_cols * num_channels);
+  ScaleColumns(num_channels, source_rows, source_cols, source, col_taps,
+               tmp.data());
+  ScaleRows(target_cols * num_channels, tmp.data(), row_taps, target);
+}
+
+void SetImageHue(double hue, std::size_t num_channels, std::size_t num_pixels,
+                 unsigned char* pixels) {
+  assert(num_channels == 3 || num_channels == 4);
+  const HueParams params(hue);
+  // Sprites use few distinct colours, so the double precision conversion is
+  // memoized in a small direct-mapped cache keyed on the components it depends
+  // on.
+  struct CacheEntry {
+    int key;
+    std::array<unsigned char, 3> components;
+  };
+  std::array<CacheEntry, 256> cache;
+  for (auto& entry : cache) {
+    entry.key = -1;
+  }
+  for (std::size_t i = 0; i < num_pixels; ++i) {
+    unsigned char* rgb = pixels + i * num_channels;
+    const unsigned char min_value = std::min({rgb[0], rgb[1], rgb[2]});
+    const unsigned char max_value = std::max({rgb[0], rgb[1], rgb[2]});
+    const int key = (min_value << 8) | max_value;
+    CacheEntry& entry = cache[(min_value * 31 + max_value) & 255];
+    if (entry.key != key) {
+      entry.key = key;
+      entry.components = HueComponents(params, min_value, max_value);
+    }
+    rgb[params.c_channel] = entry.components[0];
+    rgb[params.x_channel] = entry.components[1];
+    rgb[params.m_channel] = entry.components[2];
+  }
+}
+
+void ApplyMaskedPattern(const unsigned char* pattern, std::size_t pattern_span,
+                        std::size_t num_pixels,
+                        const std::array<unsigned char, 3>& color1,
+                        const std::array<unsigned char, 3>& color2,
+                        unsigned char* rgba) {
+  // The pattern colour only depends on the pattern value.
+  std::array<std::array<std::uint16_t, 4>, 256> pattern_colors;
+  for (int value = 0; value < 256; ++value) {
+    for (int c = 0; c < 3; ++c) {
+      pattern_colors[value][c] =
+          (value * color1[c] + (255 - value) * color2[c] + 127) / 255;
+    }
+    pattern_colors[value][3] = 255;
+  }
+
+  // Each channel becomes (w * pattern + (255 - w) * source + 127) / 255, where
+  // w is the source alpha. Using w = 255 and pattern = 255 for the alpha
+  // channel itself sets it to 255. The blend always runs over a whole block,
+  // so that its trip count is a compile time constant.
+  constexpr std::size_t kBlockBytes = 4 * kBlockSize;
+  std::array<std::uint16_t, kBlockBytes> colors = {};
+  std::array<std::uint16_t, kBlockBytes> weights = {};
+  std::array<unsigned char, kBlockBytes> bytes = {};
+  for (std::size_t start = 0; start < num_pixels; start += kBlockSize) {
+    const std::size_t count = std::min(kBlockSize, num_pixels - start);
+    unsigned char* block = rgba + start * 4;
+    std::copy_n(block, count * 4, bytes.begin());
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto& color = pattern_colors[pattern[(start + i) * pattern_span]];
+      std::copy(color.begin(), color.end(), colors.begin() + i * 4);
+      const std::uint16_t alpha = bytes[i * 4 + 3];
+      weights[i * 4 + 0] = alpha;
+      weights[i * 4 + 1] = alpha;
+      weights[i * 4 + 2] = alpha;
+      weights[i * 4 + 3] = 255;
+    }
+    for (std::size_t i = 0; i < kBlockBytes; ++i) {
+      const std::uint16_t w = weights[i];
+      bytes[i] = Div255(w * colors[i] + (255 - w) * bytes[i] + 127);
+    }
+    std::copy_n(bytes.begin(), count * 4, block);
+  }
+}
+
+}  // namespace deepmind::lab2d
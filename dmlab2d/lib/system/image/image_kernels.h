@@ -0,0 +1,61 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Pixel kernels behind `image.scale`, `image.setHue` and
+// `image.setMaskedPattern`. All images are contiguous and row-major with
+// interleaved channels. Results are bit-identical to the original per-pixel
+// implementations; the inner loops run over whole rows or fixed-size blocks so
+// that they vectorize.
+
+#ifndef DMLAB2D_LIB_SYSTEM_IMAGE_IMAGE_KERNELS_H_
+#define DMLAB2D_LIB_SYSTEM_IMAGE_IMAGE_KERNELS_H_
+
+#include <array>
+#include <cstddef>
+
+namespace deepmind::lab2d {
+
+enum class ScaleMode { kBilinear, kNearest };
+
+// Scales the {source_rows, source_cols, num_channels} image `source` into the
+// {target_rows, target_cols, num_channels} image `target`. Magnification uses
+// `mode`; minification averages all source pixels covered by a target pixel.
+// Rows and columns are scaled separately. `num_channels` must be at most 4 and
+// all dimensions must be non-zero.
+void ScaleImage(ScaleMode mode, std::size_t num_channels,
+                std::size_t source_rows, std::size_t source_cols,
+                const unsigned char* source, std::size_t target_rows,
+                std::size_t target_cols, unsigned char* target);
+
+// Sets the hue of `num_pixels` RGB or RGBA pixels in-place to `hue` degrees,
+// keeping their saturation and lightness in the HSL colour space. Alpha is left
+// unchanged. `num_channels` must be 3 or 4.
+void SetImageHue(double hue, std::size_t num_channels, std::size_t num_pixels,
+                 unsigned char* pixels);
+
+// Blends `num_pixels` RGBA pixels in-place with a pattern colour, using each
+// pixel's alpha as the pattern's opacity, and then sets alpha to 255. The
+// pattern colour of a pixel interpolates between `color2` and `color1`
+// according to `pattern[pixel * pattern_span]`, from 0 to 255 respectively.
+void ApplyMaskedPattern(const unsigned char* pattern, std::size_t pattern_span,
+                        std::size_t num_pixels,
+                        const std::array<unsigned char, 3>& color1,
+                        const std::array<unsigned char, 3>& color2,
+                        unsigned char* rgba);
+
+}  // namespace deepmind::lab2d
+
+#endif  // DMLAB2D_LIB_SYSTEM_IMAGE_IMAGE_KERNELS_H_
@@ -0,0 +1,126 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "dmlab2d/lib/system/image/image_kernels.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+// Returns a `size` x `size` RGBA image of deterministic noise.
+std::vector<unsigned char> MakeImage(std::size_t size) {
+  std::vector<unsigned char> image(size * size * 4);
+  for (std::size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<unsigned char>(i * 37 + (i >> 5));
+  }
+  return image;
+}
+
+// Returns a `size` x `size` RGBA sprite drawn with a few colours.
+std::vector<unsigned char> MakeSprite(std::size_t size) {
+  constexpr unsigned char kPalette[][4] = {
+      {0, 0, 0, 0},         {40, 40, 40, 255},   {200, 180, 60, 255},
+      {150, 90, 30, 255},   {250, 250, 250, 255}, {30, 90, 200, 255},
+  };
+  std::vector<unsigned char> image(size * size * 4);
+  for (std::size_t i = 0; i < size * size; ++i) {
+    const auto& color = kPalette[(i / 3 + i / size) % 6];
+    std::copy_n(color, 4, &image[i * 4]);
+  }
+  return image;
+}
+
+// Scales a square sprite from state.range(0) to state.range(1) pixels wide.
+void Scale(benchmark::State& state, ScaleMode mode) {
+  const std::size_t source_size = state.range(0);
+  const std::size_t target_size = state.range(1);
+  auto source = MakeImage(source_size);
+  std::vector<unsigned char> target(target_size * target_size * 4);
+  for (auto _ : state) {
+    ScaleImage(mode, 4, source_size, source_size, source.data(), target_size,
+               target_size, target.data());
+    benchmark::DoNotOptimize(target.data());
+  }
+  state.SetItemsProcessed(state.iterations() * target_size * target_size);
+}
+
+void BM_ScaleBilinear(benchmark::State& state) {
+  Scale(state, ScaleMode::kBilinear);
+}
+
+BENCHMARK(BM_ScaleBilinear)
+    ->Args({8, 16})
+    ->Args({16, 32})
+    ->Args({32, 64})
+    ->Args({64, 16});
+
+void BM_ScaleNearest(benchmark::State& state) {
+  Scale(state, ScaleMode::kNearest);
+}
+
+BENCHMARK(BM_ScaleNearest)
+    ->Args({8, 16})
+    ->Args({16, 32})
+    ->Args({32, 64})
+    ->Args({64, 16});
+
+void SetHue(benchmark::State& state, std::vector<unsigned char> image) {
+  const std::size_t size = state.range(0);
+  double hue = 0.0;
+  for (auto _ : state) {
+    SetImageHue(hue, 4, size * size, image.data());
+    hue += 7.0;
+    benchmark::DoNotOptimize(image.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+void BM_SetHue(benchmark::State& state) {
+  SetHue(state, MakeSprite(state.range(0)));
+}
+
+BENCHMARK(BM_SetHue)->Arg(16)->Arg(32)->Arg(64);
+
+// Worst case where most pixels have a distinct colour.
+void BM_SetHueNoise(benchmark::State& state) {
+  SetHue(state, MakeImage(state.range(0)));
+}
+
+BENCHMARK(BM_SetHueNoise)->Arg(32);
+
+void BM_SetMaskedPattern(benchmark::State& state) {
+  const std::size_t size = state.range(0);
+  const auto pattern = MakeImage(size);
+  auto image = MakeImage(size);
+  const std::array<unsigned char, 3> color1 = {200, 100, 50};
+  const std::array<unsigned char, 3> color2 = {10, 20, 30};
+  for (auto _ : state) {
+    ApplyMaskedPattern(pattern.data(), 4, size * size, color1, color2,
+                       image.data());
+    benchmark::DoNotOptimize(image.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK(BM_SetMaskedPattern)->Arg(16)->Arg(32)->Arg(64);
+
+}  // namespace
+}  // namespace deepmind::lab2d
@@ -0,0 +1,108 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/image/image_kernels.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+TEST(ImageKernelsTest, ScaleNearestMagnifies) {
+  const std::vector<unsigned char> source = {1, 2,  //
+                                             3, 4};
+  std::vector<unsigned char> target(3 * 4);
+  ScaleImage(ScaleMode::kNearest, 1, 2, 2, source.data(), 3, 4,
+             target.data());
+  EXPECT_THAT(target, ElementsAre(1, 1, 2, 2,  //
+                                  1, 1, 2, 2,  //
+                                  3, 3, 4, 4));
+}
+
+TEST(ImageKernelsTest, ScaleBilinearInterpolates) {
+  const std::vector<unsigned char> source = {0, 100, 200,  //
+                                             100, 200, 250};
+  std::vector<unsigned char> target(1 * 5 * 3);
+  // One row of three RGB pixels becomes one row of five pixels.
+  ScaleImage(ScaleMode::kBilinear, 3, 1, 2, source.data(), 1, 5,
+             target.data());
+  EXPECT_THAT(target, ElementsAre(0, 100, 200,     //
+                                  25, 125, 212,    //
+                                  50, 150, 225,    //
+                                  75, 175, 237,    //
+                                  100, 200, 250));
+}
+
+TEST(ImageKernelsTest, ScaleAveragesWhenMinifying) {
+  const std::vector<unsigned char> source = {10, 20, 30, 40,  //
+                                             50, 60, 70, 80};
+  std::vector<unsigned char> target(1 * 2);
+  ScaleImage(ScaleMode::kBilinear, 1, 2, 4, source.data(), 1, 2,
+             target.data());
+  EXPECT_THAT(target, ElementsAre(35, 55));
+}
+
+TEST(ImageKernelsTest, ScaleReplicatesSinglePixel) {
+  const std::vector<unsigned char> source = {1, 2, 3, 4};
+  std::vector<unsigned char> target(2 * 3 * 4);
+  ScaleImage(ScaleMode::kBilinear, 4, 1, 1, source.data(), 2, 3,
+             target.data());
+  for (std::size_t i = 0; i < target.size(); i += 4) {
+    EXPECT_THAT(std::vector<unsigned char>(&target[i], &target[i + 4]),
+                ElementsAreArray(source));
+  }
+}
+
+TEST(ImageKernelsTest, SetHueKeepsSaturationAndLightness) {
+  std::vector<unsigned char> pixels = {255, 0,   0,   128,  //
+                                       0,   0,   0,   255,  //
+                                       200, 200, 200, 0,    //
+                                       255, 0,   0,   1};
+  SetImageHue(120.0, 4, 4, pixels.data());
+  EXPECT_THAT(pixels, ElementsAre(0, 255, 0, 128,      //
+                                  0, 0, 0, 255,        //
+                                  200, 200, 200, 0,    //
+                                  0, 255, 0, 1));
+  std::vector<unsigned char> rgb = {0, 0, 255};
+  SetImageHue(-60.0, 3, 1, rgb.data());
+  EXPECT_THAT(rgb, ElementsAre(255, 0, 255));
+}
+
+TEST(ImageKernelsTest, ApplyMaskedPatternBlendsByAlpha) {
+  std::vector<unsigned char> rgba = {10, 20, 30, 0,     //
+                                     10, 20, 30, 255,   //
+                                     10, 20, 30, 255,   //
+                                     100, 100, 100, 128};
+  const std::vector<unsigned char> pattern = {255, 9, 255, 9, 0, 9, 255, 9};
+  const std::array<unsigned char, 3> color1 = {200, 100, 50};
+  const std::array<unsigned char, 3> color2 = {0, 0, 0};
+  ApplyMaskedPattern(pattern.data(), 2, 4, color1, color2, rgba.data());
+  EXPECT_THAT(rgba, ElementsAre(10, 20, 30, 255,    //
+                                200, 100, 50, 255,  //
+                                0, 0, 0, 255,       //
+                                150, 100, 75, 255));
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d
@@ -64,4 +64,25 @@ function tests:loadImageLFromString()
   asserts.EQ(expected, image)
 end
 
+function tests:loadAllImages()
+  local images = image.loadAll{
+      TEST_DIR .. "testRGB.png",
+      TEST_DIR .. "testL.png",
+      TEST_DIR .. "testRGB.png",
+  }
+  asserts.EQ(#images, 3)
+  asserts.EQ(image.load(TEST_DIR .. "testRGB.png"), images[1])
+  asserts.EQ(image.load(TEST_DIR .. "testL.png"), images[2])
+  asserts.EQ(images[1], images[3])
+  -- Each call returns a new tensor.
+  images[3]:fill(0)
+  asserts.NE(images[1], images[3])
+end
+
+function tests:loadAllMissingImage()
+  asserts.shouldFail(function()
+    image.loadAll{TEST_DIR .. "testRGB.png", TEST_DIR .. "missing.png"}
+  end)
+end
+
 return test_runner.run(tests)
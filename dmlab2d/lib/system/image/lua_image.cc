@@ -18,13 +18,10 @@
 
 #include <algorithm>
 #include <array>
-#include <cassert>
-#include <cmath>
 #include <cstddef>
-#include <iterator>
 #include <memory>
 #include <string>
-#include <type_traits>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -37,118 +34,20 @@
 #include "dmlab2d/lib/lua/push.h"
 #include "dmlab2d/lib/lua/read.h"
 #include "dmlab2d/lib/lua/table_ref.h"
+#include "dmlab2d/lib/system/image/image_kernels.h"
+#include "dmlab2d/lib/system/image/png_cache.h"
 #include "dmlab2d/lib/system/tensor/lua/tensor.h"
 #include "dmlab2d/lib/system/tensor/tensor_view.h"
-#include "dmlab2d/lib/util/file_reader.h"
 #include "dmlab2d/lib/util/file_reader_types.h"
-#include "png.h"
 
 namespace deepmind::lab2d {
 namespace {
 
-std::vector<unsigned char> PngParsePixels(png_structp png_ptr,
-                                          png_infop info_ptr,
-                                          const tensor::ShapeVector& shape) {
-  std::vector<unsigned char> bytes;
-  bytes.reserve(shape[0] * shape[1] * shape[2]);
-  const png_uint_32 bytesPerRow = png_get_rowbytes(png_ptr, info_ptr);
-  std::unique_ptr<unsigned char[]> row_data(new unsigned char[bytesPerRow]);
-  auto bytes_inserter = std::back_inserter(bytes);
-  for (std::size_t rowIdx = 0; rowIdx < shape[0]; ++rowIdx) {
-    png_read_row(png_ptr, row_data.get(), nullptr);
-    std::copy_n(row_data.get(), shape[1] * shape[2], bytes_inserter);
-  }
-  return bytes;
-}
-
-struct Reader {
-  absl::string_view contents;
-  std::size_t location;
-};
-
-extern "C" {
-static void PngReadContents(png_structp png_ptr, png_bytep out_bytes,
-                            png_size_t count) {
-  Reader* reader = static_cast<Reader*>(png_get_io_ptr(png_ptr));
-  if (count + reader->location <= reader->contents.size()) {
-    std::copy_n(reader->contents.begin() + reader->location, count, out_bytes);
-  }
-  reader->location += count;
-}
-}  // extern "C"
-
-lua::NResultsOr LoadPng(lua_State* L, absl::string_view contents) {
-  Reader reader{contents, 0};
-  constexpr std::size_t png_header_size = 8;
-  if (reader.contents.size() < png_header_size) {
-    return "Invalid format. Contents too short.";
-  }
-
-  if (!png_check_sig(reinterpret_cast<png_const_bytep>(&reader.contents[0]),
-                     png_header_size))
-    return "Invalid format. Unrecognised signature.";
-
-  reader.location += png_header_size;
-
-  struct Png {
-    png_structp ptr;
-    png_infop info_ptr;
-    ~Png() {
-      png_destroy_read_struct(ptr ? &ptr : nullptr,
-                              info_ptr ? &info_ptr : nullptr, nullptr);
-    }
-  };
-
-  Png png = {};
-
-  png.ptr =
-      png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-  if (!png.ptr) return "Internal error.";
-
-  png.info_ptr = png_create_info_struct(png.ptr);
-  if (!png.info_ptr) return "Internal error.";
-
-  png_set_read_fn(png.ptr, &reader, &PngReadContents);
-
-  png_set_sig_bytes(png.ptr, png_header_size);
-  png_read_info(png.ptr, png.info_ptr);
-  png_uint_32 width = 0;
-  png_uint_32 height = 0;
-  int bitDepth = 0;
-  int colorType = -1;
-  png_uint_32 retval =
-      png_get_IHDR(png.ptr, png.info_ptr, &width, &height, &bitDepth,
-                   &colorType, nullptr, nullptr, nullptr);
-
-  if (retval != 1) return "Invalid format. Corrupted header.";
-  if (bitDepth != 8)
-    return "Unsupported format. Image must have 8-bit channels.";
-
-  tensor::ShapeVector shape = {height, width, 0};
-
-  switch (colorType) {
-    case PNG_COLOR_TYPE_GRAY:
-      shape[2] = 1;
-      break;
-    case PNG_COLOR_TYPE_GRAY_ALPHA:
-      shape[2] = 2;
-      break;
-    case PNG_COLOR_TYPE_RGB:
-      shape[2] = 3;
-      break;
-    case PNG_COLOR_TYPE_RGB_ALPHA:
-      shape[2] = 4;
-      break;
-    default:
-      return "Unsupported format. Image must not be paletted.";
-  }
+constexpr std::size_t kMaxLoadThreads = 8;
 
-  auto bytes = PngParsePixels(png.ptr, png.info_ptr, shape);
-  if (reader.location > reader.contents.size())
-    return "Invalid format. Contents too short.";
-  tensor::LuaTensor<unsigned char>::CreateObject(L, std::move(shape),
-                                                 std::move(bytes));
-  return 1;
+// Pushes a new ByteTensor holding a copy of `image`.
+void PushImage(lua_State* L, const DecodedImage& image) {
+  tensor::LuaTensor<unsigned char>::CreateObject(L, image.shape, image.pixels);
 }
 
 lua::NResultsOr Load(lua_State* L) {
@@ -164,274 +63,82 @@ lua::NResultsOr Load(lua_State* L) {
     return absl::StrCat("[image.load] - \"", lua::ToString(L, 1),
                         "\" - Invalid name");
   }
+  if (file_name.compare(file_name.length() - 4, 4, ".png") != 0) {
+    return absl::StrCat("[image.load] - \"", file_name,
+                        "\" - Unsupported file type.");
+  }
 
-  absl::string_view contents;
-  std::unique_ptr<char[]> data;
   if (file_name.compare(0, file_name.length() - 4, "content:") == 0) {
+    absl::string_view contents;
     if (!lua::Read(L, 2, &contents)) {
       return "[image.load] - Missing contents.";
     }
-  } else {
-    util::FileReader reader(fs, file_name.c_str());
-    if (![&reader, &data, &contents] {
-          if (!reader.Success()) return false;
-          std::size_t size;
-          if (!reader.GetSize(&size)) return false;
-          data.reset(new char[size]);
-          contents = {data.get(), size};
-          return reader.Read(0, size, data.get());
-        }()) {
-      return absl::StrCat("[image.load] - \"", file_name,
-                          "\" could not be read.");
-    }
-  }
-
-  if (file_name.compare(file_name.length() - 4, 4, ".png") == 0) {
-    auto status = LoadPng(L, contents);
-    if (!status.ok()) {
+    DecodedImage image;
+    std::string error;
+    if (!DecodePng(contents, &image, &error)) {
       return absl::StrCat("[image.load] (PNG) - \"", file_name, "\" - ",
-                          status.error());
-    }
-    return status;
-  }
-  return absl::StrCat("[image.load] - \"", file_name,
-                      "\" - Unsupported file type.");
-}
-
-class LinearMagnifier {
- public:
-  // Given an image with 'num_channels' channels, scales up the
-  // scanline pointed to by 'source' from 'source_len' elements to 'target_len',
-  // storing the resulting pixels in 'target'. Such scaling is performed using
-  // linear interpolation.
-  // Returns the iterator position past the last computed pixel.
-  template <typename Iter1, typename Iter2>
-  Iter2 operator()(              //
-      std::size_t num_channels,  //
-      std::size_t source_len,    //
-      Iter1 source,              //
-      std::size_t target_len,    //
-      Iter2 target) const {
-    assert(source_len > 1);
-    assert(source_len < target_len);
-    // Supersampling: linearly interpolate source pixels.
-    std::array<double, 4> low, top;
-    double stride = (target_len - 1) / static_cast<double>(source_len - 1);
-    double top_idx_f = 0.0;
-    std::size_t top_idx_i = 0;
-    std::copy_n(source, num_channels, top.begin());
-    for (std::size_t i = 1; i < source_len; ++i) {
-      std::size_t low_idx_i = top_idx_i;
-      std::swap(low, top);
-      top_idx_f += stride;
-      top_idx_i = top_idx_f + 0.5;
-      std::size_t k = i * num_channels;
-      std::copy_n(source + k, num_channels, top.begin());
-      double rcp_stride = 1.0 / (top_idx_i - low_idx_i);
-      for (std::size_t j = low_idx_i; j < top_idx_i; ++j) {
-        double low_wgt = (top_idx_i - j) * rcp_stride;
-        double top_wgt = 1.0 - low_wgt;
-        for (std::size_t c = 0; c < num_channels; ++c) {
-          *target = low_wgt * low[c] + top_wgt * top[c];
-          ++target;
-        }
-      }
+                          error);
     }
-    return std::copy_n(top.begin(), num_channels, target);
+    tensor::LuaTensor<unsigned char>::CreateObject(L, std::move(image.shape),
+                                                   std::move(image.pixels));
+    return 1;
   }
-};
 
-class NearestMagnifier {
- public:
-  // Given an image with 'num_channels' channels, scales up the scanline pointed
-  // to by 'source' from 'source_len' elements to 'target_len', storing the
-  // resulting pixels in 'target'. Such scaling is performed by sampling the
-  // nearest source pixel.
-  // Returns the iterator position past the last computed pixel.
-  template <typename Iter1, typename Iter2>
-  Iter2 operator()(              //
-      std::size_t num_channels,  //
-      std::size_t source_len,    //
-      Iter1 source,              //
-      std::size_t target_len,    //
-      Iter2 target) const {
-    assert(source_len > 1);
-    assert(source_len < target_len);
-    // Supersampling: sample nearest source pixel.
-    double stride = target_len / static_cast<double>(source_len);
-    double top_idx_f = 0.0;
-    std::size_t top_idx_i = 0;
-    for (std::size_t i = 0; i < source_len; ++i) {
-      std::size_t low_idx_i = top_idx_i;
-      top_idx_f += stride;
-      top_idx_i = top_idx_f + 0.5;
-      std::size_t k = i * num_channels;
-      for (std::size_t j = low_idx_i; j < top_idx_i; ++j) {
-        target = std::copy_n(source + k, num_channels, target);
-      }
-    }
-    return target;
-  }
-};
-
-// Given an image with 'num_channels' channels, scales down the scanline
-// pointed to by 'source' from 'source_len' elements to 'target_len', storing
-// the resulting pixels in 'target'. Such pixels are computed as the average of
-// all the 'source' pixels mapped onto a single 'target' pixel, accounting for
-// 'source' pixels which are split between adjacent 'target' pixels. Returns the
-// iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2>
-Iter2 averagingMinify(         //
-    std::size_t num_channels,  //
-    std::size_t source_len,    //
-    Iter1 source,              //
-    std::size_t target_len,    //
-    Iter2 target) {
-  std::array<double, 4> acc;
-  double stride = source_len / static_cast<double>(target_len);
-  double top_idx_f = 0.0;
-  std::size_t top_idx_i = 0;
-  for (std::size_t i = 0; i < target_len; ++i) {
-    double low_idx_f = top_idx_f;
-    std::size_t low_idx_i = top_idx_i;
-    top_idx_f += stride;
-    top_idx_i = static_cast<std::size_t>(top_idx_f);
-    double low_wgt = 1.0 - (low_idx_f - low_idx_i);
-    std::size_t k = low_idx_i * num_channels;
-    for (std::size_t c = 0; c < num_channels; ++c) {
-      acc[c] = low_wgt * source[k + c];
-    }
-    for (std::size_t j = low_idx_i + 1; j < top_idx_i; j++) {
-      std::size_t k = j * num_channels;
-      for (std::size_t c = 0; c < num_channels; ++c) {
-        acc[c] += source[k + c];
-      }
-    }
-    if (top_idx_f > top_idx_i) {
-      double top_wgt = top_idx_f - top_idx_i;
-      std::size_t k = std::min(top_idx_i, source_len - 1) * num_channels;
-      for (std::size_t c = 0; c < num_channels; ++c) {
-        acc[c] += top_wgt * source[k + c];
-      }
-    }
-    for (std::size_t c = 0; c < num_channels; ++c) {
-      *target = acc[c] / stride;
-      ++target;
-    }
+  std::string error;
+  auto image = PngCache::Default()->Load(fs, file_name, &error);
+  if (image == nullptr) {
+    return absl::StrCat("[image.load] ", error);
   }
-  return target;
+  PushImage(L, *image);
+  return 1;
 }
 
-// Given an single-pixel scanline using 'num_channels' channels, repeats that
-// pixel 'target_len' times and stores the result in 'target'
-// Returns the iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2>
-Iter2 replicate(               //
-    std::size_t num_channels,  //
-    Iter1 source,              //
-    std::size_t target_len,    //
-    Iter2 target) {
-  for (std::size_t i = 0; i < target_len; ++i) {
-    target = std::copy_n(source, num_channels, target);
+// Loads many PNG files, decoding them in parallel on worker threads.
+//
+// function image.loadAll(paths)
+//
+// Lua Arguments:
+//
+// 1.  'paths' - Array of PNG file names.
+//
+// Returns an array of ByteTensors in the same order as 'paths'.
+lua::NResultsOr LoadAll(lua_State* L) {
+  const DeepMindReadOnlyFileSystem* fs = nullptr;
+  if (IsTypeMismatch(lua::Read(L, lua_upvalueindex(1), &fs))) {
+    return "[image.loadAll] Invalid filesystem in upvalue";
   }
-  return target;
-}
-
-// Given an image with 'num_channels' channels, scales the scanline pointed to
-// by 'source' from 'source_len' elements to 'target_len', using functor
-// 'Magnifier' for supersampling and averagingMinify for subsampling.
-// The resulting pixels are stored in 'target'.
-// Returns the iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2, typename Magnifier>
-Iter2 scaleRow(                  //
-    std::size_t num_channels,    //
-    std::size_t source_len,      //
-    Iter1 source,                //
-    const Magnifier& magnifier,  //
-    std::size_t target_len,      //
-    Iter2 target) {
-  assert(num_channels <= 4);
-  if (source_len > 1) {
-    if (source_len < target_len) {
-      target = magnifier(num_channels, source_len, source, target_len, target);
-    } else if (target_len > 0) {
-      target =
-          averagingMinify(num_channels, source_len, source, target_len, target);
+  if (fs == nullptr) {
+    return "[image.loadAll] Internal error - missing "
+           "DeepMindReadOnlyFileSystem.";
+  }
+  std::vector<std::string> file_names;
+  if (!IsFound(lua::Read(L, 1, &file_names))) {
+    return absl::StrCat("[image.loadAll] - Arg 1 \"", lua::ToString(L, 1),
+                        "\" - Must be an array of file names");
+  }
+  for (const auto& file_name : file_names) {
+    if (file_name.size() < 4 ||
+        file_name.compare(file_name.length() - 4, 4, ".png") != 0) {
+      return absl::StrCat("[image.loadAll] - \"", file_name,
+                          "\" - Unsupported file type.");
     }
-  } else {
-    target = replicate(num_channels, source, target_len, target);
   }
-  return target;
-}
 
-// Scales all 'source_rows' rows of input image 'source' to the width given by
-// 'target_cols', by repeatedly calling 'scaleRows' on each of them.
-// Returns the iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2, typename Magnifier>
-Iter2 scaleRows(                 //
-    std::size_t num_channels,    //
-    std::size_t source_rows,     //
-    std::size_t source_cols,     //
-    Iter1 source,                //
-    const Magnifier& magnifier,  //
-    std::size_t target_cols,     //
-    Iter2 target) {
-  for (std::size_t r = 0; r < source_rows; ++r) {
-    target = scaleRow(num_channels, source_cols, source, magnifier, target_cols,
-                      target);
-    source += source_cols * num_channels;
+  std::size_t max_threads =
+      std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1,
+                              kMaxLoadThreads);
+  std::string error;
+  auto images =
+      PngCache::Default()->LoadAll(fs, file_names, max_threads, &error);
+  if (images.size() != file_names.size()) {
+    return absl::StrCat("[image.loadAll] ", error);
   }
-  return target;
-}
-
-// Variant of linearScaleRows which stores the results in a transposed layout.
-// Returns the iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2, typename Magnifier>
-Iter2 scaleRowsTransposed(       //
-    std::size_t num_channels,    //
-    std::size_t source_rows,     //
-    std::size_t source_cols,     //
-    Iter1 source,                //
-    const Magnifier& magnifier,  //
-    std::size_t target_cols,     //
-    Iter2 target) {
-  using T = typename std::iterator_traits<Iter2>::value_type;
-  std::vector<T> target_trp;
-  target_trp.reserve(source_rows * target_cols * num_channels);
-  scaleRows(num_channels, source_rows, source_cols, source, magnifier,
-            target_cols, std::back_inserter(target_trp));
-  if (target_trp.empty()) {
-    return target;
-  }
-  tensor::TensorView<T> target_trp_mat(
-      tensor::Layout({source_rows, target_cols, num_channels}), &target_trp[0]);
-  target_trp_mat.Transpose(0, 1);
-  target_trp_mat.ForEach([&target](T val) { *target++ = val; });
-  return target;
-}
-
-// Compute an scaled image by sucessively scaling rows and columns.
-// Returns the iterator position past the last computed pixel.
-template <typename Iter1, typename Iter2, typename Magnifier>
-Iter2 scaleImage(                //
-    std::size_t num_channels,    //
-    std::size_t source_rows,     //
-    std::size_t source_cols,     //
-    Iter1 source,                //
-    const Magnifier& magnifier,  //
-    std::size_t target_rows,     //
-    std::size_t target_cols,     //
-    Iter2 target) {
-  // Scale rows and transpose.
-  std::vector<double> tmp(source_rows * target_cols * num_channels);
-  if (tmp.begin() == scaleRowsTransposed(num_channels, source_rows, source_cols,
-                                         source, magnifier, target_cols,
-                                         tmp.begin())) {
-    return target;
+  lua_createtable(L, images.size(), 0);
+  for (std::size_t i = 0; i < images.size(); ++i) {
+    PushImage(L, *images[i]);
+    lua_rawseti(L, -2, i + 1);
   }
-  // Scale columns and transpose.
-  return scaleRowsTransposed(num_channels, target_cols, source_rows,
-                             tmp.begin(), magnifier, target_rows, target);
+  return 1;
 }
 
 lua::NResultsOr Scale(lua_State* L) {
@@ -464,24 +171,22 @@ lua::NResultsOr Scale(lua_State* L) {
   std::size_t num_channels = view.shape()[2];
 
   // Compute the scaled image.
-  const unsigned char* tensor_start = &view.storage()[view.start_offset()];
-  std::vector<unsigned char> res(target_cols * target_rows * num_channels);
+  ScaleMode scale_mode;
   if (mode == "bilinear") {
-    if (res.begin() == scaleImage(num_channels, source_rows, source_cols,
-                                  tensor_start, LinearMagnifier(), target_rows,
-                                  target_cols, res.begin())) {
-      return 0;
-    }
+    scale_mode = ScaleMode::kBilinear;
   } else if (mode == "nearest") {
-    if (res.begin() == scaleImage(num_channels, source_rows, source_cols,
-                                  tensor_start, NearestMagnifier(), target_rows,
-                                  target_cols, res.begin())) {
-      return 0;
-    }
+    scale_mode = ScaleMode::kNearest;
   } else {
     return absl::StrCat("[image.scale] - \"", lua::ToString(L, 4),
                         "\" - Unsupported scaling mode");
   }
+  std::vector<unsigned char> res(target_cols * target_rows * num_channels);
+  if (res.empty() || source_rows == 0 || source_cols == 0) {
+    return 0;
+  }
+  ScaleImage(scale_mode, num_channels, source_rows, source_cols,
+             &view.storage()[view.start_offset()], target_rows, target_cols,
+             res.data());
 
   // Construct contiguous tensor and return it on the stack.
   tensor::ShapeVector res_shape = {target_rows, target_cols, num_channels};
@@ -490,90 +195,6 @@ lua::NResultsOr Scale(lua_State* L) {
   return 1;
 }
 
-// Converts RGB to S and L components of HSL.
-void RgbToSl(unsigned char r, unsigned char g, unsigned char b, double* s,
-             double* l) {
-  auto min_max = std::minmax({r, g, b});
-  double hmin = (0.5 / 255.0) * min_max.first;
-  double hmax = (0.5 / 255.0) * min_max.second;
-  *l = hmax + hmin;
-  double hdif = hmax - hmin;
-  if (min_max.first == min_max.second) {
-    *s = 0;
-  } else if (*l > 0.5) {
-    *s = hdif / (1.0 - *l);
-  } else {
-    *s = hdif / *l;
-  }
-}
-
-// Converts Hue Saturation and Lightness to RGB.
-// Hue specific calculations are performed at construction time.
-class HslToRgb {
- public:
-  // 'hue' Must be an angle in degrees.
-  explicit HslToRgb(double hue) {
-    hue_prime_ = hue / 60.0;
-    if (!(0 <= hue_prime_ && hue_prime_ < 6.0)) {
-      hue_prime_ -= 6.0 * std::floor(hue_prime_ / 6.0);
-    }
-    double hue_mod_2 = hue_prime_ - 2.0 * (std::floor(hue_prime_ / 2.0));
-    hue_partial_ = 1.0 - std::abs(hue_mod_2 - 1.0);
-    hue_case_ = static_cast<int>(hue_prime_);
-  }
-
-  // Perform the conversion. 'l' and 's' must be in the range [0, 1].
-  void operator()(double s, double l, unsigned char* r, unsigned char* g,
-                  unsigned char* b) {
-    double c = s * (1.0 - std::abs(2.0 * l - 1.0));
-    double x = c * hue_partial_;
-    double m = l - 0.5 * c;
-    c += m;
-    x += m;
-    m *= 255.0;
-    x *= 255.0;
-    c *= 255.0;
-    switch (hue_case_) {
-      default:
-      case 0:
-        *r = static_cast<unsigned char>(c);
-        *g = static_cast<unsigned char>(x);
-        *b = static_cast<unsigned char>(m);
-        break;
-      case 1:
-        *r = static_cast<unsigned char>(x);
-        *g = static_cast<unsigned char>(c);
-        *b = static_cast<unsigned char>(m);
-        break;
-      case 2:
-        *r = static_cast<unsigned char>(m);
-        *g = static_cast<unsigned char>(c);
-        *b = static_cast<unsigned char>(x);
-        break;
-      case 3:
-        *r = static_cast<unsigned char>(m);
-        *g = static_cast<unsigned char>(x);
-        *b = static_cast<unsigned char>(c);
-        break;
-      case 4:
-        *r = static_cast<unsigned char>(x);
-        *g = static_cast<unsigned char>(m);
-        *b = static_cast<unsigned char>(c);
-        break;
-      case 5:
-        *r = static_cast<unsigned char>(c);
-        *g = static_cast<unsigned char>(m);
-        *b = static_cast<unsigned char>(x);
-        break;
-    }
-  }
-
- private:
-  int hue_case_;
-  double hue_prime_;
-  double hue_partial_;
-};
-
 // Sets hue of an RGB image.
 //
 // Lua Arguments:
@@ -615,45 +236,12 @@ lua::NResultsOr SetHue(lua_State* L) {
     return "[image.setHue] - missing arg2 - hue";
   }
 
-  HslToRgb sl_to_rgb(hue);
-  std::size_t num_elements = view->num_elements();
   std::size_t num_channels = view->shape().back();
-  unsigned char* tensor_start = &view->mutable_storage()[view->start_offset()];
-  for (std::size_t i = 0; i < num_elements; i += num_channels) {
-    unsigned char* r = &tensor_start[i + 0];
-    unsigned char* g = &tensor_start[i + 1];
-    unsigned char* b = &tensor_start[i + 2];
-    double s, l;
-    RgbToSl(*r, *g, *b, &s, &l);
-    sl_to_rgb(s, l, r, g, b);
-  }
+  SetImageHue(hue, num_channels, view->num_elements() / num_channels,
+              &view->mutable_storage()[view->start_offset()]);
   return 1;
 }
 
-// Careful benchmarking is required when refactoring this code.
-void ApplyPattern(unsigned char* source_start,
-                  const unsigned char* pattern_start, std::size_t pattern_span,
-                  std::size_t pixel_count, unsigned char r1, unsigned char g1,
-                  unsigned char b1, unsigned char r2, unsigned char g2,
-                  unsigned char b2) {
-  for (std::size_t pixel_idx = 0; pixel_idx < pixel_count; ++pixel_idx) {
-    unsigned char* source = &source_start[pixel_idx * 4];
-    const unsigned char pattern = pattern_start[pixel_idx * pattern_span];
-    const int pattern_w_0 = pattern;
-    const int pattern_w_1 = 255 - pattern;
-    const int pattern_0 = (pattern_w_0 * r1 + pattern_w_1 * r2 + 127) / 255;
-    const int pattern_1 = (pattern_w_0 * g1 + pattern_w_1 * g2 + 127) / 255;
-    const int pattern_2 = (pattern_w_0 * b1 + pattern_w_1 * b2 + 127) / 255;
-
-    const int source_w_0 = source[3];
-    const int source_w_1 = 255 - source_w_0;
-    source[0] = (source_w_0 * pattern_0 + source_w_1 * source[0] + 127) / 255;
-    source[1] = (source_w_0 * pattern_1 + source_w_1 * source[1] + 127) / 255;
-    source[2] = (source_w_0 * pattern_2 + source_w_1 * source[2] + 127) / 255;
-    source[3] = 255;
-  }
-}
-
 // Overlays a colored pattern onto a source image using its alpha channel as an
 // opacity mask.
 //
@@ -737,15 +325,13 @@ lua::NResultsOr SetMaskedPattern(lua_State* L) {
     return "[image.setMaskedPattern] Arg1 (source) shape must have 4 channels.";
   }
 
-  std::size_t number_pixels = source_view->num_elements() / 4;
-  int pattern_span = pattern_view.shape().back();
   unsigned char* source_start =
       &source_view->mutable_storage()[source_view->start_offset()];
   const unsigned char* pattern_start =
       &pattern_view.storage()[pattern_view.start_offset()];
-  ApplyPattern(source_start, pattern_start, pattern_span, number_pixels,
-               color1[0], color1[1], color1[2], color2[0], color2[1],
-               color2[2]);
+  ApplyMaskedPattern(pattern_start, pattern_view.shape().back(),
+                     source_view->num_elements() / 4, color1, color2,
+                     source_start);
   lua_settop(L, 1);
   return 1;
 }
@@ -760,6 +346,9 @@ int LuaImageRequire(lua_State* L) {
   lua_pushlightuserdata(L, fs);
   lua_pushcclosure(L, &lua::Bind<Load>, 1);
   table.InsertFromStackTop("load");
+  lua_pushlightuserdata(L, fs);
+  lua_pushcclosure(L, &lua::Bind<LoadAll>, 1);
+  table.InsertFromStackTop("loadAll");
 
   table.Insert("scale", &lua::Bind<Scale>);
   table.Insert("setHue", &lua::Bind<SetHue>);
@@ -0,0 +1,364 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/image/png_cache.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/tensor/tensor_view.h"
+#include "dmlab2d/lib/util/default_read_only_file_system.h"
+#include "dmlab2d/lib/util/file_reader.h"
+#include "dmlab2d/lib/util/file_reader_types.h"
+#include "png.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+constexpr std::size_t kDefaultCapacityBytes = std::size_t{64} << 20;
+
+std::vector<unsigned char> PngParsePixels(png_structp png_ptr,
+                                          png_infop info_ptr,
+                                          const tensor::ShapeVector& shape) {
+  std::vector<unsigned char> bytes;
+  bytes.reserve(shape[0] * shape[1] * shape[2]);
+  const png_uint_32 bytesPerRow = png_get_rowbytes(png_ptr, info_ptr);
+  std::unique_ptr<unsigned char[]> row_data(new unsigned char[bytesPerRow]);
+  auto bytes_inserter = std::back_inserter(bytes);
+  for (std::size_t rowIdx = 0; rowIdx < shape[0]; ++rowIdx) {
+    png_read_row(png_ptr, row_data.get(), nullptr);
+    std::copy_n(row_data.get(), shape[1] * shape[2], bytes_inserter);
+  }
+  return bytes;
+}
+
+struct Reader {
+  absl::string_view contents;
+  std::size_t location;
+};
+
+extern "C" {
+static void PngReadContents(png_structp png_ptr, png_bytep out_bytes,
+                            png_size_t count) {
+  Reader* reader = static_cast<Reader*>(png_get_io_ptr(png_ptr));
+  if (count + reader->location <= reader->contents.size()) {
+    std::copy_n(reader->contents.begin() + reader->location, count, out_bytes);
+  }
+  reader->location += count;
+}
+}  // extern "C"
+
+bool ReadFile(const DeepMindReadOnlyFileSystem* fs,
+              const std::string& file_name, std::string* contents) {
+  util::FileReader reader(fs, file_name.c_str());
+  if (!reader.Success()) return false;
+  std::size_t size;
+  if (!reader.GetSize(&size)) return false;
+  contents->resize(size);
+  return reader.Read(0, size, &(*contents)[0]);
+}
+
+}  // namespace
+
+bool DecodePng(absl::string_view contents, DecodedImage* image,
+               std::string* error) {
+  Reader reader{contents, 0};
+  constexpr std::size_t png_header_size = 8;
+  if (reader.contents.size() < png_header_size) {
+    *error = "Invalid format. Contents too short.";
+    return false;
+  }
+
+  if (!png_check_sig(reinterpret_cast<png_const_bytep>(&reader.contents[0]),
+                     png_header_size)) {
+    *error = "Invalid format. Unrecognised signature.";
+    return false;
+  }
+
+  reader.location += png_header_size;
+
+  struct Png {
+    png_structp ptr;
+    png_infop info_ptr;
+    ~Png() {
+      png_destroy_read_struct(ptr ? &ptr : nullptr,
+                              info_ptr ? &info_ptr : nullptr, nullptr);
+    }
+  };
+
+  Png png = {};
+
+  png.ptr =
+      png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  if (!png.ptr) {
+    *error = "Internal error.";
+    return false;
+  }
+
+  png.info_ptr = png_create_info_struct(png.ptr);
+  if (!png.info_ptr) {
+    *error = "Internal error.";
+    return false;
+  }
+
+  png_set_read_fn(png.ptr, &reader, &PngReadContents);
+
+  png_set_sig_bytes(png.ptr, png_header_size);
+  png_read_info(png.ptr, png.info_ptr);
+  png_uint_32 width = 0;
+  png_uint_32 height = 0;
+  int bitDepth = 0;
+  int colorType = -1;
+  png_uint_32 retval =
+      png_get_IHDR(png.ptr, png.info_ptr, &width, &height, &bitDepth,
+                   &colorType, nullptr, nullptr, nullptr);
+
+  if (retval != 1) {
+    *error = "Invalid format. Corrupted header.";
+    return false;
+  }
+  if (bitDepth != 8) {
+    *error = "Unsupported format. Image must have 8-bit channels.";
+    return false;
+  }
+
+  tensor::ShapeVector shape = {height, width, 0};
+
+  switch (colorType) {
+    case PNG_COLOR_TYPE_GRAY:
+      shape[2] = 1;
+      break;
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+      shape[2] = 2;
+      break;
+    case PNG_COLOR_TYPE_RGB:
+      shape[2] = 3;
+      break;
+    case PNG_COLOR_TYPE_RGB_ALPHA:
+      shape[2] = 4;
+      break;
+    default:
+      *error = "Unsupported format. Image must not be paletted.";
+      return false;
+  }
+
+  auto bytes = PngParsePixels(png.ptr, png.info_ptr, shape);
+  if (reader.location > reader.contents.size()) {
+    *error = "Invalid format. Contents too short.";
+    return false;
+  }
+  image->shape = std::move(shape);
+  image->pixels = std::move(bytes);
+  return true;
+}
+
+PngCache* PngCache::Default() {
+  static auto* cache = new PngCache(kDefaultCapacityBytes);
+  return cache;
+}
+
+absl::optional<PngCache::Key> PngCache::MakeKey(
+    const DeepMindReadOnlyFileSystem* fs, const std::string& file_name) {
+  if (fs != util::DefaultReadOnlyFileSystem()) {
+    const auto* bundle_fs =
+        util::AssetBundleFileSystem::FromReadOnlyFileSystem(fs);
+    if (bundle_fs == nullptr) {
+      return absl::nullopt;
+    }
+    // Bundles are immutable once mapped; their id changes with the file.
+    if (const std::string* id = bundle_fs->FindBundleId(file_name)) {
+      return Key(*id, file_name, -1, -1);
+    }
+  }
+  struct stat st;
+  if (stat(file_name.c_str(), &st) != 0) {
+    return absl::nullopt;
+  }
+  std::int64_t mtime_ns =
+      static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+      st.st_mtim.tv_nsec;
+  return Key(std::string(), file_name, mtime_ns, st.st_size);
+}
+
+std::shared_ptr<const DecodedImage> PngCache::Find(const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  if (auto it = entries_.find(key); it != entries_.end()) {
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    return it->second.image;
+  }
+  ++misses_;
+  return nullptr;
+}
+
+std::shared_ptr<const DecodedImage> PngCache::Decode(
+    absl::string_view contents, const std::string& file_name,
+    std::string* error) {
+  auto image = std::make_shared<DecodedImage>();
+  std::string decode_error;
+  if (!DecodePng(contents, image.get(), &decode_error)) {
+    *error = absl::StrCat("(PNG) - \"", file_name, "\" - ", decode_error);
+    return nullptr;
+  }
+  return image;
+}
+
+std::shared_ptr<const DecodedImage> PngCache::Load(
+    const DeepMindReadOnlyFileSystem* fs, const std::string& file_name,
+    std::string* error) {
+  absl::optional<Key> key = MakeKey(fs, file_name);
+  if (key.has_value()) {
+    if (auto image = Find(*key)) {
+      return image;
+    }
+  }
+
+  // Decode outside the lock so that other threads can proceed.
+  std::string contents;
+  if (!ReadFile(fs, file_name, &contents)) {
+    *error = absl::StrCat("- \"", file_name, "\" could not be read.");
+    return nullptr;
+  }
+  auto image = Decode(contents, file_name, error);
+  if (image == nullptr) {
+    return nullptr;
+  }
+
+  if (key.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    Insert(*std::move(key), image);
+  }
+  return image;
+}
+
+void PngCache::Insert(Key key, std::shared_ptr<const DecodedImage> image) {
+  std::size_t image_bytes = image->pixels.size();
+  if (image_bytes > capacity_bytes_ || entries_.contains(key)) {
+    return;
+  }
+  while (size_bytes_ + image_bytes > capacity_bytes_) {
+    auto it = entries_.find(lru_.back());
+    size_bytes_ -= it->second.image->pixels.size();
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  size_bytes_ += image_bytes;
+  entries_.emplace(std::move(key), Entry{std::move(image), lru_.begin()});
+}
+
+std::vector<std::shared_ptr<const DecodedImage>> PngCache::LoadAll(
+    const DeepMindReadOnlyFileSystem* fs,
+    absl::Span<const std::string> file_names, std::size_t max_threads,
+    std::string* error) {
+  std::vector<std::shared_ptr<const DecodedImage>> images(file_names.size());
+  std::vector<std::string> errors(file_names.size());
+
+  // `fs` makes no thread-safety promise, so files are read on this thread and
+  // only decoded in parallel.
+  std::vector<absl::optional<Key>> keys;
+  keys.reserve(file_names.size());
+  std::vector<std::string> contents(file_names.size());
+  std::vector<std::size_t> to_decode;
+  for (std::size_t i = 0; i < file_names.size(); ++i) {
+    keys.push_back(MakeKey(fs, file_names[i]));
+    if (keys[i].has_value()) {
+      images[i] = Find(*keys[i]);
+      if (images[i] != nullptr) {
+        continue;
+      }
+    }
+    if (ReadFile(fs, file_names[i], &contents[i])) {
+      to_decode.push_back(i);
+    } else {
+      errors[i] = absl::StrCat("- \"", file_names[i], "\" could not be read.");
+    }
+  }
+
+  std::atomic<std::size_t> next_index{0};
+  auto worker = [&] {
+    for (std::size_t j = next_index++; j < to_decode.size();
+         j = next_index++) {
+      const std::size_t i = to_decode[j];
+      images[i] = Decode(contents[i], file_names[i], &errors[i]);
+      contents[i] = std::string();
+    }
+  };
+
+  std::size_t num_threads = std::min(max_threads, to_decode.size());
+  if (num_threads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    for (std::size_t i : to_decode) {
+      if (images[i] != nullptr && keys[i].has_value()) {
+        Insert(*std::move(keys[i]), images[i]);
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < images.size(); ++i) {
+    if (images[i] == nullptr) {
+      *error = std::move(errors[i]);
+      return {};
+    }
+  }
+  return images;
+}
+
+std::size_t PngCache::hits() const {
+  absl::MutexLock lock(&mutex_);
+  return hits_;
+}
+
+std::size_t PngCache::misses() const {
+  absl::MutexLock lock(&mutex_);
+  return misses_;
+}
+
+std::size_t PngCache::size_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return size_bytes_;
+}
+
+}  // namespace deepmind::lab2d
@@ -0,0 +1,129 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DMLAB2D_LIB_SYSTEM_IMAGE_PNG_CACHE_H_
+#define DMLAB2D_LIB_SYSTEM_IMAGE_PNG_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "dmlab2d/lib/system/tensor/tensor_view.h"
+#include "dmlab2d/lib/util/file_reader_types.h"
+
+namespace deepmind::lab2d {
+
+// Pixels of a decoded image in row-major {height, width, channels} order.
+struct DecodedImage {
+  tensor::ShapeVector shape;
+  std::vector<unsigned char> pixels;
+};
+
+// Decodes the contents of an 8-bit non-paletted PNG file into `image`. Returns
+// whether decoding succeeded; sets `error` otherwise.
+bool DecodePng(absl::string_view contents, DecodedImage* image,
+               std::string* error);
+
+// A thread-safe cache of decoded PNG files. Files on disk are keyed by path,
+// modification time and size, so files changed on disk are decoded again.
+// Files served from a mounted asset bundle are keyed by the bundle's id and
+// their path. Files read through any other DeepMindReadOnlyFileSystem are not
+// cached, as nothing identifies their contents. The least recently used
+// entries are evicted once the decoded pixels exceed `capacity_bytes`.
+class PngCache {
+ public:
+  explicit PngCache(std::size_t capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  PngCache(const PngCache&) = delete;
+  PngCache& operator=(const PngCache&) = delete;
+
+  // Process-wide cache used by `image.load` and `image.loadAll`.
+  static PngCache* Default();
+
+  // Returns the decoded PNG at `file_name` read through `fs`. On failure
+  // returns null and sets `error` to a message naming the file.
+  std::shared_ptr<const DecodedImage> Load(const DeepMindReadOnlyFileSystem* fs,
+                                           const std::string& file_name,
+                                           std::string* error);
+
+  // Loads all of `file_names`. Files are read through `fs` on the calling
+  // thread and decoded on up to `max_threads` threads. The result has the same
+  // order as `file_names`. On failure returns an empty
+  // vector and sets `error` to the error of the first file that failed.
+  std::vector<std::shared_ptr<const DecodedImage>> LoadAll(
+      const DeepMindReadOnlyFileSystem* fs,
+      absl::Span<const std::string> file_names, std::size_t max_threads,
+      std::string* error);
+
+  // Number of Load calls served from the cache and decoded respectively.
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+  // Total bytes of decoded pixels currently cached.
+  std::size_t size_bytes() const;
+
+ private:
+  // Source (empty for files on disk, else the asset bundle id), path,
+  // modification time and size.
+  using Key =
+      std::tuple<std::string, std::string, std::int64_t, std::int64_t>;
+  struct Entry {
+    std::shared_ptr<const DecodedImage> image;
+    std::list<Key>::iterator lru_position;
+  };
+
+  // Returns the key of `file_name` read through `fs`, or nullopt if it must
+  // not be cached.
+  static absl::optional<Key> MakeKey(const DeepMindReadOnlyFileSystem* fs,
+                                     const std::string& file_name);
+
+  // Decodes the PNG `contents` of `file_name`. On failure returns null and
+  // sets `error`.
+  static std::shared_ptr<const DecodedImage> Decode(
+      absl::string_view contents, const std::string& file_name,
+      std::string* error);
+
+  // Returns the cached image for `key`, or null, and counts the hit or miss.
+  std::shared_ptr<const DecodedImage> Find(const Key& key)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void Insert(Key key, std::shared_ptr<const DecodedImage> image)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::size_t capacity_bytes_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  // Most recently used at front.
+  std::list<Key> lru_ ABSL_GUARDED_BY(mutex_);
+  std::size_t size_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::size_t hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::size_t misses_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace deepmind::lab2d
+
+#endif  // DMLAB2D_LIB_SYSTEM_IMAGE_PNG_CACHE_H_
@@ -0,0 +1,196 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/system/image/png_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "dmlab2d/lib/util/asset_bundle.h"
+#include "dmlab2d/lib/util/default_read_only_file_system.h"
+#include "dmlab2d/lib/util/file_reader_types.h"
+#include "dmlab2d/lib/util/files.h"
+#include "dmlab2d/lib/util/test_srcdir.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::string TestImage(const char* name) {
+  return absl::StrCat(util::TestSrcDir(),
+                      "/dmlab2d/lib/system/image/image_test_data/", name);
+}
+
+TEST(PngCacheTest, DecodesAndCaches) {
+  PngCache cache(1 << 20);
+  std::string error;
+  auto image = cache.Load(util::DefaultReadOnlyFileSystem(),
+                          TestImage("testRGB.png"), &error);
+  ASSERT_NE(image, nullptr) << error;
+  EXPECT_THAT(image->shape, ElementsAre(32, 96, 3));
+  ASSERT_EQ(image->pixels.size(), 32 * 96 * 3);
+  EXPECT_EQ(image->pixels[0], 255);
+  EXPECT_EQ(image->pixels[1], 0);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.size_bytes(), 32 * 96 * 3);
+
+  auto again = cache.Load(util::DefaultReadOnlyFileSystem(),
+                          TestImage("testRGB.png"), &error);
+  EXPECT_EQ(again, image);
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(PngCacheTest, EvictsLeastRecentlyUsed) {
+  // Room for one 32x32x1 image only.
+  PngCache cache(32 * 32 * 2);
+  std::string error;
+  const auto* fs = util::DefaultReadOnlyFileSystem();
+  ASSERT_NE(cache.Load(fs, TestImage("testL.png"), &error), nullptr) << error;
+  ASSERT_NE(cache.Load(fs, TestImage("testRGB.png"), &error), nullptr);
+  EXPECT_EQ(cache.size_bytes(), 32 * 32);
+  ASSERT_NE(cache.Load(fs, TestImage("testL.png"), &error), nullptr);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+TEST(PngCacheTest, LoadAllKeepsOrder) {
+  PngCache cache(1 << 20);
+  std::vector<std::string> names = {
+      TestImage("testRGB.png"), TestImage("testRGBA.png"),
+      TestImage("testL.png"), TestImage("testRGB.png")};
+  std::string error;
+  auto images =
+      cache.LoadAll(util::DefaultReadOnlyFileSystem(), names, 4, &error);
+  ASSERT_EQ(images.size(), 4) << error;
+  EXPECT_THAT(images[0]->shape, ElementsAre(32, 96, 3));
+  EXPECT_THAT(images[1]->shape, ElementsAre(64, 96, 4));
+  EXPECT_THAT(images[2]->shape, ElementsAre(32, 32, 1));
+  EXPECT_EQ(images[3]->pixels, images[0]->pixels);
+}
+
+TEST(PngCacheTest, LoadAllReportsFirstError) {
+  PngCache cache(1 << 20);
+  std::vector<std::string> names = {TestImage("testRGB.png"),
+                                    TestImage("missing1.png"),
+                                    TestImage("missing2.png")};
+  std::string error;
+  auto images =
+      cache.LoadAll(util::DefaultReadOnlyFileSystem(), names, 2, &error);
+  EXPECT_TRUE(images.empty());
+  EXPECT_THAT(error, HasSubstr("missing1.png\" could not be read."));
+}
+
+// Counts files opened from a thread other than `reading_thread`.
+std::thread::id reading_thread;
+std::atomic<int> opened_on_other_threads{0};
+
+bool OpenOnReadingThread(const char* filename,
+                         DeepMindReadOnlyFileHandle* handle) {
+  if (std::this_thread::get_id() != reading_thread) {
+    ++opened_on_other_threads;
+  }
+  return util::DefaultReadOnlyFileSystem()->open(filename, handle);
+}
+
+TEST(PngCacheTest, LoadAllReadsOnCallingThread) {
+  DeepMindReadOnlyFileSystem fs = *util::DefaultReadOnlyFileSystem();
+  fs.open = &OpenOnReadingThread;
+  reading_thread = std::this_thread::get_id();
+  // Nothing is cached, so every name is read.
+  PngCache cache(0);
+  std::vector<std::string> names(256, TestImage("testRGBA.png"));
+  std::string error;
+  auto images = cache.LoadAll(&fs, names, 4, &error);
+  ASSERT_EQ(images.size(), names.size()) << error;
+  EXPECT_EQ(opened_on_other_threads, 0);
+}
+
+TEST(PngCacheTest, BundledImagesAreKeyedByBundle) {
+  const std::string root_path =
+      util::GetTempDirectory() + "/dmlab2d_png_cache_test";
+  CHECK(util::MakeDirectory(root_path));
+  std::string error;
+  ASSERT_TRUE(util::WriteAssetBundle(
+      root_path + "/rgb.bundle", {{"image.png", TestImage("testRGB.png")}},
+      &error))
+      << error;
+  ASSERT_TRUE(util::WriteAssetBundle(
+      root_path + "/l.bundle", {{"image.png", TestImage("testL.png")}},
+      &error))
+      << error;
+
+  // Both bundles serve the same path, which does not exist on disk.
+  const std::string mount_point = root_path + "/level";
+  PngCache cache(1 << 20);
+  std::shared_ptr<const DecodedImage> rgb_image;
+  {
+    util::AssetBundleFileSystem rgb_fs;
+    ASSERT_TRUE(rgb_fs.Mount(root_path + "/rgb.bundle", mount_point, &error))
+        << error;
+    rgb_image = cache.Load(rgb_fs.ReadOnlyFileSystem(),
+                           mount_point + "/image.png", &error);
+    ASSERT_NE(rgb_image, nullptr) << error;
+    EXPECT_EQ(cache.Load(rgb_fs.ReadOnlyFileSystem(),
+                         mount_point + "/image.png", &error),
+              rgb_image);
+    EXPECT_EQ(cache.hits(), 1);
+  }
+  util::AssetBundleFileSystem l_fs;
+  ASSERT_TRUE(l_fs.Mount(root_path + "/l.bundle", mount_point, &error))
+      << error;
+  auto l_image = cache.Load(l_fs.ReadOnlyFileSystem(),
+                            mount_point + "/image.png", &error);
+  ASSERT_NE(l_image, nullptr) << error;
+  EXPECT_THAT(rgb_image->shape, ElementsAre(32, 96, 3));
+  EXPECT_THAT(l_image->shape, ElementsAre(32, 32, 1));
+  EXPECT_EQ(cache.hits(), 1);
+  util::RemoveDirectory(root_path);
+}
+
+TEST(PngCacheTest, CustomFileSystemsAreNotCached) {
+  DeepMindReadOnlyFileSystem fs = *util::DefaultReadOnlyFileSystem();
+  fs.open = &OpenOnReadingThread;
+  reading_thread = std::this_thread::get_id();
+  PngCache cache(1 << 20);
+  std::string error;
+  auto image = cache.Load(&fs, TestImage("testRGB.png"), &error);
+  ASSERT_NE(image, nullptr) << error;
+  EXPECT_NE(cache.Load(&fs, TestImage("testRGB.png"), &error), image);
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.size_bytes(), 0);
+}
+
+TEST(PngCacheTest, DecodeRejectsInvalidContents) {
+  DecodedImage image;
+  std::string error;
+  EXPECT_FALSE(DecodePng("short", &image, &error));
+  EXPECT_THAT(error, HasSubstr("Contents too short"));
+  EXPECT_FALSE(DecodePng("not a png file", &image, &error));
+  EXPECT_THAT(error, HasSubstr("Unrecognised signature"));
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d
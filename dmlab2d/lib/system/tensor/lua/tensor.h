@@ -681,14 +681,14 @@ class LuaTensor : public lua::Class<LuaTensor<T>> {
     }
     if (min_value != std::numeric_limits<T>::lowest() &&
         max_value != std::numeric_limits<T>::max()) {
-      tensor_view_.ForEachMutable([min_value, max_value](T* value) {
+      tensor_view_.ElementwiseMutable([min_value, max_value](T* value) {
         *value = std::max(std::min(*value, max_value), min_value);
       });
     } else if (min_value != std::numeric_limits<T>::lowest()) {
-      tensor_view_.ForEachMutable(
+      tensor_view_.ElementwiseMutable(
           [min_value](T* value) { *value = std::max(min_value, *value); });
     } else if (max_value != std::numeric_limits<T>::max()) {
-      tensor_view_.ForEachMutable(
+      tensor_view_.ElementwiseMutable(
           [max_value](T* value) { *value = std::min(*value, max_value); });
     }
     lua_settop(L, 1);
@@ -733,11 +733,23 @@ class LuaTensor : public lua::Class<LuaTensor<T>> {
   template <typename U>
   lua::NResultsOr Convert(lua_State* L) {
     std::vector<U> storage;
-    storage.reserve(tensor_view_.num_elements());
-    tensor_view_.ForEach([&storage](T value) {
-      storage.push_back(static_cast<U>(value));
-      return true;
-    });
+    if (tensor_view_.IsContiguous()) {
+      storage.resize(tensor_view_.num_elements());
+      const T* source = tensor_view_.storage() + tensor_view_.start_offset();
+      U* target = storage.data();
+      ParallelFor(storage.size(), [source, target](std::size_t begin,
+                                                   std::size_t end) {
+        UnrolledFor(begin, end, [source, target](std::size_t i) {
+          target[i] = static_cast<U>(source[i]);
+        });
+      });
+    } else {
+      storage.reserve(tensor_view_.num_elements());
+      tensor_view_.ForEach([&storage](T value) {
+        storage.push_back(static_cast<U>(value));
+        return true;
+      });
+    }
     LuaTensor<U>::CreateObject(L, tensor_view_.shape(), std::move(storage));
     return 1;
   }
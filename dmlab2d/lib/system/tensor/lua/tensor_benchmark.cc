@@ -24,6 +24,7 @@
 #include "dmlab2d/lib/lua/push_script.h"
 #include "dmlab2d/lib/lua/vm.h"
 #include "dmlab2d/lib/system/tensor/lua/tensor.h"
+#include "dmlab2d/lib/system/tensor/tensor_view.h"
 #include "dmlab2d/lib/util/default_read_only_file_system.h"
 #include "dmlab2d/lib/util/file_reader_types.h"
 
@@ -217,6 +218,146 @@ void BM_NonContiguousFillBySelect(benchmark::State& state) {
 
 BENCHMARK(BM_NonContiguousFillBySelect);
 
+constexpr absl::string_view kTwoContigFloatTensors = R"(
+local tensor = require 'system.tensor'
+return tensor.FloatTensor(1000, 1000, 2), tensor.FloatTensor(1000, 1000, 2)
+)";
+
+constexpr absl::string_view kTwoNonContigFloatTensors = R"(
+local tensor = require 'system.tensor'
+local contiguous = tensor.FloatTensor(1000, 1000, 3):narrow(3, 1, 2)
+local nonContiguous = tensor.FloatTensor(1000, 1000, 3):narrow(3, 1, 2)
+return nonContiguous, contiguous
+)";
+
+constexpr absl::string_view kComponentAdd = R"(
+local bt1, bt2 = ...
+bt1:cadd(bt2)
+)";
+
+constexpr absl::string_view kComponentMul = R"(
+local bt1, bt2 = ...
+bt1:cmul(bt2)
+)";
+
+constexpr absl::string_view kClampFloor = R"(
+local bt1, bt2 = ...
+bt1:clamp(-1, 1)
+bt2:floor()
+)";
+
+constexpr absl::string_view kConvert = R"(
+local bt1, bt2 = ...
+bt1:double()
+bt2:byte()
+)";
+
+void BM_ContiguousComponentAdd(benchmark::State& state) {
+  PerformOperation(state, kTwoContigFloatTensors, kComponentAdd);
+}
+
+BENCHMARK(BM_ContiguousComponentAdd);
+
+void BM_ContiguousComponentAddThreaded(benchmark::State& state) {
+  tensor::SetMaxThreads(4);
+  PerformOperation(state, kTwoContigFloatTensors, kComponentAdd);
+  tensor::SetMaxThreads(1);
+}
+
+BENCHMARK(BM_ContiguousComponentAddThreaded)->UseRealTime();
+
+void BM_NonContiguousComponentAdd(benchmark::State& state) {
+  PerformOperation(state, kTwoNonContigFloatTensors, kComponentAdd);
+}
+
+BENCHMARK(BM_NonContiguousComponentAdd);
+
+void BM_ContiguousComponentMul(benchmark::State& state) {
+  PerformOperation(state, kTwoContigFloatTensors, kComponentMul);
+}
+
+BENCHMARK(BM_ContiguousComponentMul);
+
+void BM_NonContiguousComponentMul(benchmark::State& state) {
+  PerformOperation(state, kTwoNonContigFloatTensors, kComponentMul);
+}
+
+BENCHMARK(BM_NonContiguousComponentMul);
+
+void BM_ContiguousClampFloor(benchmark::State& state) {
+  PerformOperation(state, kTwoContigFloatTensors, kClampFloor);
+}
+
+BENCHMARK(BM_ContiguousClampFloor);
+
+void BM_ContiguousClampFloorThreaded(benchmark::State& state) {
+  tensor::SetMaxThreads(4);
+  PerformOperation(state, kTwoContigFloatTensors, kClampFloor);
+  tensor::SetMaxThreads(1);
+}
+
+BENCHMARK(BM_ContiguousClampFloorThreaded)->UseRealTime();
+
+void BM_NonContiguousClampFloor(benchmark::State& state) {
+  PerformOperation(state, kTwoNonContigFloatTensors, kClampFloor);
+}
+
+BENCHMARK(BM_NonContiguousClampFloor);
+
+void BM_ContiguousConvert(benchmark::State& state) {
+  PerformOperation(state, kTwoContigFloatTensors, kConvert);
+}
+
+BENCHMARK(BM_ContiguousConvert);
+
+void BM_NonContiguousConvert(benchmark::State& state) {
+  PerformOperation(state, kTwoNonContigFloatTensors, kConvert);
+}
+
+BENCHMARK(BM_NonContiguousConvert);
+
+constexpr absl::string_view kSelectRows = R"(
+local bt1, bt2 = ...
+for i = 1, 1000 do
+  bt1:select(1, i)
+  bt2:select(1, i)
+end
+)";
+
+constexpr absl::string_view kNarrowTransposeRows = R"(
+local bt1, bt2 = ...
+for i = 1, 999 do
+  bt1:narrow(1, i, 2):transpose(1, 2)
+  bt2:narrow(1, i, 2):transpose(1, 2)
+end
+)";
+
+constexpr absl::string_view kReshapeRows = R"(
+local bt1, bt2 = ...
+for i = 1, 1000 do
+  bt1:select(1, i):reshape{2, 1000}
+  bt2:select(1, i):reshape{2000}
+end
+)";
+
+void BM_SelectRows(benchmark::State& state) {
+  PerformOperation(state, kTwoContigTensors, kSelectRows);
+}
+
+BENCHMARK(BM_SelectRows);
+
+void BM_NarrowTransposeRows(benchmark::State& state) {
+  PerformOperation(state, kTwoContigTensors, kNarrowTransposeRows);
+}
+
+BENCHMARK(BM_NarrowTransposeRows);
+
+void BM_ReshapeRows(benchmark::State& state) {
+  PerformOperation(state, kTwoContigTensors, kReshapeRows);
+}
+
+BENCHMARK(BM_ReshapeRows);
+
 constexpr absl::string_view kTwoSmallContigTensors = R"(
 local tensor = require 'system.tensor'
 return tensor.ByteTensor(100, 100, 2), tensor.ByteTensor(100, 100, 2)
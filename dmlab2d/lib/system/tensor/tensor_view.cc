@@ -17,13 +17,144 @@
 #include "dmlab2d/lib/system/tensor/tensor_view.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <iomanip>
 #include <iterator>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
 namespace deepmind::lab2d {
 namespace tensor {
+namespace {
+
+std::atomic<std::size_t> max_threads{1};
+
+// The ranges of one ParallelForRanges call. The calling thread and pool
+// workers claim ranges until none are left.
+struct Job {
+  void (*range)(void* context, std::size_t begin, std::size_t end);
+  void* context;
+  std::size_t num_elements;
+  std::size_t range_size;
+  std::size_t num_ranges;
+  std::atomic<std::size_t> next_range{0};
+  // Guarded by WorkerPool::mutex_.
+  std::size_t done_ranges = 0;
+  // Workers that may still access the job. Guarded by WorkerPool::mutex_.
+  int num_attached = 0;
+};
+
+// Processes unclaimed ranges of `job`. Returns the number processed.
+std::size_t RunRanges(Job* job) {
+  std::size_t count = 0;
+  for (std::size_t i = job->next_range++; i < job->num_ranges;
+       i = job->next_range++) {
+    const std::size_t begin = i * job->range_size;
+    job->range(job->context, begin,
+               std::min(begin + job->range_size, job->num_elements));
+    ++count;
+  }
+  return count;
+}
+
+// Returns whether all ranges of `job` are processed and no worker accesses it.
+bool IsDone(Job* job) {
+  return job->done_ranges == job->num_ranges && job->num_attached == 0;
+}
+
+// Threads shared by all ParallelForRanges calls. The pool grows to the largest
+// number of workers requested and lives until the process exits.
+class WorkerPool {
+ public:
+  static WorkerPool* Get() {
+    static auto* pool = new WorkerPool();
+    return pool;
+  }
+
+  void Run(Job* job, std::size_t num_workers) {
+    {
+      absl::MutexLock lock(&mutex_);
+      for (; num_workers_ < num_workers; ++num_workers_) {
+        std::thread([this] { WorkerLoop(); }).detach();
+      }
+      jobs_.push_back(job);
+    }
+    const std::size_t count = RunRanges(job);
+    absl::MutexLock lock(&mutex_);
+    Finish(job, count);
+    mutex_.Await(absl::Condition(&IsDone, job));
+  }
+
+ private:
+  bool HasJob() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !jobs_.empty();
+  }
+
+  // Records that `count` ranges of `job` are done. All ranges of `job` have
+  // been claimed, so no other worker needs to find it.
+  void Finish(Job* job, std::size_t count)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    job->done_ranges += count;
+    jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), job), jobs_.end());
+  }
+
+  void WorkerLoop() {
+    for (;;) {
+      Job* job;
+      {
+        absl::MutexLock lock(&mutex_,
+                             absl::Condition(this, &WorkerPool::HasJob));
+        job = jobs_.front();
+        ++job->num_attached;
+      }
+      const std::size_t count = RunRanges(job);
+      absl::MutexLock lock(&mutex_);
+      --job->num_attached;
+      Finish(job, count);
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::size_t num_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Jobs that may have unclaimed ranges, oldest first.
+  std::vector<Job*> jobs_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+void SetMaxThreads(std::size_t num_threads) {
+  max_threads.store(std::max<std::size_t>(num_threads, 1),
+                    std::memory_order_relaxed);
+}
+
+std::size_t MaxThreads() {
+  return max_threads.load(std::memory_order_relaxed);
+}
+
+namespace internal {
+
+void ParallelForRanges(std::size_t num_elements, std::size_t num_threads,
+                       void (*range)(void* context, std::size_t begin,
+                                     std::size_t end),
+                       void* context) {
+  Job job;
+  job.range = range;
+  job.context = context;
+  job.num_elements = num_elements;
+  // Ranges are multiples of 64 elements so that threads do not share cache
+  // lines.
+  job.range_size = (num_elements / num_threads + 63) & ~std::size_t{63};
+  job.num_ranges = (num_elements + job.range_size - 1) / job.range_size;
+  WorkerPool::Get()->Run(&job, num_threads - 1);
+}
+
+}  // namespace internal
 
 void Layout::PrintToStream(
     std::size_t max_num_elements, std::ostream* os,
@@ -20,22 +20,28 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
 #include <ostream>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "Eigen/Dense"
+#include "absl/container/inlined_vector.h"
 
 namespace deepmind::lab2d {
 namespace tensor {
 
-using ShapeVector = std::vector<std::size_t>;
-using StrideVector = std::vector<std::ptrdiff_t>;
+// Shapes and strides of up to kMaxInlineDims dimensions are stored inline, so
+// creating and deriving views of typical tensors does not allocate.
+inline constexpr std::size_t kMaxInlineDims = 6;
+using ShapeVector = absl::InlinedVector<std::size_t, kMaxInlineDims>;
+using StrideVector = absl::InlinedVector<std::ptrdiff_t, kMaxInlineDims>;
 
 // Implementation of std::exclusive_scan.
 template <typename T, typename It, typename ItOut, typename BinaryOp>
@@ -47,6 +53,69 @@ ItOut ExclusiveScan(It first, It last, ItOut result, T init, BinaryOp op) {
   return result;
 }
 
+// Element-wise operations on contiguous tensors with at least this many
+// elements may be split across threads.
+inline constexpr std::size_t kParallelMinElements = std::size_t{1} << 18;
+
+// Sets the maximum number of threads used by element-wise operations on large
+// contiguous tensors. The default of 1 keeps all work on the calling thread.
+// The setting is shared by every environment in the process, so it is meant
+// for the hosting program and is not exposed to Lua.
+void SetMaxThreads(std::size_t num_threads);
+
+// Returns the value last passed to SetMaxThreads, or 1.
+std::size_t MaxThreads();
+
+namespace internal {
+
+// Calls `range(context, begin, end)` on consecutive ranges covering
+// [0, num_elements), processed by the calling thread and up to
+// `num_threads - 1` threads of a process-wide pool. Returns once all ranges
+// have been processed.
+void ParallelForRanges(std::size_t num_elements, std::size_t num_threads,
+                       void (*range)(void* context, std::size_t begin,
+                                     std::size_t end),
+                       void* context);
+
+}  // namespace internal
+
+// Calls `f(begin, end)` on consecutive ranges covering [0, num_elements). The
+// ranges are processed in parallel when `num_elements` is at least
+// kParallelMinElements and MaxThreads() is greater than 1. Threads are reused
+// across calls.
+template <typename F>
+void ParallelFor(std::size_t num_elements, F&& f) {
+  const std::size_t num_threads =
+      std::min(MaxThreads(), num_elements / (kParallelMinElements / 2));
+  if (num_elements < kParallelMinElements || num_threads <= 1) {
+    f(std::size_t{0}, num_elements);
+    return;
+  }
+  using Fn = std::remove_reference_t<F>;
+  internal::ParallelForRanges(
+      num_elements, num_threads,
+      [](void* context, std::size_t begin, std::size_t end) {
+        (*static_cast<Fn*>(context))(begin, end);
+      },
+      const_cast<void*>(static_cast<const void*>(&f)));
+}
+
+// Calls `op(i)` for all i in [begin, end). The loop is split into blocks of a
+// fixed size, which compilers unroll and vectorize.
+template <typename F>
+void UnrolledFor(std::size_t begin, std::size_t end, F&& op) {
+  constexpr std::size_t kBlockSize = 16;
+  std::size_t i = begin;
+  for (; i + kBlockSize <= end; i += kBlockSize) {
+    for (std::size_t j = 0; j < kBlockSize; ++j) {
+      op(i + j);
+    }
+  }
+  for (; i < end; ++i) {
+    op(i);
+  }
+}
+
 // Class for calculating offsets into storage for a tensor.
 // Supports functions which do not require manipulation of the storage data.
 // Can have any stride but the default is to have strides in row-major
@@ -507,6 +576,55 @@ class TensorView : public Layout {
         });
   }
 
+  // Applies 'op' to each mutable element. Contiguous tensors are visited with a
+  // flat loop that compilers can vectorize and large ones are split across
+  // threads (see SetMaxThreads). 'op' must therefore only access the element
+  // it is passed; the order of calls is unspecified.
+  template <typename F>
+  void ElementwiseMutable(F&& op) {
+    if (!IsContiguous()) {
+      ForEachMutable(std::forward<F>(op));
+      return;
+    }
+    T* data = storage_ + start_offset();
+    ParallelFor(num_elements(), [data, &op](std::size_t begin,
+                                            std::size_t end) {
+      UnrolledFor(begin, end, [data, &op](std::size_t i) { op(&data[i]); });
+    });
+  }
+
+  // Pairwise variant of ElementwiseMutable. If '*this' matches the number of
+  // elements in 'rhs', 'op' is applied to the elements of '*this' and 'rhs'
+  // and returns true, otherwise returns false. The fast paths are only used
+  // when the elements of '*this' and 'rhs' are either disjoint or identical.
+  template <typename U, typename F>
+  bool ElementwiseMutable(const TensorView<U>& rhs, F&& op) {
+    std::size_t num = num_elements();
+    if (num != rhs.num_elements()) {
+      return false;
+    }
+    if (!IsContiguous() || !rhs.IsContiguous()) {
+      return ComponentOpMutable(rhs, std::forward<F>(op));
+    }
+    T* lhs_data = storage_ + start_offset();
+    const U* rhs_data = rhs.storage() + rhs.start_offset();
+    auto lhs_begin = reinterpret_cast<std::uintptr_t>(lhs_data);
+    auto rhs_begin = reinterpret_cast<std::uintptr_t>(rhs_data);
+    bool identical = std::is_same_v<T, U> && lhs_begin == rhs_begin;
+    bool disjoint = lhs_begin + num * sizeof(T) <= rhs_begin ||
+                    rhs_begin + num * sizeof(U) <= lhs_begin;
+    if (!identical && !disjoint) {
+      return ComponentOpMutable(rhs, std::forward<F>(op));
+    }
+    ParallelFor(num, [lhs_data, rhs_data, &op](std::size_t begin,
+                                               std::size_t end) {
+      UnrolledFor(begin, end, [lhs_data, rhs_data, &op](std::size_t i) {
+        op(&lhs_data[i], rhs_data[i]);
+      });
+    });
+    return true;
+  }
+
   // Returns whether *this and 'rhs' have the same shape and the elements are
   // equal.
   bool operator==(const TensorView& rhs) const {
@@ -524,31 +642,31 @@ class TensorView : public Layout {
   // Assigns all elements in '*this' to be the value 'rhs'.
   template <typename U>
   void Assign(U rhs) {
-    ForEachMutable([rhs](T* val) { *val = rhs; });
+    ElementwiseMutable([rhs](T* val) { *val = rhs; });
   }
 
   // Multiplies all elements in '*this' by the value 'rhs'.
   template <typename U>
   void Mul(U rhs) {
-    ForEachMutable([rhs](T* val) { *val *= rhs; });
+    ElementwiseMutable([rhs](T* val) { *val *= rhs; });
   }
 
   // Adds to all elements in '*this' by the value 'rhs'.
   template <typename U>
   void Add(U rhs) {
-    ForEachMutable([rhs](T* val) { *val += rhs; });
+    ElementwiseMutable([rhs](T* val) { *val += rhs; });
   }
 
   // Divides all elements in '*this' by the value 'rhs'.
   template <typename U>
   void Div(U rhs) {
-    ForEachMutable([rhs](T* val) { *val /= rhs; });
+    ElementwiseMutable([rhs](T* val) { *val /= rhs; });
   }
 
   // Subtracts all elements in '*this' by the value 'rhs'.
   template <typename U>
   void Sub(U rhs) {
-    ForEachMutable([rhs](T* val) { *val -= rhs; });
+    ElementwiseMutable([rhs](T* val) { *val -= rhs; });
   }
 
   // All the following member functions starting with 'C', return whether the
@@ -558,31 +676,36 @@ class TensorView : public Layout {
   // Assigns '*this' component-wise with 'rhs'.
   template <typename U>
   bool CAssign(const TensorView<U>& rhs) {
-    return ComponentOpMutable(rhs, [](T* v_lhs, U v_rhs) { *v_lhs = v_rhs; });
+    return ElementwiseMutable(rhs,
+                              [](T* v_lhs, U v_rhs) { *v_lhs = v_rhs; });
   }
 
   // Multiplies '*this' component-wise by 'rhs'.
   template <typename U>
   bool CMul(const TensorView<U>& rhs) {
-    return ComponentOpMutable(rhs, [](T* v_lhs, U v_rhs) { *v_lhs *= v_rhs; });
+    return ElementwiseMutable(rhs,
+                              [](T* v_lhs, U v_rhs) { *v_lhs *= v_rhs; });
   }
 
   // Adds '*this' component-wise by 'rhs'.
   template <typename U>
   bool CAdd(const TensorView<U>& rhs) {
-    return ComponentOpMutable(rhs, [](T* v_lhs, U v_rhs) { *v_lhs += v_rhs; });
+    return ElementwiseMutable(rhs,
+                              [](T* v_lhs, U v_rhs) { *v_lhs += v_rhs; });
   }
 
   // Divides '*this' component-wise by 'rhs'.
   template <typename U>
   bool CDiv(const TensorView<U>& rhs) {
-    return ComponentOpMutable(rhs, [](T* v_lhs, U v_rhs) { *v_lhs /= v_rhs; });
+    return ElementwiseMutable(rhs,
+                              [](T* v_lhs, U v_rhs) { *v_lhs /= v_rhs; });
   }
 
   // Subtracts '*this' component-wise by 'rhs'.
   template <typename U>
   bool CSub(const TensorView<U>& rhs) {
-    return ComponentOpMutable(rhs, [](T* v_lhs, U v_rhs) { *v_lhs -= v_rhs; });
+    return ElementwiseMutable(rhs,
+                              [](T* v_lhs, U v_rhs) { *v_lhs -= v_rhs; });
   }
 
   // Compute the matrix product of 'lhs' and 'rhs' and store it in '*this'.
@@ -629,17 +752,17 @@ class TensorView : public Layout {
 
   // Assigns '*this' component-wise to 'floor(rhs)'.
   void Floor() {
-    ForEachMutable([](T* val) { *val = std::floor(*val); });
+    ElementwiseMutable([](T* val) { *val = std::floor(*val); });
   }
 
   // Assigns '*this' component-wise to 'ceil(rhs)'.
   void Ceil() {
-    ForEachMutable([](T* val) { *val = std::ceil(*val); });
+    ElementwiseMutable([](T* val) { *val = std::ceil(*val); });
   }
 
   // Assigns '*this' component-wise to 'round(rhs)'.
   void Round() {
-    ForEachMutable([](T* val) { *val = std::round(*val); });
+    ElementwiseMutable([](T* val) { *val = std::round(*val); });
   }
 
   // Calculates the sum of all elements using T2 type as the accumulator.
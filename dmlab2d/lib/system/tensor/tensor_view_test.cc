@@ -16,8 +16,14 @@
 
 #include "dmlab2d/lib/system/tensor/tensor_view.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <mutex>  // NOLINT(build/c++11)
 #include <optional>
 #include <random>
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -447,6 +453,106 @@ TEST(TensorViewTest, TestRound) {
   EXPECT_THAT(storage, ElementsAre(-2.0, -2.0, 1.0, 1.0));
 }
 
+TEST(TensorViewTest, TestElementwiseNonContiguousMatchesContiguous) {
+  ShapeVector shape = {4, 6};
+  std::vector<int> storage = MakeSequence<int>(Layout::num_elements(shape));
+  std::vector<int> expected = storage;
+  TensorView<int> view(Layout(std::move(shape)), storage.data());
+  TensorView<int> columns = view;
+  ASSERT_TRUE(columns.Select(1, 2));
+  columns.Mul(10);
+  for (std::size_t row = 0; row < 4; ++row) {
+    expected[row * 6 + 2] *= 10;
+  }
+  EXPECT_EQ(storage, expected);
+  ASSERT_TRUE(view.CAdd(view));
+  for (int& value : expected) value *= 2;
+  EXPECT_EQ(storage, expected);
+}
+
+TEST(TensorViewTest, TestElementwiseOverlapFallsBack) {
+  std::vector<int> storage = MakeSequence<int>(41);
+  TensorView<int> lhs(Layout({40}), storage.data() + 1);
+  TensorView<int> rhs(Layout({40}), storage.data());
+  // Overlapping views are combined in element order, as before.
+  ASSERT_TRUE(lhs.CAdd(rhs));
+  std::vector<int> expected = MakeSequence<int>(41);
+  for (std::size_t i = 1; i < expected.size(); ++i) {
+    expected[i] += expected[i - 1];
+  }
+  EXPECT_EQ(storage, expected);
+}
+
+TEST(TensorViewTest, TestElementwiseParallel) {
+  const std::size_t size = kParallelMinElements * 2 + 7;
+  std::vector<float> lhs_storage = MakeSequence<float>(size);
+  std::vector<float> rhs_storage(size, 0.5f);
+  TensorView<float> lhs(Layout({size}), lhs_storage.data());
+  TensorView<float> rhs(Layout({size}), rhs_storage.data());
+  SetMaxThreads(4);
+  EXPECT_EQ(MaxThreads(), 4);
+  ASSERT_TRUE(lhs.CAdd(rhs));
+  lhs.Floor();
+  lhs.Mul(2.0f);
+  SetMaxThreads(1);
+  for (std::size_t i = 0; i < size; ++i) {
+    ASSERT_EQ(lhs_storage[i], static_cast<float>(i) * 2.0f) << i;
+  }
+}
+
+TEST(TensorViewTest, TestParallelForCoversRange) {
+  const std::size_t size = kParallelMinElements * 3 + 1;
+  std::vector<unsigned char> visited(size);
+  SetMaxThreads(3);
+  ParallelFor(size, [&visited](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) ++visited[i];
+  });
+  SetMaxThreads(1);
+  EXPECT_EQ(std::count(visited.begin(), visited.end(), 1), size);
+}
+
+TEST(TensorViewTest, TestParallelForReusesThreads) {
+  const std::size_t size = kParallelMinElements * 3;
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  SetMaxThreads(3);
+  for (int i = 0; i < 20; ++i) {
+    ParallelFor(size, [&](std::size_t, std::size_t) {
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_ids.insert(std::this_thread::get_id());
+    });
+  }
+  SetMaxThreads(1);
+  // The calling thread and at most two pooled workers.
+  EXPECT_LE(thread_ids.size(), 3);
+}
+
+TEST(TensorViewTest, TestParallelForFromSeveralThreads) {
+  const std::size_t size = kParallelMinElements * 2;
+  std::vector<std::vector<unsigned char>> visited(
+      4, std::vector<unsigned char>(size));
+  SetMaxThreads(2);
+  std::vector<std::thread> callers;
+  for (auto& caller_visited : visited) {
+    callers.emplace_back([&caller_visited, size] {
+      for (int call = 0; call < 10; ++call) {
+        ParallelFor(size, [&caller_visited](std::size_t begin,
+                                            std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) ++caller_visited[i];
+        });
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  SetMaxThreads(1);
+  for (const auto& caller_visited : visited) {
+    EXPECT_EQ(std::count(caller_visited.begin(), caller_visited.end(), 10),
+              size);
+  }
+}
+
 TEST(TensorViewTest, TestSum) {
   ShapeVector shape = {4};
   std::vector<int> storage = {1, 2, 3, 4};
@@ -0,0 +1,36 @@
+"""Build rule for packing level assets into a memory-mappable asset bundle.
+
+Example:
+
+load("//dmlab2d/lib/util:asset_bundle.bzl", "dmlab2d_asset_bundle")
+
+dmlab2d_asset_bundle(
+    name = "clean_up_bundle",
+    srcs = ["//dmlab2d/lib/game_scripts/levels/clean_up"],
+)
+
+Entries are named by their workspace-relative path, so a bundle mounted at the
+runfiles root (setting 'assetBundle') serves the same paths as the runfiles.
+"""
+
+def dmlab2d_asset_bundle(name, srcs, strip_prefix = "", **kwargs):
+    """Creates rule producing '<name>.bundle' containing all of 'srcs'.
+
+    Args:
+      name: Name of rule.
+      srcs: Source files to include. Generated files are not supported.
+      strip_prefix: Optional prefix removed from each entry name.
+      **kwargs: Additional arguments to pass on to genrule.
+    """
+    packer = "//dmlab2d/lib/util:asset_bundle_packer"
+    native.genrule(
+        name = name,
+        srcs = srcs,
+        outs = [name + ".bundle"],
+        cmd = "$(location %s) --output=$@ --strip_prefix='%s' $(SRCS)" % (
+            packer,
+            strip_prefix,
+        ),
+        tools = [packer],
+        **kwargs
+    )
@@ -0,0 +1,242 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/util/asset_bundle.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/util/files.h"
+
+namespace deepmind::lab2d::util {
+namespace {
+
+constexpr std::size_t kHeaderSize = sizeof(kAssetBundleMagic) + 2 * 4;
+constexpr std::size_t kEntrySize = 4 * 8;
+constexpr std::size_t kDataAlignment = 16;
+
+std::uint64_t LoadU64(const char* p) {
+  std::uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | static_cast<unsigned char>(p[i]);
+  }
+  return value;
+}
+
+std::uint32_t LoadU32(const char* p) {
+  std::uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) {
+    value = (value << 8) | static_cast<unsigned char>(p[i]);
+  }
+  return value;
+}
+
+void AppendU64(std::uint64_t value, std::string* out) {
+  for (int i = 0; i < 8; ++i) {
+    out->push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void AppendU32(std::uint32_t value, std::string* out) {
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+struct Entry {
+  absl::string_view name;
+  absl::string_view data;
+};
+
+Entry ReadEntry(const char* bundle, std::size_t index) {
+  const char* entry = bundle + kHeaderSize + index * kEntrySize;
+  return {absl::string_view(bundle + LoadU64(entry), LoadU64(entry + 8)),
+          absl::string_view(bundle + LoadU64(entry + 16), LoadU64(entry + 24))};
+}
+
+}  // namespace
+
+std::unique_ptr<AssetBundle> AssetBundle::Open(const std::string& path,
+                                               std::string* error) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *error = absl::StrCat("Failed to open asset bundle \"", path,
+                          "\": ", std::strerror(errno));
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    *error = absl::StrCat("Failed to stat asset bundle \"", path,
+                          "\": ", std::strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+  std::size_t size = st.st_size;
+  if (size < kHeaderSize) {
+    *error = absl::StrCat("Asset bundle \"", path, "\" is truncated");
+    close(fd);
+    return nullptr;
+  }
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    *error = absl::StrCat("Failed to map asset bundle \"", path,
+                          "\": ", std::strerror(errno));
+    return nullptr;
+  }
+  const char* data = static_cast<const char*>(mapping);
+  std::unique_ptr<AssetBundle> bundle(new AssetBundle(
+      data, size, LoadU32(data + sizeof(kAssetBundleMagic) + 4),
+      absl::StrCat(path, ":", st.st_dev, ":", st.st_ino, ":",
+                   st.st_mtim.tv_sec, ".", st.st_mtim.tv_nsec)));
+
+  if (std::memcmp(data, kAssetBundleMagic, sizeof(kAssetBundleMagic)) != 0) {
+    *error = absl::StrCat("\"", path, "\" is not an asset bundle");
+    return nullptr;
+  }
+  if (std::uint32_t version = LoadU32(data + sizeof(kAssetBundleMagic));
+      version != kAssetBundleVersion) {
+    *error = absl::StrCat("Asset bundle \"", path, "\" has version ", version,
+                          "; expected ", kAssetBundleVersion);
+    return nullptr;
+  }
+  if (bundle->entry_count_ > (size - kHeaderSize) / kEntrySize) {
+    *error = absl::StrCat("Asset bundle \"", path, "\" is truncated");
+    return nullptr;
+  }
+  for (std::size_t i = 0; i < bundle->entry_count_; ++i) {
+    const char* entry = data + kHeaderSize + i * kEntrySize;
+    std::uint64_t name_offset = LoadU64(entry);
+    std::uint64_t name_size = LoadU64(entry + 8);
+    std::uint64_t data_offset = LoadU64(entry + 16);
+    std::uint64_t data_size = LoadU64(entry + 24);
+    if (name_offset > size || name_size > size - name_offset ||
+        data_offset > size || data_size > size - data_offset) {
+      *error = absl::StrCat("Asset bundle \"", path, "\" entry ", i,
+                            " is out of range");
+      return nullptr;
+    }
+  }
+  return bundle;
+}
+
+AssetBundle::~AssetBundle() { munmap(const_cast<char*>(data_), size_); }
+
+absl::string_view AssetBundle::Name(std::size_t index) const {
+  return ReadEntry(data_, index).name;
+}
+
+absl::optional<absl::string_view> AssetBundle::Find(
+    absl::string_view name) const {
+  std::size_t lo = 0;
+  std::size_t hi = entry_count_;
+  while (lo < hi) {
+    std::size_t mid = lo + (hi - lo) / 2;
+    Entry entry = ReadEntry(data_, mid);
+    if (entry.name < name) {
+      lo = mid + 1;
+    } else if (name < entry.name) {
+      hi = mid;
+    } else {
+      return entry.data;
+    }
+  }
+  return absl::nullopt;
+}
+
+bool WriteAssetBundle(const std::string& output_path,
+                      std::vector<std::pair<std::string, std::string>> files,
+                      std::string* error) {
+  std::sort(files.begin(), files.end());
+  for (std::size_t i = 1; i < files.size(); ++i) {
+    if (files[i - 1].first == files[i].first) {
+      *error = absl::StrCat("Duplicate asset bundle entry \"", files[i].first,
+                            "\"");
+      return false;
+    }
+  }
+
+  std::vector<std::string> contents(files.size());
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    if (!GetContents(files[i].second, &contents[i])) {
+      *error = absl::StrCat("Failed to read \"", files[i].second, "\"");
+      return false;
+    }
+  }
+
+  std::uint64_t offset = kHeaderSize + files.size() * kEntrySize;
+  std::vector<std::uint64_t> name_offsets;
+  name_offsets.reserve(files.size());
+  for (const auto& file : files) {
+    name_offsets.push_back(offset);
+    offset += file.first.size();
+  }
+  std::vector<std::uint64_t> data_offsets;
+  data_offsets.reserve(files.size());
+  for (const auto& content : contents) {
+    offset = (offset + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    data_offsets.push_back(offset);
+    offset += content.size();
+  }
+
+  std::string bundle;
+  bundle.reserve(offset);
+  bundle.append(kAssetBundleMagic, sizeof(kAssetBundleMagic));
+  AppendU32(kAssetBundleVersion, &bundle);
+  AppendU32(files.size(), &bundle);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    AppendU64(name_offsets[i], &bundle);
+    AppendU64(files[i].first.size(), &bundle);
+    AppendU64(data_offsets[i], &bundle);
+    AppendU64(contents[i].size(), &bundle);
+  }
+  for (const auto& file : files) {
+    bundle += file.first;
+  }
+  for (std::size_t i = 0; i < contents.size(); ++i) {
+    bundle.resize(data_offsets[i], '\0');
+    bundle += contents[i];
+  }
+
+  // Write the temporary file next to the output so that the final rename does
+  // not cross file systems.
+  std::string scratch_directory = ".";
+  if (auto sep = output_path.find_last_of('/'); sep != std::string::npos) {
+    scratch_directory = output_path.substr(0, sep);
+  }
+  if (!SetContents(output_path, bundle, scratch_directory.c_str())) {
+    *error = absl::StrCat("Failed to write asset bundle \"", output_path, "\"");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace deepmind::lab2d::util
@@ -0,0 +1,103 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// An asset bundle is a single read-only file containing the contents of many
+// small files (PNGs, Lua modules, map text). It is memory-mapped once and the
+// contents of each file are served directly from the mapping.
+//
+// Layout (all integers little-endian, data blocks 16-byte aligned):
+//
+//   char     magic[8]           "DML2DBDL"
+//   uint32   version            kAssetBundleVersion
+//   uint32   entry_count
+//   Entry    entries[entry_count]  sorted by name
+//   char     names[]            concatenated entry names
+//   char     data[]             concatenated file contents
+//
+//   Entry = { uint64 name_offset; uint64 name_size;
+//             uint64 data_offset; uint64 data_size; }
+//
+// Offsets are relative to the start of the bundle.
+
+#ifndef DMLAB2D_LIB_UTIL_ASSET_BUNDLE_H_
+#define DMLAB2D_LIB_UTIL_ASSET_BUNDLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace deepmind::lab2d::util {
+
+inline constexpr char kAssetBundleMagic[8] = {'D', 'M', 'L', '2',
+                                              'D', 'B', 'D', 'L'};
+inline constexpr std::uint32_t kAssetBundleVersion = 1;
+
+class AssetBundle {
+ public:
+  // Memory-maps the bundle at `path`. Returns null and sets `error` if the
+  // file cannot be mapped or is not a valid bundle.
+  static std::unique_ptr<AssetBundle> Open(const std::string& path,
+                                           std::string* error);
+
+  AssetBundle(const AssetBundle&) = delete;
+  AssetBundle& operator=(const AssetBundle&) = delete;
+  ~AssetBundle();
+
+  // Returns the contents of the entry called `name`, or nullopt if there is
+  // no such entry. The returned view is valid for the lifetime of the bundle.
+  absl::optional<absl::string_view> Find(absl::string_view name) const;
+
+  // Number of entries in the bundle.
+  std::size_t size() const { return entry_count_; }
+
+  // Name of entry `index`, where 0 <= `index` < size(). Names are sorted.
+  absl::string_view Name(std::size_t index) const;
+
+  // Identifies the mapped file by its path, device, inode and modification
+  // time when it was opened. Bundles with the same id have the same contents.
+  const std::string& id() const { return id_; }
+
+ private:
+  AssetBundle(const char* data, std::size_t size, std::size_t entry_count,
+              std::string id)
+      : data_(data),
+        size_(size),
+        entry_count_(entry_count),
+        id_(std::move(id)) {}
+
+  const char* data_;
+  std::size_t size_;
+  std::size_t entry_count_;
+  std::string id_;
+};
+
+// Writes a bundle to `output_path` containing, for each pair in `files`, the
+// contents of the file at `second` stored under the entry name `first`.
+// Returns whether the bundle was written; sets `error` otherwise.
+bool WriteAssetBundle(
+    const std::string& output_path,
+    std::vector<std::pair<std::string, std::string>> files,
+    std::string* error);
+
+}  // namespace deepmind::lab2d::util
+
+#endif  // DMLAB2D_LIB_UTIL_ASSET_BUNDLE_H_
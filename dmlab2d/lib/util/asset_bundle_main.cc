@@ -0,0 +1,65 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Packs files into an asset bundle. Each positional argument is a file path,
+// which is also used as the entry name after removing `strip_prefix`.
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "dmlab2d/lib/util/asset_bundle.h"
+
+ABSL_FLAG(std::string, output, "", "Path of the asset bundle to write.");
+
+ABSL_FLAG(std::string, strip_prefix, "",
+          "Prefix removed from each file path to form its entry name.");
+
+int main(int argc, char** argv) {
+  absl::SetProgramUsageMessage(
+      "Packs files into a DeepMind Lab2D asset bundle.\n"
+      "Usage: asset_bundle_packer --output=<bundle> [--strip_prefix=<p>] "
+      "files...");
+  auto free_args = absl::ParseCommandLine(argc, argv);
+  std::string output = absl::GetFlag(FLAGS_output);
+  if (output.empty()) {
+    absl::FPrintF(stderr, "Error - Missing --output\n");
+    return EXIT_FAILURE;
+  }
+
+  std::string strip_prefix = absl::GetFlag(FLAGS_strip_prefix);
+  std::vector<std::pair<std::string, std::string>> files;
+  for (auto it = free_args.begin() + 1; it != free_args.end(); ++it) {
+    absl::string_view name = *it;
+    absl::ConsumePrefix(&name, strip_prefix);
+    files.emplace_back(std::string(name), *it);
+  }
+
+  std::string error;
+  if (!deepmind::lab2d::util::WriteAssetBundle(output, std::move(files),
+                                               &error)) {
+    absl::FPrintF(stderr, "Error - %s\n", error);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
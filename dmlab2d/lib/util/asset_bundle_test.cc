@@ -0,0 +1,186 @@
+// Copyright (C) 2026 The DMLab2D Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dmlab2d/lib/util/asset_bundle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "dmlab2d/lib/util/default_read_only_file_system.h"
+#include "dmlab2d/lib/util/file_reader.h"
+#include "dmlab2d/lib/util/files.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace deepmind::lab2d::util {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class AssetBundleTest : public ::testing::Test {
+ protected:
+  AssetBundleTest() {
+    temp_dir_ = GetTempDirectory();
+    root_path_ = temp_dir_ + "/dmlab2d_asset_bundle_test";
+    CHECK(MakeDirectory(root_path_ + "/images"));
+    CHECK(SetContents(root_path_ + "/init.lua", "return {}",
+                      temp_dir_.c_str()));
+    CHECK(SetContents(root_path_ + "/images/wall.png", std::string(100, 'w'),
+                      temp_dir_.c_str()));
+    CHECK(SetContents(root_path_ + "/empty.txt", "", temp_dir_.c_str()));
+    bundle_path_ = root_path_ + "/assets.bundle";
+  }
+  ~AssetBundleTest() { RemoveDirectory(root_path_); }
+
+  bool WriteBundle(std::string* error) {
+    return WriteAssetBundle(
+        bundle_path_,
+        {
+            {"level/init.lua", root_path_ + "/init.lua"},
+            {"level/images/wall.png", root_path_ + "/images/wall.png"},
+            {"level/empty.txt", root_path_ + "/empty.txt"},
+        },
+        error);
+  }
+
+  std::string temp_dir_;
+  std::string root_path_;
+  std::string bundle_path_;
+};
+
+TEST_F(AssetBundleTest, FindsEntries) {
+  std::string error;
+  ASSERT_TRUE(WriteBundle(&error)) << error;
+  auto bundle = AssetBundle::Open(bundle_path_, &error);
+  ASSERT_NE(bundle, nullptr) << error;
+  ASSERT_EQ(bundle->size(), 3);
+  EXPECT_EQ(bundle->Name(0), "level/empty.txt");
+  EXPECT_EQ(bundle->Name(1), "level/images/wall.png");
+  EXPECT_EQ(bundle->Name(2), "level/init.lua");
+  EXPECT_THAT(bundle->Find("level/init.lua"),
+              Optional(std::string("return {}")));
+  EXPECT_THAT(bundle->Find("level/images/wall.png"),
+              Optional(std::string(100, 'w')));
+  EXPECT_THAT(bundle->Find("level/empty.txt"), Optional(std::string()));
+  EXPECT_EQ(bundle->Find("level/missing.lua"), absl::nullopt);
+  EXPECT_EQ(bundle->Find("level"), absl::nullopt);
+}
+
+TEST_F(AssetBundleTest, DataIsAligned) {
+  std::string error;
+  ASSERT_TRUE(WriteBundle(&error)) << error;
+  auto bundle = AssetBundle::Open(bundle_path_, &error);
+  ASSERT_NE(bundle, nullptr) << error;
+  for (std::size_t i = 0; i < bundle->size(); ++i) {
+    auto contents = bundle->Find(bundle->Name(i));
+    ASSERT_TRUE(contents.has_value());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(contents->data()) % 16, 0);
+  }
+}
+
+TEST_F(AssetBundleTest, RejectsDuplicateNames) {
+  std::string error;
+  EXPECT_FALSE(WriteAssetBundle(bundle_path_,
+                                {
+                                    {"a", root_path_ + "/init.lua"},
+                                    {"a", root_path_ + "/empty.txt"},
+                                },
+                                &error));
+  EXPECT_THAT(error, HasSubstr("Duplicate"));
+}
+
+TEST_F(AssetBundleTest, RejectsInvalidBundle) {
+  std::string error;
+  EXPECT_EQ(AssetBundle::Open(root_path_ + "/init.lua", &error), nullptr);
+  EXPECT_THAT(error, HasSubstr("truncated"));
+  CHECK(SetContents(bundle_path_, std::string(64, 'x'), temp_dir_.c_str()));
+  EXPECT_EQ(AssetBundle::Open(bundle_path_, &error), nullptr);
+  EXPECT_THAT(error, HasSubstr("not an asset bundle"));
+  EXPECT_EQ(AssetBundle::Open(root_path_ + "/missing", &error), nullptr);
+  EXPECT_THAT(error, HasSubstr("Failed to open"));
+}
+
+TEST_F(AssetBundleTest, FileSystemReadsMountedBundle) {
+  std::string error;
+  ASSERT_TRUE(WriteBundle(&error)) << error;
+  const std::string mount_point = root_path_ + "/mount";
+  AssetBundleFileSystem file_system;
+  EXPECT_EQ(file_system.ReadOnlyFileSystem(), DefaultReadOnlyFileSystem());
+  ASSERT_TRUE(file_system.Mount(bundle_path_, mount_point, &error)) << error;
+  ASSERT_TRUE(file_system.Mount(bundle_path_, mount_point, &error)) << error;
+
+  FileReader file(file_system.ReadOnlyFileSystem(),
+                  (mount_point + "/level/images/wall.png").c_str());
+  ASSERT_TRUE(file.Success()) << file.Error();
+  std::size_t size;
+  ASSERT_TRUE(file.GetSize(&size)) << file.Error();
+  EXPECT_EQ(size, 100);
+  std::string result(10, '\0');
+  EXPECT_TRUE(file.Read(90, 10, &result[0]));
+  EXPECT_EQ(result, std::string(10, 'w'));
+  EXPECT_FALSE(file.Read(95, 10, &result[0]));
+  EXPECT_THAT(std::string(file.Error()), HasSubstr("Failed to read from"));
+
+  // Files outside the bundle still come from the local file system.
+  FileReader local(file_system.ReadOnlyFileSystem(),
+                   (root_path_ + "/init.lua").c_str());
+  ASSERT_TRUE(local.Success()) << local.Error();
+  FileReader missing(file_system.ReadOnlyFileSystem(),
+                     (mount_point + "/level/missing.lua").c_str());
+  EXPECT_FALSE(missing.Success());
+}
+
+TEST_F(AssetBundleTest, MountsAreNotShared) {
+  std::string error;
+  ASSERT_TRUE(WriteBundle(&error)) << error;
+  const std::string mount_point = root_path_ + "/mount";
+  const std::string wall_path = mount_point + "/level/images/wall.png";
+  AssetBundleFileSystem unmounted;
+  AssetBundleFileSystem mounted;
+  ASSERT_TRUE(mounted.Mount(bundle_path_, mount_point, &error)) << error;
+  EXPECT_TRUE(mounted.Find(wall_path).has_value());
+  EXPECT_FALSE(unmounted.Find(wall_path).has_value());
+  EXPECT_TRUE(
+      FileReader(mounted.ReadOnlyFileSystem(), wall_path.c_str()).Success());
+  EXPECT_FALSE(
+      FileReader(unmounted.ReadOnlyFileSystem(), wall_path.c_str()).Success());
+  EXPECT_FALSE(
+      FileReader(DefaultReadOnlyFileSystem(), wall_path.c_str()).Success());
+}
+
+TEST_F(AssetBundleTest, ManyInstancesMountAtOnce) {
+  std::string error;
+  ASSERT_TRUE(WriteBundle(&error)) << error;
+  const std::string mount_point = root_path_ + "/mount";
+  const std::string wall_path = mount_point + "/level/images/wall.png";
+  std::vector<std::unique_ptr<AssetBundleFileSystem>> file_systems(1000);
+  for (auto& file_system : file_systems) {
+    file_system = std::make_unique<AssetBundleFileSystem>();
+    ASSERT_TRUE(file_system->Mount(bundle_path_, mount_point, &error)) << error;
+  }
+  for (const auto& file_system : file_systems) {
+    EXPECT_TRUE(FileReader(file_system->ReadOnlyFileSystem(), wall_path.c_str())
+                    .Success());
+  }
+}
+
+}  // namespace
+}  // namespace deepmind::lab2d::util
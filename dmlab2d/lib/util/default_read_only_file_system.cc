@@ -17,18 +17,33 @@
 #include "dmlab2d/lib/util/default_read_only_file_system.h"
 
 #include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <utility>
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/util/asset_bundle.h"
 
 namespace deepmind::lab2d::util {
 namespace {
 
+// Serves a file either from a std::ifstream or, when the file is part of a
+// mounted asset bundle, directly from the bundle's memory mapping.
 class FileReaderDefault {
  public:
-  FileReaderDefault(const char* filename)
-      : ifs_(filename, std::ifstream::binary) {
+  FileReaderDefault(const AssetBundleFileSystem* bundles,
+                    const char* filename) {
+    if (bundles != nullptr) {
+      if (auto contents = bundles->Find(filename)) {
+        contents_ = *contents;
+        return;
+      }
+    }
+    ifs_.open(filename, std::ifstream::binary);
     if (!ifs_) {
       error_message_ = absl::StrCat("Failed to open file \"", filename, "\"");
     }
@@ -40,6 +55,10 @@ class FileReaderDefault {
     if (!Success()) {
       return false;
     }
+    if (contents_) {
+      *size = contents_->size();
+      return true;
+    }
     if (!ifs_.seekg(0, std::ios::end)) {
       error_message_ = "Failed to read file size";
       return false;
@@ -52,6 +71,15 @@ class FileReaderDefault {
     if (!Success()) {
       return false;
     }
+    if (contents_) {
+      if (offset > contents_->size() || size > contents_->size() - offset) {
+        error_message_ =
+            absl::StrCat("Failed to read from ", offset, " to ", offset + size);
+        return false;
+      }
+      std::memcpy(dest_buf, contents_->data() + offset, size);
+      return true;
+    }
     if (!ifs_.seekg(offset, std::ios::beg) || !ifs_.read(dest_buf, size)) {
       error_message_ =
           absl::StrCat("Failed to read from ", offset, " to ", offset + size);
@@ -64,6 +92,7 @@ class FileReaderDefault {
   const char* Error() const { return error_message_.c_str(); }
 
  private:
+  absl::optional<absl::string_view> contents_;
   std::ifstream ifs_;
   std::string error_message_;
 };
@@ -72,7 +101,7 @@ extern "C" {
 
 static bool deepmind_open(const char* filename,
                           DeepMindReadOnlyFileHandle* handle) {
-  auto* readonly_file = new FileReaderDefault(filename);
+  auto* readonly_file = new FileReaderDefault(nullptr, filename);
   *handle = readonly_file;
   return readonly_file->Success();
 }
@@ -111,8 +140,99 @@ constexpr DeepMindReadOnlyFileSystem kFileSystem = {
 
 }  // namespace
 
+// `functions` is first, so the file system that `open` receives in `*handle`
+// is also the address of this struct.
+struct AssetBundleFileSystem::BundledReadOnlyFileSystem {
+  DeepMindReadOnlyFileSystem functions;
+  const AssetBundleFileSystem* owner;
+};
+
 const DeepMindReadOnlyFileSystem* DefaultReadOnlyFileSystem() {
   return &kFileSystem;
 }
 
+AssetBundleFileSystem::AssetBundleFileSystem()
+    : file_system_(new BundledReadOnlyFileSystem{
+          {
+              &OpenBundled,        //
+              &deepmind_get_size,  //
+              &deepmind_read,      //
+              &deepmind_error,     //
+              &deepmind_close,     //
+          },
+          this}) {}
+
+AssetBundleFileSystem::~AssetBundleFileSystem() = default;
+
+bool AssetBundleFileSystem::OpenBundled(const char* filename,
+                                        DeepMindReadOnlyFileHandle* handle) {
+  const auto* file_system =
+      static_cast<const BundledReadOnlyFileSystem*>(*handle);
+  auto* readonly_file = new FileReaderDefault(file_system->owner, filename);
+  *handle = readonly_file;
+  return readonly_file->Success();
+}
+
+bool AssetBundleFileSystem::Mount(const std::string& bundle_path,
+                                  absl::string_view mount_point,
+                                  std::string* error) {
+  std::string prefix = absl::StrCat(mount_point, "/");
+  for (const auto& mounted : bundles_) {
+    if (mounted.bundle_path == bundle_path && mounted.mount_point == prefix) {
+      return true;
+    }
+  }
+  auto bundle = AssetBundle::Open(bundle_path, error);
+  if (bundle == nullptr) {
+    return false;
+  }
+  bundles_.push_back({bundle_path, std::move(prefix), std::move(bundle)});
+  return true;
+}
+
+const AssetBundleFileSystem::MountedBundle*
+AssetBundleFileSystem::FindMounted(absl::string_view path,
+                                   absl::string_view* contents) const {
+  for (const auto& mounted : bundles_) {
+    if (absl::StartsWith(path, mounted.mount_point)) {
+      if (auto found =
+              mounted.bundle->Find(path.substr(mounted.mount_point.size()))) {
+        *contents = *found;
+        return &mounted;
+      }
+    }
+  }
+  return nullptr;
+}
+
+absl::optional<absl::string_view> AssetBundleFileSystem::Find(
+    absl::string_view path) const {
+  absl::string_view contents;
+  if (FindMounted(path, &contents) == nullptr) {
+    return absl::nullopt;
+  }
+  return contents;
+}
+
+const std::string* AssetBundleFileSystem::FindBundleId(
+    absl::string_view path) const {
+  absl::string_view contents;
+  const MountedBundle* mounted = FindMounted(path, &contents);
+  return mounted != nullptr ? &mounted->bundle->id() : nullptr;
+}
+
+const AssetBundleFileSystem* AssetBundleFileSystem::FromReadOnlyFileSystem(
+    const DeepMindReadOnlyFileSystem* file_system) {
+  if (file_system->open != &OpenBundled) {
+    return nullptr;
+  }
+  return reinterpret_cast<const BundledReadOnlyFileSystem*>(file_system)
+      ->owner;
+}
+
+const DeepMindReadOnlyFileSystem* AssetBundleFileSystem::ReadOnlyFileSystem()
+    const {
+  return bundles_.empty() ? &kFileSystem : &file_system_->functions;
+}
+
 }  // namespace deepmind::lab2d::util
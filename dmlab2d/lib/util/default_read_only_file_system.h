@@ -17,6 +17,13 @@
 #ifndef DMLAB2D_LIB_UTIL_DEFAULT_READ_ONLY_FILE_SYSTEM_H_
 #define DMLAB2D_LIB_UTIL_DEFAULT_READ_ONLY_FILE_SYSTEM_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "dmlab2d/lib/util/asset_bundle.h"
 #include "dmlab2d/lib/util/file_reader_types.h"
 
 namespace deepmind::lab2d::util {
@@ -24,6 +31,66 @@ namespace deepmind::lab2d::util {
 // Returns the default DeepMindReadOnlyFileSystem implemented on std::ifstream.
 const DeepMindReadOnlyFileSystem* DefaultReadOnlyFileSystem();
 
+// A set of asset bundles (see asset_bundle.h) mounted for one user, such as one
+// environment, and a read-only file system serving them. Bundles mounted on one
+// instance are not visible through any other.
+class AssetBundleFileSystem {
+ public:
+  AssetBundleFileSystem();
+  ~AssetBundleFileSystem();
+
+  AssetBundleFileSystem(const AssetBundleFileSystem&) = delete;
+  AssetBundleFileSystem& operator=(const AssetBundleFileSystem&) = delete;
+
+  // Mounts the asset bundle at `bundle_path` so that the entry `name` is served
+  // as the file `mount_point + "/" + name`. Mounting the same bundle at the
+  // same mount point again is a no-op. Returns whether the bundle was mounted;
+  // sets `error` otherwise. Must not be called while files are read through
+  // this instance.
+  bool Mount(const std::string& bundle_path, absl::string_view mount_point,
+             std::string* error);
+
+  // Returns the contents of `path` if it is served from a mounted asset bundle.
+  // The returned view is valid for the lifetime of this instance.
+  absl::optional<absl::string_view> Find(absl::string_view path) const;
+
+  // Returns a file system that serves the mounted bundles and reads all other
+  // files like DefaultReadOnlyFileSystem. Returns DefaultReadOnlyFileSystem()
+  // if no bundle is mounted. Valid for the lifetime of this instance.
+  const DeepMindReadOnlyFileSystem* ReadOnlyFileSystem() const;
+
+  // Returns the AssetBundle::id of the mounted bundle serving `path`, or null
+  // if `path` is not served from a bundle.
+  const std::string* FindBundleId(absl::string_view path) const;
+
+  // Returns the instance whose ReadOnlyFileSystem() is `file_system`, or null
+  // if `file_system` does not serve any mounted bundles.
+  static const AssetBundleFileSystem* FromReadOnlyFileSystem(
+      const DeepMindReadOnlyFileSystem* file_system);
+
+ private:
+  struct MountedBundle {
+    std::string bundle_path;
+    std::string mount_point;
+    std::unique_ptr<AssetBundle> bundle;
+  };
+
+  // Returns the bundle serving `path` and sets `contents`, or returns null.
+  const MountedBundle* FindMounted(absl::string_view path,
+                                   absl::string_view* contents) const;
+
+  // A DeepMindReadOnlyFileSystem that knows the instance it serves.
+  struct BundledReadOnlyFileSystem;
+
+  // The `open` of `file_system_`. Finds the instance through the file system
+  // passed in `*handle`; see file_reader_types.h.
+  static bool OpenBundled(const char* filename,
+                          DeepMindReadOnlyFileHandle* handle);
+
+  std::vector<MountedBundle> bundles_;
+  std::unique_ptr<BundledReadOnlyFileSystem> file_system_;
+};
+
 }  // namespace deepmind::lab2d::util
 
 #endif  // DMLAB2D_LIB_UTIL_DEFAULT_READ_ONLY_FILE_SYSTEM_H_
@@ -24,7 +24,8 @@ namespace deepmind::lab2d::util {
 
 FileReader::FileReader(const DeepMindReadOnlyFileSystem* readonly_fs,
                        const char* filename)
-    : readonly_fs_(readonly_fs) {
+    : handle_(const_cast<DeepMindReadOnlyFileSystem*>(readonly_fs)),
+      readonly_fs_(readonly_fs) {
   success_ = readonly_fs_->open(filename, &handle_);
 }
 
@@ -48,7 +48,9 @@ struct DeepMindReadOnlyFileSystem_s {
   // Attempts to open a file named 'filename'. Returns whether file opening was
   // successful. If successful 'get_size(handle)' and 'read(handle)' may be
   // called. Whether the call was successful or not the handle must be closed by
-  // calling the corresponding 'close(&handle)'.
+  // calling the corresponding 'close(&handle)'. On entry '*handle' holds the
+  // address of the DeepMindReadOnlyFileSystem 'open' was called through, so
+  // that one implementation can serve several file systems.
   bool (*open)(const char* filename, DeepMindReadOnlyFileHandle* handle);
 
   // Attempts to retrieve the current size of the file. Returns whether size was